@@ -0,0 +1,49 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * clock.c for the host: the examples' clock.c sets up the PLL and
+ * SysTick, here time is host_ms().  The examples call the sleep
+ * msleep() or milli_sleep(), so there are both.
+ */
+
+#include <stdint.h>
+#include "host.h"
+
+void clock_setup(void);
+void msleep(uint32_t delay);
+void milli_sleep(uint32_t delay);
+uint32_t mtime(void);
+
+void clock_setup(void)
+{
+}
+
+void msleep(uint32_t delay)
+{
+	host_sleep(delay);
+}
+
+void milli_sleep(uint32_t delay)
+{
+	host_sleep(delay);
+}
+
+uint32_t mtime(void)
+{
+	return host_ms();
+}
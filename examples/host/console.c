@@ -0,0 +1,76 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * console.c for the host: the USART console is stdin and stdout.
+ * console_getc() without wait has nothing to offer, so the examples
+ * that poll for keys just carry on.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+void console_putc(char c);
+char console_getc(int wait);
+void console_puts(char *s);
+int console_gets(char *s, int len);
+void console_setup(int baudrate);
+void console_stdio_setup(void);
+
+void console_putc(char c)
+{
+	putchar(c);
+	if (c == '\n') {
+		fflush(stdout);
+	}
+}
+
+char console_getc(int wait)
+{
+	int c;
+
+	if (!wait) {
+		return '\0';
+	}
+	c = getchar();
+	return c == EOF ? '\0' : c;
+}
+
+void console_puts(char *s)
+{
+	while (*s) {
+		console_putc(*s++);
+	}
+}
+
+int console_gets(char *s, int len)
+{
+	if (!fgets(s, len, stdin)) {
+		*s = '\0';
+	}
+	s[strcspn(s, "\n")] = '\0';
+	return strlen(s);
+}
+
+void console_setup(int baudrate)
+{
+	(void)baudrate;
+}
+
+void console_stdio_setup(void)
+{
+}
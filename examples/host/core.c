@@ -0,0 +1,194 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The rest of the chip: clocks, interrupts, the cycle counter, and
+ * the registers of the peripherals nothing models (the USART and the
+ * FMC).
+ */
+
+#define _DEFAULT_SOURCE
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/usart.h>
+#include <libopencm3/stm32/fsmc.h>
+#include <libopencm3/cm3/nvic.h>
+#include <libopencm3/cm3/dwt.h>
+#include "host.h"
+
+volatile struct host_rcc host_rcc = {
+	.cr = RCC_CR_PLLSAIRDY,
+};
+
+uint32_t rcc_ahb_frequency = 168000000;
+uint32_t rcc_apb1_frequency = 42000000;
+uint32_t rcc_apb2_frequency = 84000000;
+
+volatile struct host_usart host_usart[USART_PORTS] = {
+	[USART1] = { .sr = USART_SR_TXE | USART_SR_TC },
+	[USART2] = { .sr = USART_SR_TXE | USART_SR_TC },
+	[USART3] = { .sr = USART_SR_TXE | USART_SR_TC },
+	[USART6] = { .sr = USART_SR_TXE | USART_SR_TC },
+};
+
+volatile struct host_fmc host_fmc;
+
+void rcc_periph_clock_enable(uint32_t clken)
+{
+	(void)clken;
+}
+
+void rcc_peripheral_enable_clock(volatile uint32_t *reg, uint32_t en)
+{
+	*reg |= en;
+}
+
+/*
+ * Interrupts.  Handlers run with 'irq_lock' held, whichever thread
+ * raised them, so while the main thread has one disabled (and so
+ * holds the lock for a moment) it can't be running.  The lock is
+ * recursive as a DMA handler may well start the next transfer, which
+ * raises the interrupt again from inside it.
+ */
+static pthread_mutex_t	irq_lock;
+static bool		irq_enabled[NVIC_IRQ_COUNT];
+static void		(*irq_pending[NVIC_IRQ_COUNT])(void);
+
+__attribute__((constructor))
+static void host_irq_init(void)
+{
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&irq_lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+void host_irq(uint8_t irqn, void (*isr)(void))
+{
+	pthread_mutex_lock(&irq_lock);
+	if (irq_enabled[irqn]) {
+		isr();
+	} else {
+		irq_pending[irqn] = isr;
+	}
+	pthread_mutex_unlock(&irq_lock);
+}
+
+int host_irq_enabled(uint8_t irqn)
+{
+	return irq_enabled[irqn];
+}
+
+void nvic_enable_irq(uint8_t irqn)
+{
+	void (*isr)(void);
+
+	pthread_mutex_lock(&irq_lock);
+	irq_enabled[irqn] = true;
+	isr = irq_pending[irqn];
+	irq_pending[irqn] = NULL;
+	if (isr) {
+		isr();
+	}
+	pthread_mutex_unlock(&irq_lock);
+
+	/* The DMA2D starts when its interrupt is back on, see dma2d.c. */
+	if (irqn == NVIC_DMA2D_IRQ) {
+		host_dma2d_run();
+	}
+}
+
+void nvic_disable_irq(uint8_t irqn)
+{
+	pthread_mutex_lock(&irq_lock);
+	irq_enabled[irqn] = false;
+	pthread_mutex_unlock(&irq_lock);
+}
+
+bool dwt_enable_cycle_counter(void)
+{
+	return true;
+}
+
+uint32_t dwt_read_cycle_counter(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * rcc_ahb_frequency +
+	       (uint64_t)now.tv_nsec * (rcc_ahb_frequency / 1000000) / 1000;
+}
+
+void usart_set_baudrate(uint32_t usart, uint32_t baud)
+{
+	(void)usart;
+	(void)baud;
+}
+
+void usart_set_databits(uint32_t usart, uint32_t bits)
+{
+	(void)usart;
+	(void)bits;
+}
+
+void usart_set_stopbits(uint32_t usart, uint32_t stopbits)
+{
+	(void)usart;
+	(void)stopbits;
+}
+
+void usart_set_mode(uint32_t usart, uint32_t mode)
+{
+	(void)usart;
+	(void)mode;
+}
+
+void usart_set_parity(uint32_t usart, uint32_t parity)
+{
+	(void)usart;
+	(void)parity;
+}
+
+void usart_set_flow_control(uint32_t usart, uint32_t flowcontrol)
+{
+	(void)usart;
+	(void)flowcontrol;
+}
+
+void usart_enable(uint32_t usart)
+{
+	(void)usart;
+}
+
+uint32_t sdram_timing(struct sdram_timing *t)
+{
+	return (t->trcd - 1) << 24 | (t->trp - 1) << 20 |
+	       (t->twr - 1) << 16 | (t->trc - 1) << 12 |
+	       (t->tras - 1) << 8 | (t->txsr - 1) << 4 | (t->tmrd - 1);
+}
+
+void sdram_command(enum fmc_sdram_bank bank, enum fmc_sdram_command cmd,
+		   int autorefresh, int modereg)
+{
+	host_fmc.sdcmr = (uint32_t)modereg << 9 |
+			 (uint32_t)(autorefresh - 1) << 5 |
+			 (uint32_t)bank << 3 | cmd;
+}
@@ -0,0 +1,193 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * DMA: a stream moves all of its data when it is enabled.  Memory to
+ * peripheral only goes anywhere if the peripheral is an SPI data
+ * register with TX DMA on; memory to memory is a copy.  Peripheral to
+ * memory isn't used by any of the examples and does nothing.
+ */
+
+#include <string.h>
+#include <libopencm3/stm32/dma.h>
+#include <libopencm3/stm32/spi.h>
+#include <libopencm3/cm3/nvic.h>
+#include "host.h"
+
+struct stream {
+	uint32_t	cr;
+	uint32_t	par;
+	uint32_t	m0ar;
+	uint16_t	ndtr;
+	uint32_t	flags;
+	int		minc;
+	int		tcie;
+};
+
+static struct stream streams[3][8];
+
+#define MSIZE(s)	(1 << ((s)->cr >> DMA_SxCR_MSIZE_SHIFT & 3))
+
+/* The weak defaults, for the streams an example has no handler for. */
+#define DMA2_ISR(n) \
+	__attribute__((weak)) void dma2_stream##n##_isr(void) {}
+DMA2_ISR(0) DMA2_ISR(1) DMA2_ISR(2) DMA2_ISR(3)
+DMA2_ISR(4) DMA2_ISR(5) DMA2_ISR(6) DMA2_ISR(7)
+
+static const uint8_t dma2_irqs[8] = {
+	NVIC_DMA2_STREAM0_IRQ, NVIC_DMA2_STREAM1_IRQ, NVIC_DMA2_STREAM2_IRQ,
+	NVIC_DMA2_STREAM3_IRQ, NVIC_DMA2_STREAM4_IRQ, NVIC_DMA2_STREAM5_IRQ,
+	NVIC_DMA2_STREAM6_IRQ, NVIC_DMA2_STREAM7_IRQ,
+};
+
+static void (*const dma2_isrs[8])(void) = {
+	dma2_stream0_isr, dma2_stream1_isr, dma2_stream2_isr,
+	dma2_stream3_isr, dma2_stream4_isr, dma2_stream5_isr,
+	dma2_stream6_isr, dma2_stream7_isr,
+};
+
+/* The SPI whose data register is at addr, 0 for none. */
+static uint32_t spi_at(uint32_t addr)
+{
+	uint32_t spi;
+
+	for (spi = SPI1; spi < SPI_PORTS; spi++) {
+		if (addr == (uint32_t)(uintptr_t)&SPI_DR(spi)) {
+			return spi;
+		}
+	}
+	return 0;
+}
+
+static void transfer(struct stream *s)
+{
+	uint8_t *mem = HOST_PTR(s->m0ar);
+	uint32_t size = MSIZE(s);
+	uint32_t spi = spi_at(s->par);
+	uint32_t i;
+
+	switch (s->cr & DMA_SxCR_DIR_MASK) {
+	case DMA_SxCR_DIR_MEM_TO_PERIPHERAL:
+		for (i = 0; spi && i < s->ndtr; i++) {
+			const uint8_t *p = mem + (s->minc ? i * size : 0);
+
+			host_spi_dma(spi, size == 1 ? p[0] : p[0] | p[1] << 8);
+		}
+		break;
+	case DMA_SxCR_DIR_MEM_TO_MEM:
+		memcpy(HOST_PTR(s->m0ar), HOST_PTR(s->par), s->ndtr * size);
+		break;
+	}
+	s->ndtr = 0;
+}
+
+void dma_stream_reset(uint32_t dma, uint8_t stream)
+{
+	memset(&streams[dma][stream], 0, sizeof(streams[dma][stream]));
+}
+
+void dma_channel_select(uint32_t dma, uint8_t stream, uint32_t channel)
+{
+	streams[dma][stream].cr |= channel;
+}
+
+void dma_set_priority(uint32_t dma, uint8_t stream, uint32_t prio)
+{
+	streams[dma][stream].cr |= prio;
+}
+
+void dma_set_memory_size(uint32_t dma, uint8_t stream, uint32_t mem_size)
+{
+	streams[dma][stream].cr &= ~(3 << DMA_SxCR_MSIZE_SHIFT);
+	streams[dma][stream].cr |= mem_size;
+}
+
+void dma_set_peripheral_size(uint32_t dma, uint8_t stream,
+			     uint32_t peripheral_size)
+{
+	streams[dma][stream].cr |= peripheral_size;
+}
+
+void dma_enable_memory_increment_mode(uint32_t dma, uint8_t stream)
+{
+	streams[dma][stream].minc = 1;
+}
+
+void dma_disable_memory_increment_mode(uint32_t dma, uint8_t stream)
+{
+	streams[dma][stream].minc = 0;
+}
+
+void dma_set_transfer_mode(uint32_t dma, uint8_t stream, uint32_t direction)
+{
+	streams[dma][stream].cr &= ~DMA_SxCR_DIR_MASK;
+	streams[dma][stream].cr |= direction;
+}
+
+void dma_set_peripheral_address(uint32_t dma, uint8_t stream,
+				uint32_t address)
+{
+	streams[dma][stream].par = address;
+}
+
+void dma_set_memory_address(uint32_t dma, uint8_t stream, uint32_t address)
+{
+	streams[dma][stream].m0ar = address;
+}
+
+void dma_set_number_of_data(uint32_t dma, uint8_t stream, uint16_t number)
+{
+	streams[dma][stream].ndtr = number;
+}
+
+void dma_enable_transfer_complete_interrupt(uint32_t dma, uint8_t stream)
+{
+	streams[dma][stream].tcie = 1;
+}
+
+void dma_disable_transfer_complete_interrupt(uint32_t dma, uint8_t stream)
+{
+	streams[dma][stream].tcie = 0;
+}
+
+void dma_enable_stream(uint32_t dma, uint8_t stream)
+{
+	struct stream *s = &streams[dma][stream];
+
+	transfer(s);
+	s->flags |= DMA_TCIF;
+	if (s->tcie && dma == DMA2) {
+		host_irq(dma2_irqs[stream], dma2_isrs[stream]);
+	}
+}
+
+void dma_disable_stream(uint32_t dma, uint8_t stream)
+{
+	(void)dma;
+	(void)stream;
+}
+
+bool dma_get_interrupt_flag(uint32_t dma, uint8_t stream, uint32_t interrupts)
+{
+	return (streams[dma][stream].flags & interrupts) != 0;
+}
+
+void dma_clear_interrupt_flags(uint32_t dma, uint8_t stream,
+			       uint32_t interrupts)
+{
+	streams[dma][stream].flags &= ~interrupts;
+}
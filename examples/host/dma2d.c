@@ -0,0 +1,188 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The DMA2D: its registers are plain memory (DMA2D_BASE in
+ * stm32/memorymap.h), and an operation runs to the end once its
+ * interrupt is enabled with START set, which is the moment the
+ * examples' dma2d_submit() lets go of it.  Then TCIF, and the
+ * interrupt, which starts the next one if there is one.  Loading the
+ * foreground CLUT (START in FGPFCCR) goes the same way with CTCIF.
+ * Of the CLUT formats only L8 is modelled.
+ */
+
+#include <libopencm3/stm32/memorymap.h>
+#include <libopencm3/cm3/nvic.h>
+#include "host.h"
+
+volatile uint32_t host_dma2d[0x100];
+
+#define CR		host_dma2d[0x00 / 4]
+#define ISR		host_dma2d[0x04 / 4]
+#define FGMAR		host_dma2d[0x0c / 4]
+#define FGOR		host_dma2d[0x10 / 4]
+#define BGMAR		host_dma2d[0x14 / 4]
+#define BGOR		host_dma2d[0x18 / 4]
+#define FGPFCCR		host_dma2d[0x1c / 4]
+#define FGCOLR		host_dma2d[0x20 / 4]
+#define BGPFCCR		host_dma2d[0x24 / 4]
+#define BGCOLR		host_dma2d[0x28 / 4]
+#define FGCMAR		host_dma2d[0x2c / 4]
+#define OPFCCR		host_dma2d[0x34 / 4]
+#define OCOLR		host_dma2d[0x38 / 4]
+#define OMAR		host_dma2d[0x3c / 4]
+#define OOR		host_dma2d[0x40 / 4]
+#define NLR		host_dma2d[0x44 / 4]
+
+#define CR_START	(1 << 0)
+#define CR_TCIE		(1 << 9)
+#define CR_CTCIE	(1 << 20)
+#define CR_MODE(cr)	((cr) >> 16 & 3)
+#define ISR_TCIF	(1 << 1)
+#define ISR_CTCIF	(1 << 4)
+#define PFCCR_CCM	(1 << 4)
+#define PFCCR_START	(1 << 5)
+#define L8		5
+
+enum { M2M, M2M_PFC, M2M_BLEND, R2M };
+
+__attribute__((weak))
+void dma2d_isr(void)
+{
+}
+
+/* The foreground CLUT, as ARGB8888 */
+static uint32_t clut[256];
+
+static void load_clut(void)
+{
+	const uint8_t *p = HOST_PTR(FGCMAR);
+	int i, n = (FGPFCCR >> 8 & 0xff) + 1;
+
+	for (i = 0; i < n; i++) {
+		if (FGPFCCR & PFCCR_CCM) {
+			clut[i] = host_pixel_get(p, 1);
+			p += 3;
+		} else {
+			clut[i] = host_pixel_get(p, 0);
+			p += 4;
+		}
+	}
+}
+
+/* A pixel of an input, with its PFCCR's alpha mode applied. */
+static uint32_t input(const uint8_t *p, uint32_t pfccr)
+{
+	uint32_t argb = (pfccr & 0xf) == L8 ? clut[*p] :
+			host_pixel_get(p, pfccr & 0xf);
+	uint32_t a = argb >> 24, alpha = pfccr >> 24;
+
+	switch (pfccr >> 16 & 3) {
+	case 1:
+		a = alpha;
+		break;
+	case 2:
+		a = a * alpha / 255;
+		break;
+	}
+	return a << 24 | (argb & 0xffffff);
+}
+
+/* RM0090, section 11.3.7. */
+static uint32_t blend(uint32_t fg, uint32_t bg)
+{
+	uint32_t af = fg >> 24, ab = bg >> 24;
+	uint32_t am = af * ab / 255;
+	uint32_t ao = af + ab - am;
+	uint32_t out = ao << 24;
+	int shift;
+
+	if (ao == 0) {
+		return 0;
+	}
+	for (shift = 0; shift < 24; shift += 8) {
+		uint32_t cf = fg >> shift & 0xff, cb = bg >> shift & 0xff;
+
+		out |= (cf * af + cb * ab - cb * am) / ao << shift;
+	}
+	return out;
+}
+
+static void run(void)
+{
+	uint32_t cr = CR, nlr = NLR;
+	uint32_t w = nlr >> 16 & 0x3fff, h = nlr & 0xffff;
+	int ofmt = OPFCCR & 7, fgfmt = FGPFCCR & 0xf, bgfmt = BGPFCCR & 0xf;
+	int osize = host_pixel_size(ofmt);
+	int fgsize = host_pixel_size(fgfmt), bgsize = host_pixel_size(bgfmt);
+	uint8_t *out = HOST_PTR(OMAR);
+	const uint8_t *fg = HOST_PTR(FGMAR), *bg = HOST_PTR(BGMAR);
+	uint8_t color[4] = {
+		OCOLR, OCOLR >> 8, OCOLR >> 16, OCOLR >> 24
+	};
+	uint32_t argb = host_pixel_get(color, ofmt);
+	uint32_t x, y;
+
+	for (y = 0; y < h; y++) {
+		for (x = 0; x < w; x++) {
+			switch (CR_MODE(cr)) {
+			case M2M:
+				argb = host_pixel_get(fg, fgfmt);
+				break;
+			case M2M_PFC:
+				argb = input(fg, FGPFCCR);
+				break;
+			case M2M_BLEND:
+				argb = blend(input(fg, FGPFCCR),
+					     input(bg, BGPFCCR));
+				break;
+			}
+			host_pixel_put(out, ofmt, argb);
+			out += osize;
+			fg += fgsize;
+			bg += bgsize;
+		}
+		out += (OOR & 0x3fff) * osize;
+		fg += (FGOR & 0x3fff) * fgsize;
+		bg += (BGOR & 0x3fff) * bgsize;
+	}
+	host_stats.dma2d_ops++;
+	host_stats.dma2d_pixels += (uint64_t)w * h;
+}
+
+void host_dma2d_run(void)
+{
+	for (;;) {
+		if (FGPFCCR & PFCCR_START) {
+			load_clut();
+			FGPFCCR &= ~PFCCR_START;
+			ISR |= ISR_CTCIF;
+			if (CR & CR_CTCIE) {
+				host_irq(NVIC_DMA2D_IRQ, dma2d_isr);
+			}
+		} else if (CR & CR_START) {
+			run();
+			CR &= ~CR_START;
+			ISR |= ISR_TCIF;
+			if (CR & CR_TCIE) {
+				host_irq(NVIC_DMA2D_IRQ, dma2d_isr);
+			}
+		} else {
+			break;
+		}
+	}
+}
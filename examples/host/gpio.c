@@ -0,0 +1,76 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* GPIO: only the output levels, which the panel model watches. */
+
+#include <libopencm3/stm32/gpio.h>
+#include "host.h"
+
+static uint16_t odr[GPIO_PORTS];
+
+void gpio_mode_setup(uint32_t gpioport, uint8_t mode, uint8_t pull_up_down,
+		     uint16_t gpios)
+{
+	(void)gpioport;
+	(void)mode;
+	(void)pull_up_down;
+	(void)gpios;
+}
+
+void gpio_set_output_options(uint32_t gpioport, uint8_t otype, uint8_t speed,
+			     uint16_t gpios)
+{
+	(void)gpioport;
+	(void)otype;
+	(void)speed;
+	(void)gpios;
+}
+
+void gpio_set_af(uint32_t gpioport, uint8_t alt_func_num, uint16_t gpios)
+{
+	(void)gpioport;
+	(void)alt_func_num;
+	(void)gpios;
+}
+
+static void gpio_write(uint32_t gpioport, uint16_t value)
+{
+	if (odr[gpioport] != value) {
+		odr[gpioport] = value;
+		host_panel_pins(gpioport);
+	}
+}
+
+void gpio_set(uint32_t gpioport, uint16_t gpios)
+{
+	gpio_write(gpioport, odr[gpioport] | gpios);
+}
+
+void gpio_clear(uint32_t gpioport, uint16_t gpios)
+{
+	gpio_write(gpioport, odr[gpioport] & ~gpios);
+}
+
+void gpio_toggle(uint32_t gpioport, uint16_t gpios)
+{
+	gpio_write(gpioport, odr[gpioport] ^ gpios);
+}
+
+uint16_t gpio_get(uint32_t gpioport, uint16_t gpios)
+{
+	return odr[gpioport] & gpios;
+}
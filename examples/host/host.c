@@ -0,0 +1,252 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The board as a whole: the SDRAM, the clock, when to stop, the
+ * statistics and the pictures.
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "host.h"
+
+/* Where the SDRAM is on the board, see sdram.h in the examples. */
+#define HOST_SDRAM_BASE	0xd0000000UL
+#define HOST_SDRAM_SIZE	(8 * 1024 * 1024)
+
+struct host_stats host_stats;
+
+static struct timespec	start;
+static uint32_t		slept;
+static uint32_t		max_frames = 100;
+static uint32_t		max_ms = 10000;
+static const char	*ppm;
+static uint32_t		ppm_n;
+
+static void host_report(void)
+{
+	int i;
+
+	for (i = 0; i < 7; i++) {
+		if (!host_stats.spi[i].bytes) {
+			continue;
+		}
+		fprintf(stderr, "host: spi%d %llu bytes, %llu by DMA",
+			i, (unsigned long long)host_stats.spi[i].bytes,
+			(unsigned long long)host_stats.spi[i].dma_bytes);
+		if (host_stats.spi[i].hz) {
+			fprintf(stderr, ", %llu ms at %lu kHz",
+				(unsigned long long)host_stats.spi[i].bytes *
+				8000 / host_stats.spi[i].hz,
+				(unsigned long)host_stats.spi[i].hz / 1000);
+		}
+		fprintf(stderr, "\n");
+	}
+	if (host_stats.panel.commands) {
+		fprintf(stderr, "host: panel %lu transactions, %lu commands, "
+			"%lu writes, %llu pixels, %lu frames\n",
+			(unsigned long)host_stats.panel.transactions,
+			(unsigned long)host_stats.panel.commands,
+			(unsigned long)host_stats.panel.writes,
+			(unsigned long long)host_stats.panel.pixels,
+			(unsigned long)host_stats.panel.frames);
+	}
+	if (host_stats.ltdc_frames) {
+		fprintf(stderr, "host: ltdc %lu frames\n",
+			(unsigned long)host_stats.ltdc_frames);
+	}
+	if (host_stats.dma2d_ops) {
+		fprintf(stderr, "host: dma2d %lu operations, %llu pixels\n",
+			(unsigned long)host_stats.dma2d_ops,
+			(unsigned long long)host_stats.dma2d_pixels);
+	}
+	fprintf(stderr, "host: %lu ms\n", (unsigned long)host_ms());
+}
+
+/*
+ * Before main(): put the SDRAM where the examples expect it, and
+ * below 4 GB along with everything else (see rules.mk), as they keep
+ * addresses in uint32_t for the DMA and LTDC registers.
+ */
+__attribute__((constructor))
+static void host_init(void)
+{
+	const char *s;
+	void *sdram;
+
+	sdram = mmap((void *)HOST_SDRAM_BASE, HOST_SDRAM_SIZE,
+		     PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+		     -1, 0);
+	if (sdram != (void *)HOST_SDRAM_BASE) {
+		fprintf(stderr, "host: can't map the SDRAM at 0x%lx\n",
+			HOST_SDRAM_BASE);
+		exit(1);
+	}
+
+	s = getenv("HOST_FRAMES");
+	if (s) {
+		max_frames = strtoul(s, NULL, 0);
+	}
+	s = getenv("HOST_MS");
+	if (s) {
+		max_ms = strtoul(s, NULL, 0);
+	}
+	ppm = getenv("HOST_PPM");
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	atexit(host_report);
+}
+
+uint32_t host_ms(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start.tv_sec) * 1000 +
+	       (now.tv_nsec - start.tv_nsec) / 1000000 + slept;
+}
+
+static void host_check_time(void)
+{
+	if (max_ms && host_ms() >= max_ms) {
+		exit(0);
+	}
+}
+
+void host_sleep(uint32_t ms)
+{
+	slept += ms;
+	host_check_time();
+}
+
+void host_frame(void)
+{
+	static uint32_t frames;
+
+	if (max_frames && ++frames >= max_frames) {
+		exit(0);
+	}
+	host_check_time();
+}
+
+void host_no_limits(void)
+{
+	if (!getenv("HOST_FRAMES")) {
+		max_frames = 0;
+	}
+	if (!getenv("HOST_MS")) {
+		max_ms = 0;
+	}
+}
+
+void host_ppm(const uint32_t *rgb, int w, int h)
+{
+	char name[256];
+	FILE *f;
+	int i;
+
+	if (!ppm) {
+		return;
+	}
+	snprintf(name, sizeof(name), "%s%04lu.ppm", ppm,
+		 (unsigned long)ppm_n++);
+	f = fopen(name, "wb");
+	if (!f) {
+		perror(name);
+		return;
+	}
+	fprintf(f, "P6\n%d %d\n255\n", w, h);
+	for (i = 0; i < w * h; i++) {
+		putc(rgb[i] >> 16 & 0xff, f);
+		putc(rgb[i] >> 8 & 0xff, f);
+		putc(rgb[i] & 0xff, f);
+	}
+	fclose(f);
+}
+
+/*
+ * Pixel formats 0 - 4, the same numbers for the DMA2D and the LTDC.
+ * Memory is little endian, as on the board.
+ */
+int host_pixel_size(int format)
+{
+	static const int size[] = { 4, 3, 2, 2, 2 };
+
+	return format < 5 ? size[format] : 1;
+}
+
+/* Widen an n bit channel to 8 bits. */
+static uint32_t widen(uint32_t v, int n)
+{
+	return (v << (8 - n)) | (v >> (2 * n - 8));
+}
+
+uint32_t host_pixel_get(const uint8_t *p, int format)
+{
+	uint32_t v = p[0] | p[1] << 8;
+
+	switch (format) {
+	case 0:
+		return v | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+	case 1:
+		return 0xff000000 | v | (uint32_t)p[2] << 16;
+	case 2:
+		return 0xff000000 | widen(v >> 11, 5) << 16 |
+		       widen(v >> 5 & 0x3f, 6) << 8 | widen(v & 0x1f, 5);
+	case 3:
+		return (v & 0x8000 ? 0xff000000 : 0) |
+		       widen(v >> 10 & 0x1f, 5) << 16 |
+		       widen(v >> 5 & 0x1f, 5) << 8 | widen(v & 0x1f, 5);
+	case 4:
+		return (v >> 12) * 0x11000000 | (v >> 8 & 0xf) * 0x110000 |
+		       (v >> 4 & 0xf) * 0x1100 | (v & 0xf) * 0x11;
+	}
+	return 0;
+}
+
+void host_pixel_put(uint8_t *p, int format, uint32_t argb)
+{
+	uint32_t v = 0;
+
+	switch (format) {
+	case 0:
+		p[3] = argb >> 24;
+		/* fall through */
+	case 1:
+		p[2] = argb >> 16;
+		p[1] = argb >> 8;
+		p[0] = argb;
+		return;
+	case 2:
+		v = (argb >> 8 & 0xf800) | (argb >> 5 & 0x07e0) |
+		    (argb >> 3 & 0x001f);
+		break;
+	case 3:
+		v = (argb >> 31 ? 0x8000 : 0) | (argb >> 9 & 0x7c00) |
+		    (argb >> 6 & 0x03e0) | (argb >> 3 & 0x001f);
+		break;
+	case 4:
+		v = (argb >> 16 & 0xf000) | (argb >> 12 & 0x0f00) |
+		    (argb >> 8 & 0x00f0) | (argb >> 4 & 0x000f);
+		break;
+	}
+	p[0] = v;
+	p[1] = v >> 8;
+}
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __HOST_H
+#define __HOST_H
+
+#include <stdint.h>
+
+/*
+ * What the models in host/ share.  The examples never include this,
+ * they only see the libopencm3 headers in host/include.
+ */
+
+/* What went over the buses, printed on the way out. */
+struct host_stats {
+	struct {
+		uint64_t	bytes;		/* all of them */
+		uint64_t	dma_bytes;	/* those sent by DMA */
+		uint32_t	hz;		/* bit clock, from CR1 */
+	} spi[7];
+	struct {
+		uint32_t	transactions;	/* chip select low to high */
+		uint32_t	commands;
+		uint32_t	writes;		/* memory writes (0x2C, 0x3C) */
+		uint64_t	pixels;
+		uint32_t	frames;		/* writes of the whole screen */
+	} panel;
+	uint32_t	ltdc_frames;
+	uint32_t	dma2d_ops;
+	uint64_t	dma2d_pixels;
+};
+
+extern struct host_stats host_stats;
+
+/*
+ * Time since start, in ms, with the time the program slept added on:
+ * host_sleep() moves the clock on without waiting.
+ */
+uint32_t host_ms(void);
+void host_sleep(uint32_t ms);
+
+/*
+ * A display model showed a frame.  Stops the program after
+ * $HOST_FRAMES of them (100 unless set), or when it is $HOST_MS in
+ * (10000 unless set).  The environment variables are read at start.
+ */
+void host_frame(void);
+
+/*
+ * For programs that stop by themselves (HOST_PROGS in host.mk): no
+ * frame or time limit, other than one set in the environment.
+ */
+void host_no_limits(void);
+
+/* Write a 0xRRGGBB image to $HOST_PPM<n>.ppm, if HOST_PPM is set. */
+void host_ppm(const uint32_t *rgb, int w, int h);
+
+/* Raise an interrupt, see cm3/nvic.h. */
+void host_irq(uint8_t irqn, void (*isr)(void));
+int host_irq_enabled(uint8_t irqn);
+
+/* The pixel formats the DMA2D and the LTDC share, to and from ARGB8888. */
+int host_pixel_size(int format);
+uint32_t host_pixel_get(const uint8_t *p, int format);
+void host_pixel_put(uint8_t *p, int format, uint32_t argb);
+
+/* A frame the DMA model moves to an SPI data register, see spi.c. */
+void host_spi_dma(uint32_t spi, uint16_t data);
+
+/* What the panel model shows, 320 rows of 240 RGB565 pixels. */
+const uint16_t *host_panel_frame(void);
+
+/* Callbacks from the bus models into the panel model. */
+void host_panel_pins(uint32_t port);
+void host_panel_byte(uint32_t spi, uint8_t byte);
+
+/* Called from nvic_enable_irq(NVIC_DMA2D_IRQ), see host/dma2d.c. */
+void host_dma2d_run(void);
+
+/* Memory addresses, as the examples keep them, in 32 bits. */
+#define HOST_PTR(a)	((uint8_t *)(uintptr_t)(a))
+
+#endif
@@ -0,0 +1,102 @@
+##
+## This file is part of the libopencm3 project.
+##
+## This library is free software: you can redistribute it and/or modify
+## it under the terms of the GNU Lesser General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## This library is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU Lesser General Public License for more details.
+##
+## You should have received a copy of the GNU Lesser General Public License
+## along with this library.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+# 'make HOST=1': build the example as a program for the build machine,
+# against the models in this directory instead of libopencm3 and the
+# chip (see README.md).  rules.mk includes this in place of itself.
+#
+# The example's Makefile says what goes in:
+#   HOST_OBJS	its objects that run unchanged, $(BINARY).o is added
+#   HOST_SHIMS	files of this directory that stand in for its own
+#		(clock, console)
+#   HOST_DEFS	extra flags, such as where the panel is wired
+#   HOST_PROGS	benchmarks and checks of its own: each name.c is linked
+#		with HOST_OBJS and the models into name.host, without
+#		$(BINARY).o, and can include host.h.  'make HOST=1 check'
+#		runs them all.
+
+ifneq ($(V),1)
+Q		:= @
+endif
+
+HOST_DIR	:= $(dir $(lastword $(MAKEFILE_LIST)))
+HOSTCC		?= cc
+CSTD		?= -std=c99
+
+ifeq ($(strip $(HOST_OBJS)),)
+$(error $(BINARY) has no HOST_OBJS, it does not build with HOST=1)
+endif
+
+HOST_MODELS	:= host core gpio spi dma ltdc dma2d ili9341 $(HOST_SHIMS)
+HOST_ALL_OBJS	:= $(HOST_OBJS:.o=.host.o) $(BINARY).host.o \
+		   $(HOST_MODELS:%=host-%.o)
+HOST_LIB_OBJS	:= $(HOST_OBJS:.o=.host.o) $(HOST_MODELS:%=host-%.o)
+HOST_PROG_OBJS	:= $(HOST_PROGS:=.host.o)
+
+###############################################################################
+# Flags: the targets' warnings, and the 32 bit addresses the examples
+# keep in registers have to fit, so no PIE (see README.md).
+
+HOST_CFLAGS	+= -O2 $(CSTD) -g -pthread
+HOST_CFLAGS	+= -Wextra -Wshadow -Wimplicit-function-declaration
+HOST_CFLAGS	+= -Wredundant-decls -Wmissing-prototypes -Wstrict-prototypes
+HOST_CFLAGS	+= -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast
+HOST_CPPFLAGS	+= -MD -Wall -Wundef -DHOST
+HOST_CPPFLAGS	+= -I$(HOST_DIR)include $(DEFS) $(HOST_DEFS)
+HOST_LDFLAGS	+= -pthread -no-pie
+HOST_LDLIBS	+= -lm
+
+###############################################################################
+
+.SECONDARY:
+
+all: host
+
+host: $(BINARY).host $(HOST_PROGS:=.host)
+
+$(BINARY).host: $(HOST_ALL_OBJS)
+	@#printf "  LD      $@\n"
+	$(Q)$(HOSTCC) $(HOST_LDFLAGS) $(HOST_ALL_OBJS) $(HOST_LDLIBS) -o $@
+
+$(HOST_PROGS:=.host): %.host: %.host.o $(HOST_LIB_OBJS)
+	@#printf "  LD      $@\n"
+	$(Q)$(HOSTCC) $(HOST_LDFLAGS) $^ $(HOST_LDLIBS) -o $@
+
+$(HOST_PROG_OBJS): HOST_CPPFLAGS += -I$(HOST_DIR)
+
+check: $(HOST_PROGS:=.host)
+	$(Q)set -e; for p in $(HOST_PROGS); do ./$$p.host; done
+
+%.host.o: %.c
+	@#printf "  CC      $(*).c\n"
+	$(Q)$(HOSTCC) $(HOST_CFLAGS) $(CFLAGS) $(HOST_CPPFLAGS) $(CPPFLAGS) -o $@ -c $<
+
+host-%.o: $(HOST_DIR)%.c
+	@#printf "  CC      $<\n"
+	$(Q)$(HOSTCC) $(HOST_CFLAGS) $(CFLAGS) $(HOST_CPPFLAGS) $(CPPFLAGS) -o $@ -c $<
+
+print-%:
+	@echo $*=$($*)
+
+clean:
+	@#printf "  CLEAN\n"
+	$(Q)$(RM) $(BINARY).host $(HOST_ALL_OBJS) $(HOST_ALL_OBJS:.o=.d)
+	$(Q)$(RM) $(HOST_PROGS:=.host) $(HOST_PROG_OBJS) $(HOST_PROG_OBJS:.o=.d)
+
+.PHONY: all host check clean
+
+-include $(HOST_ALL_OBJS:.o=.d) $(HOST_PROG_OBJS:.o=.d)
@@ -0,0 +1,234 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * An ILI9341 on the end of the SPI bus.  Bytes count while its chip
+ * select is low; D/CX low makes one a command.  It keeps the 240x320
+ * RGB565 frame memory the commands write, and takes its pins from
+ *
+ *	HOST_PANEL_SPI				SPI5
+ *	HOST_PANEL_CS_PORT, HOST_PANEL_CS_PIN	GPIOC, GPIO2
+ *	HOST_PANEL_DC_PORT, HOST_PANEL_DC_PIN	GPIOD, GPIO13
+ *	HOST_PANEL_MADCTL			0
+ *
+ * which is how the F429 discovery wires it; an example that wires it
+ * differently sets them in HOST_DEFS.  HOST_PANEL_MADCTL is how the
+ * glass is mounted, in MADCTL bits: the image is as the panel shows
+ * it with that MADCTL, portrait, top left first.  Writing a screen's worth
+ * of pixels into a window at least the size of the screen is a frame, as
+ * is whatever is on the screen at exit.
+ */
+
+#include <stdlib.h>
+#include <libopencm3/stm32/gpio.h>
+#include <libopencm3/stm32/spi.h>
+#include "host.h"
+
+#ifndef HOST_PANEL_SPI
+#define HOST_PANEL_SPI		SPI5
+#endif
+#ifndef HOST_PANEL_CS_PORT
+#define HOST_PANEL_CS_PORT	GPIOC
+#define HOST_PANEL_CS_PIN	GPIO2
+#endif
+#ifndef HOST_PANEL_DC_PORT
+#define HOST_PANEL_DC_PORT	GPIOD
+#define HOST_PANEL_DC_PIN	GPIO13
+#endif
+
+#ifndef HOST_PANEL_MADCTL
+#define HOST_PANEL_MADCTL	0
+#endif
+
+#define PANEL_WIDTH	240
+#define PANEL_HEIGHT	320
+
+/* MADCTL */
+#define MADCTL_MY	0x80
+#define MADCTL_MX	0x40
+#define MADCTL_MV	0x20
+#define MADCTL_BGR	0x08
+
+static struct {
+	int		active;		/* bytes went since chip select */
+	uint8_t		cmd;
+	int		arg;		/* bytes of data since cmd */
+	uint16_t	xs, xe, ys, ye;	/* the window, as CASET and PASET set it */
+	uint16_t	x, y;		/* where the next pixel goes in it */
+	uint8_t		madctl;
+	int		half;		/* the first byte of a pixel is in */
+	uint16_t	pixel;
+	uint32_t	written;	/* pixels into a full screen window */
+	int		dirty;		/* changed since the last frame */
+	uint16_t	fb[PANEL_HEIGHT][PANEL_WIDTH];
+} panel;
+
+static uint32_t rgb[PANEL_HEIGHT * PANEL_WIDTH];
+
+static void panel_show(void)
+{
+	int i;
+
+	for (i = 0; i < PANEL_HEIGHT * PANEL_WIDTH; i++) {
+		uint16_t p = panel.fb[i / PANEL_WIDTH][i % PANEL_WIDTH];
+		uint32_t r = (p >> 11) & 0x1f, g = (p >> 5) & 0x3f, b = p & 0x1f;
+
+		r = r << 3 | r >> 2;
+		g = g << 2 | g >> 4;
+		b = b << 3 | b >> 2;
+		/* The discovery's panel is BGR; without the bit, swap. */
+		if (!(panel.madctl & MADCTL_BGR)) {
+			uint32_t t = r;
+			r = b;
+			b = t;
+		}
+		rgb[i] = r << 16 | g << 8 | b;
+	}
+	host_ppm(rgb, PANEL_WIDTH, PANEL_HEIGHT);
+	panel.dirty = 0;
+}
+
+static void panel_exit(void)
+{
+	if (panel.dirty) {
+		panel_show();
+	}
+}
+
+__attribute__((constructor))
+static void panel_init(void)
+{
+	panel.xe = PANEL_WIDTH - 1;
+	panel.ye = PANEL_HEIGHT - 1;
+	atexit(panel_exit);
+}
+
+/* Store a pixel at the cursor, and move it on through the window. */
+static void panel_pixel(uint16_t p)
+{
+	uint8_t madctl = panel.madctl ^ HOST_PANEL_MADCTL;
+	int col = panel.x, row = panel.y;
+
+	if (madctl & MADCTL_MV) {
+		col = panel.y;
+		row = panel.x;
+	}
+	if (madctl & MADCTL_MX) {
+		col = PANEL_WIDTH - 1 - col;
+	}
+	if (madctl & MADCTL_MY) {
+		row = PANEL_HEIGHT - 1 - row;
+	}
+	if (col >= 0 && col < PANEL_WIDTH && row >= 0 && row < PANEL_HEIGHT) {
+		panel.fb[row][col] = p;
+		panel.dirty = 1;
+	}
+	host_stats.panel.pixels++;
+
+	if (++panel.x > panel.xe) {
+		panel.x = panel.xs;
+		if (++panel.y > panel.ye) {
+			panel.y = panel.ys;
+		}
+	}
+
+	if ((uint32_t)(panel.xe - panel.xs + 1) * (panel.ye - panel.ys + 1) >=
+	    PANEL_WIDTH * PANEL_HEIGHT &&
+	    ++panel.written == PANEL_WIDTH * PANEL_HEIGHT) {
+		panel.written = 0;
+		host_stats.panel.frames++;
+		panel_show();
+		host_frame();
+	}
+}
+
+static void panel_command(uint8_t cmd)
+{
+	host_stats.panel.commands++;
+	panel.cmd = cmd;
+	panel.arg = 0;
+	panel.half = 0;
+	if (cmd == 0x2C) {			/* Memory Write */
+		panel.x = panel.xs;
+		panel.y = panel.ys;
+		panel.written = 0;
+	}
+	if (cmd == 0x2C || cmd == 0x3C) {	/* and Memory Write Continue */
+		host_stats.panel.writes++;
+	}
+}
+
+static void panel_data(uint8_t byte)
+{
+	int arg = panel.arg++;
+
+	switch (panel.cmd) {
+	case 0x2A:				/* Column Address Set */
+		if (arg < 2) {
+			panel.xs = (arg ? panel.xs : 0) << 8 | byte;
+		} else if (arg < 4) {
+			panel.xe = (arg > 2 ? panel.xe : 0) << 8 | byte;
+		}
+		break;
+	case 0x2B:				/* Page Address Set */
+		if (arg < 2) {
+			panel.ys = (arg ? panel.ys : 0) << 8 | byte;
+		} else if (arg < 4) {
+			panel.ye = (arg > 2 ? panel.ye : 0) << 8 | byte;
+		}
+		break;
+	case 0x36:				/* Memory Access Control */
+		panel.madctl = byte;
+		break;
+	case 0x2C:
+	case 0x3C:
+		panel.pixel = panel.pixel << 8 | byte;
+		panel.half = !panel.half;
+		if (!panel.half) {
+			panel_pixel(panel.pixel);
+		}
+		break;
+	}
+}
+
+const uint16_t *host_panel_frame(void)
+{
+	return &panel.fb[0][0];
+}
+
+void host_panel_pins(uint32_t port)
+{
+	if (port == HOST_PANEL_CS_PORT && panel.active &&
+	    gpio_get(HOST_PANEL_CS_PORT, HOST_PANEL_CS_PIN)) {
+		host_stats.panel.transactions++;
+		panel.active = 0;
+	}
+}
+
+void host_panel_byte(uint32_t spi, uint8_t byte)
+{
+	if (spi != HOST_PANEL_SPI ||
+	    gpio_get(HOST_PANEL_CS_PORT, HOST_PANEL_CS_PIN)) {
+		return;
+	}
+	panel.active = 1;
+	if (gpio_get(HOST_PANEL_DC_PORT, HOST_PANEL_DC_PIN)) {
+		panel_data(byte);
+	} else {
+		panel_command(byte);
+	}
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_LIBOPENCM3_CM3_NVIC_H
+#define HOST_LIBOPENCM3_CM3_NVIC_H
+
+#include <stdint.h>
+
+/*
+ * Interrupts.  A model raises one with host_irq() (see host/host.h);
+ * the handler runs then if the interrupt is enabled, or as soon as it
+ * is enabled otherwise.  Disabling an interrupt waits for its handler
+ * to finish, if one is running on another thread.
+ */
+#define NVIC_USART1_IRQ		37
+#define NVIC_DMA2_STREAM0_IRQ	56
+#define NVIC_DMA2_STREAM1_IRQ	57
+#define NVIC_DMA2_STREAM2_IRQ	58
+#define NVIC_DMA2_STREAM3_IRQ	59
+#define NVIC_DMA2_STREAM4_IRQ	60
+#define NVIC_DMA2_STREAM5_IRQ	68
+#define NVIC_DMA2_STREAM6_IRQ	69
+#define NVIC_DMA2_STREAM7_IRQ	70
+#define NVIC_SPI5_IRQ		85
+#define NVIC_LCD_TFT_IRQ	88
+#define NVIC_DMA2D_IRQ		90
+#define NVIC_IRQ_COUNT		91
+
+void nvic_enable_irq(uint8_t irqn);
+void nvic_disable_irq(uint8_t irqn);
+
+/* The handlers the examples may define. */
+void sys_tick_handler(void);
+void usart1_isr(void);
+void spi5_isr(void);
+void dma2_stream0_isr(void);
+void dma2_stream1_isr(void);
+void dma2_stream2_isr(void);
+void dma2_stream3_isr(void);
+void dma2_stream4_isr(void);
+void dma2_stream5_isr(void);
+void dma2_stream6_isr(void);
+void dma2_stream7_isr(void);
+void lcd_tft_isr(void);
+void dma2d_isr(void);
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_LIBOPENCM3_STM32_DMA_H
+#define HOST_LIBOPENCM3_STM32_DMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * The DMA controllers.  A stream does its whole transfer the moment it
+ * is enabled (see host/dma.c), so it is done by the time
+ * dma_enable_stream() returns, interrupt and all.
+ */
+#define DMA1		1
+#define DMA2		2
+
+#define DMA_STREAM0	0
+#define DMA_STREAM1	1
+#define DMA_STREAM2	2
+#define DMA_STREAM3	3
+#define DMA_STREAM4	4
+#define DMA_STREAM5	5
+#define DMA_STREAM6	6
+#define DMA_STREAM7	7
+
+#define DMA_SxCR_DIR_PERIPHERAL_TO_MEM	(0 << 6)
+#define DMA_SxCR_DIR_MEM_TO_PERIPHERAL	(1 << 6)
+#define DMA_SxCR_DIR_MEM_TO_MEM		(2 << 6)
+#define DMA_SxCR_DIR_MASK		(3 << 6)
+#define DMA_SxCR_PSIZE_8BIT		(0 << 11)
+#define DMA_SxCR_PSIZE_16BIT		(1 << 11)
+#define DMA_SxCR_PSIZE_32BIT		(2 << 11)
+#define DMA_SxCR_MSIZE_8BIT		(0 << 13)
+#define DMA_SxCR_MSIZE_16BIT		(1 << 13)
+#define DMA_SxCR_MSIZE_32BIT		(2 << 13)
+#define DMA_SxCR_MSIZE_SHIFT		13
+#define DMA_SxCR_PL_LOW			(0 << 16)
+#define DMA_SxCR_PL_MEDIUM		(1 << 16)
+#define DMA_SxCR_PL_HIGH		(2 << 16)
+#define DMA_SxCR_PL_VERY_HIGH		(3 << 16)
+#define DMA_SxCR_CHSEL_0		(0 << 25)
+#define DMA_SxCR_CHSEL_1		(1 << 25)
+#define DMA_SxCR_CHSEL_2		(2 << 25)
+#define DMA_SxCR_CHSEL_3		(3 << 25)
+#define DMA_SxCR_CHSEL_4		(4 << 25)
+#define DMA_SxCR_CHSEL_5		(5 << 25)
+#define DMA_SxCR_CHSEL_6		(6 << 25)
+#define DMA_SxCR_CHSEL_7		(7 << 25)
+
+#define DMA_FEIF	(1 << 0)
+#define DMA_DMEIF	(1 << 2)
+#define DMA_TEIF	(1 << 3)
+#define DMA_HTIF	(1 << 4)
+#define DMA_TCIF	(1 << 5)
+
+void dma_stream_reset(uint32_t dma, uint8_t stream);
+void dma_channel_select(uint32_t dma, uint8_t stream, uint32_t channel);
+void dma_set_priority(uint32_t dma, uint8_t stream, uint32_t prio);
+void dma_set_memory_size(uint32_t dma, uint8_t stream, uint32_t mem_size);
+void dma_set_peripheral_size(uint32_t dma, uint8_t stream,
+			     uint32_t peripheral_size);
+void dma_enable_memory_increment_mode(uint32_t dma, uint8_t stream);
+void dma_disable_memory_increment_mode(uint32_t dma, uint8_t stream);
+void dma_set_transfer_mode(uint32_t dma, uint8_t stream, uint32_t direction);
+void dma_set_peripheral_address(uint32_t dma, uint8_t stream,
+				uint32_t address);
+void dma_set_memory_address(uint32_t dma, uint8_t stream, uint32_t address);
+void dma_set_number_of_data(uint32_t dma, uint8_t stream, uint16_t number);
+void dma_enable_transfer_complete_interrupt(uint32_t dma, uint8_t stream);
+void dma_disable_transfer_complete_interrupt(uint32_t dma, uint8_t stream);
+void dma_enable_stream(uint32_t dma, uint8_t stream);
+void dma_disable_stream(uint32_t dma, uint8_t stream);
+bool dma_get_interrupt_flag(uint32_t dma, uint8_t stream, uint32_t interrupts);
+void dma_clear_interrupt_flags(uint32_t dma, uint8_t stream,
+			       uint32_t interrupts);
+
+#endif
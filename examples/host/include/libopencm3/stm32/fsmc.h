@@ -0,0 +1,83 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_LIBOPENCM3_STM32_FSMC_H
+#define HOST_LIBOPENCM3_STM32_FSMC_H
+
+#include <stdint.h>
+
+/*
+ * The SDRAM side of the FMC.  The SDRAM itself is there from the
+ * start (host/host.c maps it where it is on the board), so the
+ * registers are only somewhere for sdram_init() to write to.
+ */
+struct host_fmc {
+	uint32_t	sdcr[2], sdtr[2], sdcmr, sdrtr, sdsr;
+};
+
+extern volatile struct host_fmc host_fmc;
+
+#define FMC_SDCR1	host_fmc.sdcr[0]
+#define FMC_SDCR2	host_fmc.sdcr[1]
+#define FMC_SDTR1	host_fmc.sdtr[0]
+#define FMC_SDTR2	host_fmc.sdtr[1]
+#define FMC_SDCMR	host_fmc.sdcmr
+#define FMC_SDRTR	host_fmc.sdrtr
+#define FMC_SDSR	host_fmc.sdsr
+
+#define FMC_SDCR_NC_8		(0 << 0)
+#define FMC_SDCR_NC_9		(1 << 0)
+#define FMC_SDCR_NR_12		(1 << 2)
+#define FMC_SDCR_MWID_16b	(1 << 4)
+#define FMC_SDCR_NB4		(1 << 6)
+#define FMC_SDCR_CAS_3CYC	(3 << 7)
+#define FMC_SDCR_SDCLK_2HCLK	(2 << 10)
+#define FMC_SDCR_RPIPE_1CLK	(1 << 13)
+#define FMC_SDCR_DNC_MASK	(0x7f << 8)
+#define FMC_SDTR_DNC_MASK	0x00f00f00
+
+#define SDRAM_MODE_BURST_LENGTH_2		(1 << 0)
+#define SDRAM_MODE_BURST_TYPE_SEQUENTIAL	(0 << 3)
+#define SDRAM_MODE_CAS_LATENCY_3		(3 << 4)
+#define SDRAM_MODE_OPERATING_MODE_STANDARD	(0 << 7)
+#define SDRAM_MODE_WRITEBURST_MODE_SINGLE	(1 << 9)
+
+struct sdram_timing {
+	int	trcd, trp, twr, trc, tras, txsr, tmrd;
+};
+
+enum fmc_sdram_bank {
+	SDRAM_BANK1,
+	SDRAM_BANK2,
+	SDRAM_BOTH_BANKS,
+};
+
+enum fmc_sdram_command {
+	SDRAM_CLK_CONF,
+	SDRAM_NORMAL,
+	SDRAM_PALL,
+	SDRAM_AUTO_REFRESH,
+	SDRAM_LOAD_MODE,
+	SDRAM_SELF_REFRESH,
+	SDRAM_POWER_DOWN,
+};
+
+uint32_t sdram_timing(struct sdram_timing *t);
+void sdram_command(enum fmc_sdram_bank bank, enum fmc_sdram_command cmd,
+		   int autorefresh, int modereg);
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_LIBOPENCM3_STM32_GPIO_H
+#define HOST_LIBOPENCM3_STM32_GPIO_H
+
+#include <stdint.h>
+
+/* Ports are just numbers here. */
+#define GPIOA		0
+#define GPIOB		1
+#define GPIOC		2
+#define GPIOD		3
+#define GPIOE		4
+#define GPIOF		5
+#define GPIOG		6
+#define GPIOH		7
+#define GPIOI		8
+#define GPIOJ		9
+#define GPIOK		10
+#define GPIO_PORTS	11
+
+#define GPIO0		(1 << 0)
+#define GPIO1		(1 << 1)
+#define GPIO2		(1 << 2)
+#define GPIO3		(1 << 3)
+#define GPIO4		(1 << 4)
+#define GPIO5		(1 << 5)
+#define GPIO6		(1 << 6)
+#define GPIO7		(1 << 7)
+#define GPIO8		(1 << 8)
+#define GPIO9		(1 << 9)
+#define GPIO10		(1 << 10)
+#define GPIO11		(1 << 11)
+#define GPIO12		(1 << 12)
+#define GPIO13		(1 << 13)
+#define GPIO14		(1 << 14)
+#define GPIO15		(1 << 15)
+#define GPIO_ALL	0xffff
+
+#define GPIO_MODE_INPUT		0
+#define GPIO_MODE_OUTPUT	1
+#define GPIO_MODE_AF		2
+#define GPIO_MODE_ANALOG	3
+
+#define GPIO_PUPD_NONE		0
+#define GPIO_PUPD_PULLUP	1
+#define GPIO_PUPD_PULLDOWN	2
+
+#define GPIO_OTYPE_PP		0
+#define GPIO_OTYPE_OD		1
+
+#define GPIO_OSPEED_2MHZ	0
+#define GPIO_OSPEED_25MHZ	1
+#define GPIO_OSPEED_50MHZ	2
+#define GPIO_OSPEED_100MHZ	3
+
+#define GPIO_AF0	0
+#define GPIO_AF1	1
+#define GPIO_AF2	2
+#define GPIO_AF3	3
+#define GPIO_AF4	4
+#define GPIO_AF5	5
+#define GPIO_AF6	6
+#define GPIO_AF7	7
+#define GPIO_AF8	8
+#define GPIO_AF9	9
+#define GPIO_AF10	10
+#define GPIO_AF11	11
+#define GPIO_AF12	12
+#define GPIO_AF13	13
+#define GPIO_AF14	14
+#define GPIO_AF15	15
+
+void gpio_mode_setup(uint32_t gpioport, uint8_t mode, uint8_t pull_up_down,
+		     uint16_t gpios);
+void gpio_set_output_options(uint32_t gpioport, uint8_t otype, uint8_t speed,
+			     uint16_t gpios);
+void gpio_set_af(uint32_t gpioport, uint8_t alt_func_num, uint16_t gpios);
+void gpio_set(uint32_t gpioport, uint16_t gpios);
+void gpio_clear(uint32_t gpioport, uint16_t gpios);
+void gpio_toggle(uint32_t gpioport, uint16_t gpios);
+uint16_t gpio_get(uint32_t gpioport, uint16_t gpios);
+
+#endif
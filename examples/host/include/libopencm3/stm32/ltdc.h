@@ -0,0 +1,150 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_LIBOPENCM3_STM32_LTDC_H
+#define HOST_LIBOPENCM3_STM32_LTDC_H
+
+#include <stdint.h>
+
+/*
+ * The LCD-TFT controller's registers, in memory.  host/ltdc.c scans
+ * out what they describe once a frame; there are no shadow registers,
+ * so a write shows from the next frame whatever SRCR says.  A reload
+ * asked for in SRCR is done at the end of that frame, with its
+ * interrupt.
+ */
+struct host_ltdc_layer {
+	uint32_t	cr, whpcr, wvpcr, ckcr, pfcr, cacr, dccr, bfcr;
+	uint32_t	cfbar, cfblr, cfblnr;
+};
+
+struct host_ltdc {
+	uint32_t	sscr, bpcr, awcr, twcr, gcr, srcr, bccr;
+	uint32_t	ier, isr, icr, lipcr;
+	struct host_ltdc_layer layer[2];
+};
+
+extern volatile struct host_ltdc host_ltdc;
+
+/*
+ * The CLUT write register takes one entry at a time, so it is a
+ * function that files the last one written and hands out the slot for
+ * the next.
+ */
+volatile uint32_t *host_ltdc_clutwr(int layer);
+
+#define LTDC_SSCR	host_ltdc.sscr
+#define LTDC_BPCR	host_ltdc.bpcr
+#define LTDC_AWCR	host_ltdc.awcr
+#define LTDC_TWCR	host_ltdc.twcr
+#define LTDC_GCR	host_ltdc.gcr
+#define LTDC_SRCR	host_ltdc.srcr
+#define LTDC_BCCR	host_ltdc.bccr
+#define LTDC_IER	host_ltdc.ier
+#define LTDC_ISR	host_ltdc.isr
+#define LTDC_ICR	host_ltdc.icr
+#define LTDC_LIPCR	host_ltdc.lipcr
+
+#define LTDC_LxCR(l)	host_ltdc.layer[(l) - 1].cr
+#define LTDC_LxWHPCR(l)	host_ltdc.layer[(l) - 1].whpcr
+#define LTDC_LxWVPCR(l)	host_ltdc.layer[(l) - 1].wvpcr
+#define LTDC_LxCKCR(l)	host_ltdc.layer[(l) - 1].ckcr
+#define LTDC_LxPFCR(l)	host_ltdc.layer[(l) - 1].pfcr
+#define LTDC_LxCACR(l)	host_ltdc.layer[(l) - 1].cacr
+#define LTDC_LxDCCR(l)	host_ltdc.layer[(l) - 1].dccr
+#define LTDC_LxBFCR(l)	host_ltdc.layer[(l) - 1].bfcr
+#define LTDC_LxCFBAR(l)	host_ltdc.layer[(l) - 1].cfbar
+#define LTDC_LxCFBLR(l)	host_ltdc.layer[(l) - 1].cfblr
+#define LTDC_LxCFBLNR(l) host_ltdc.layer[(l) - 1].cfblnr
+#define LTDC_LxCLUTWR(l) (*host_ltdc_clutwr(l))
+
+#define LTDC_L1CR	LTDC_LxCR(1)
+#define LTDC_L1WHPCR	LTDC_LxWHPCR(1)
+#define LTDC_L1WVPCR	LTDC_LxWVPCR(1)
+#define LTDC_L1CKCR	LTDC_LxCKCR(1)
+#define LTDC_L1PFCR	LTDC_LxPFCR(1)
+#define LTDC_L1CACR	LTDC_LxCACR(1)
+#define LTDC_L1DCCR	LTDC_LxDCCR(1)
+#define LTDC_L1BFCR	LTDC_LxBFCR(1)
+#define LTDC_L1CFBAR	LTDC_LxCFBAR(1)
+#define LTDC_L1CFBLR	LTDC_LxCFBLR(1)
+#define LTDC_L1CFBLNR	LTDC_LxCFBLNR(1)
+#define LTDC_L1CLUTWR	LTDC_LxCLUTWR(1)
+
+#define LTDC_L2CR	LTDC_LxCR(2)
+#define LTDC_L2WHPCR	LTDC_LxWHPCR(2)
+#define LTDC_L2WVPCR	LTDC_LxWVPCR(2)
+#define LTDC_L2CKCR	LTDC_LxCKCR(2)
+#define LTDC_L2PFCR	LTDC_LxPFCR(2)
+#define LTDC_L2CACR	LTDC_LxCACR(2)
+#define LTDC_L2DCCR	LTDC_LxDCCR(2)
+#define LTDC_L2BFCR	LTDC_LxBFCR(2)
+#define LTDC_L2CFBAR	LTDC_LxCFBAR(2)
+#define LTDC_L2CFBLR	LTDC_LxCFBLR(2)
+#define LTDC_L2CFBLNR	LTDC_LxCFBLNR(2)
+#define LTDC_L2CLUTWR	LTDC_LxCLUTWR(2)
+
+#define LTDC_SSCR_HSW_SHIFT		16
+#define LTDC_SSCR_VSH_SHIFT		0
+#define LTDC_BPCR_AHBP_SHIFT		16
+#define LTDC_BPCR_AVBP_SHIFT		0
+#define LTDC_AWCR_AAW_SHIFT		16
+#define LTDC_AWCR_AAH_SHIFT		0
+#define LTDC_TWCR_TOTALW_SHIFT		16
+#define LTDC_TWCR_TOTALH_SHIFT		0
+
+#define LTDC_GCR_LTDC_ENABLE		(1 << 0)
+#define LTDC_GCR_PCPOL_ACTIVE_LOW	(0 << 28)
+#define LTDC_GCR_PCPOL_ACTIVE_HIGH	(1 << 28)
+
+#define LTDC_SRCR_IMR			(1 << 0)
+#define LTDC_SRCR_VBR			(1 << 1)
+
+#define LTDC_IER_LIE			(1 << 0)
+#define LTDC_IER_RRIE			(1 << 3)
+#define LTDC_ISR_LIF			(1 << 0)
+#define LTDC_ISR_RRIF			(1 << 3)
+#define LTDC_ICR_CLIF			(1 << 0)
+#define LTDC_ICR_CRRIF			(1 << 3)
+
+#define LTDC_LxCR_LAYER_ENABLE		(1 << 0)
+#define LTDC_LxCR_COLKEY_ENABLE		(1 << 1)
+#define LTDC_LxCR_CLUT_ENABLE		(1 << 4)
+
+#define LTDC_LxWHPCR_WHSTPOS_SHIFT	0
+#define LTDC_LxWHPCR_WHSPPOS_SHIFT	16
+#define LTDC_LxWVPCR_WVSTPOS_SHIFT	0
+#define LTDC_LxWVPCR_WVSPPOS_SHIFT	16
+
+#define LTDC_LxPFCR_ARGB8888		0
+#define LTDC_LxPFCR_RGB888		1
+#define LTDC_LxPFCR_RGB565		2
+#define LTDC_LxPFCR_ARGB1555		3
+#define LTDC_LxPFCR_ARGB4444		4
+#define LTDC_LxPFCR_L8			5
+#define LTDC_LxPFCR_AL44		6
+#define LTDC_LxPFCR_AL88		7
+
+#define LTDC_LxBFCR_BF1_CONST_ALPHA			(4 << 8)
+#define LTDC_LxBFCR_BF1_PIXEL_ALPHA_x_CONST_ALPHA	(6 << 8)
+#define LTDC_LxBFCR_BF2_CONST_ALPHA			(5 << 0)
+#define LTDC_LxBFCR_BF2_PIXEL_ALPHA_x_CONST_ALPHA	(7 << 0)
+
+#define LTDC_LxCFBLR_CFBP_SHIFT		16
+#define LTDC_LxCFBLR_CFBLL_SHIFT	0
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host stand-in for libopencm3 (see host/README.md): only what the
+ * examples built with HOST=1 use.  Registers that the code pokes
+ * directly live in ordinary memory, the peripheral models in host/
+ * look at them when something happens.
+ */
+
+#ifndef HOST_LIBOPENCM3_STM32_MEMORYMAP_H
+#define HOST_LIBOPENCM3_STM32_MEMORYMAP_H
+
+#include <stdint.h>
+
+/* dma2d.c in the examples brings its own register offsets. */
+extern volatile uint32_t host_dma2d[0x100];
+#define DMA2D_BASE	((uintptr_t)host_dma2d)
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_LIBOPENCM3_STM32_RCC_H
+#define HOST_LIBOPENCM3_STM32_RCC_H
+
+#include <stdint.h>
+#include <libopencm3/stm32/memorymap.h>
+
+enum rcc_periph_clken {
+	RCC_GPIOA	= 1 << 0,
+	RCC_GPIOB	= 1 << 1,
+	RCC_GPIOC	= 1 << 2,
+	RCC_GPIOD	= 1 << 3,
+	RCC_GPIOE	= 1 << 4,
+	RCC_GPIOF	= 1 << 5,
+	RCC_GPIOG	= 1 << 6,
+	RCC_GPIOH	= 1 << 7,
+	RCC_GPIOI	= 1 << 8,
+	RCC_GPIOJ	= 1 << 9,
+	RCC_GPIOK	= 1 << 10,
+	RCC_DMA1	= 1 << 11,
+	RCC_DMA2	= 1 << 12,
+	RCC_DMA2D	= 1 << 13,
+	RCC_FSMC	= 1 << 14,
+	RCC_SPI1	= 1 << 15,
+	RCC_SPI2	= 1 << 16,
+	RCC_SPI3	= 1 << 17,
+	RCC_SPI4	= 1 << 18,
+	RCC_SPI5	= 1 << 19,
+	RCC_SPI6	= 1 << 20,
+	RCC_USART1	= 1 << 21,
+	RCC_LTDC	= 1 << 22,
+};
+
+/* The PLLs lock at once: RCC_CR reads back with every ready bit set. */
+struct host_rcc {
+	uint32_t	cr, pllcfgr, pllsaicfgr, dckcfgr, ahb3enr, apb2enr;
+};
+
+extern volatile struct host_rcc host_rcc;
+
+#define RCC_CR				host_rcc.cr
+#define RCC_PLLCFGR			host_rcc.pllcfgr
+#define RCC_PLLSAICFGR			host_rcc.pllsaicfgr
+#define RCC_DCKCFGR			host_rcc.dckcfgr
+#define RCC_AHB3ENR			host_rcc.ahb3enr
+#define RCC_APB2ENR			host_rcc.apb2enr
+
+#define RCC_CR_PLLSAION			(1 << 28)
+#define RCC_CR_PLLSAIRDY		(1 << 29)
+#define RCC_PLLSAICFGR_PLLSAIN_SHIFT	6
+#define RCC_PLLSAICFGR_PLLSAIN_MASK	0x1ff
+#define RCC_PLLSAICFGR_PLLSAIQ_SHIFT	24
+#define RCC_PLLSAICFGR_PLLSAIQ_MASK	0xf
+#define RCC_PLLSAICFGR_PLLSAIR_SHIFT	28
+#define RCC_PLLSAICFGR_PLLSAIR_MASK	0x7
+#define RCC_DCKCFGR_PLLSAIDIVR_SHIFT	16
+#define RCC_DCKCFGR_PLLSAIDIVR_MASK	0x3
+#define RCC_DCKCFGR_PLLSAIDIVR_DIVR_2	(0 << 16)
+#define RCC_DCKCFGR_PLLSAIDIVR_DIVR_4	(1 << 16)
+#define RCC_DCKCFGR_PLLSAIDIVR_DIVR_8	(2 << 16)
+#define RCC_DCKCFGR_PLLSAIDIVR_DIVR_16	(3 << 16)
+#define RCC_AHB3ENR_FMCEN		(1 << 0)
+#define RCC_APB2ENR_LTDCEN		(1 << 26)
+
+/* What clock_setup() sets up on the board. */
+extern uint32_t rcc_ahb_frequency;
+extern uint32_t rcc_apb1_frequency;
+extern uint32_t rcc_apb2_frequency;
+
+void rcc_periph_clock_enable(uint32_t clken);
+void rcc_peripheral_enable_clock(volatile uint32_t *reg, uint32_t en);
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_LIBOPENCM3_STM32_SPI_H
+#define HOST_LIBOPENCM3_STM32_SPI_H
+
+#include <stdint.h>
+
+/* SPIs are just numbers here. */
+#define SPI1		1
+#define SPI2		2
+#define SPI3		3
+#define SPI4		4
+#define SPI5		5
+#define SPI6		6
+#define SPI_PORTS	7
+
+/*
+ * The registers, in memory.  Writing SPI_DR sends nothing, only
+ * spi_send(), spi_xfer() and DMA do; SR always says the transmitter
+ * is empty and idle, as everything is sent at once.
+ */
+struct host_spi {
+	uint32_t	cr1, cr2, sr, dr;
+};
+
+extern volatile struct host_spi host_spi[SPI_PORTS];
+
+#define SPI_CR1(spi)	host_spi[spi].cr1
+#define SPI_CR2(spi)	host_spi[spi].cr2
+#define SPI_SR(spi)	host_spi[spi].sr
+#define SPI_DR(spi)	host_spi[spi].dr
+
+#define SPI_CR1_CPHA_CLK_TRANSITION_1	(0 << 0)
+#define SPI_CR1_CPHA_CLK_TRANSITION_2	(1 << 0)
+#define SPI_CR1_CPOL_CLK_TO_0_WHEN_IDLE	(0 << 1)
+#define SPI_CR1_CPOL_CLK_TO_1_WHEN_IDLE	(1 << 1)
+#define SPI_CR1_MSTR			(1 << 2)
+#define SPI_CR1_BAUDRATE_FPCLK_DIV_2	(0 << 3)
+#define SPI_CR1_BAUDRATE_FPCLK_DIV_4	(1 << 3)
+#define SPI_CR1_BAUDRATE_FPCLK_DIV_8	(2 << 3)
+#define SPI_CR1_BAUDRATE_FPCLK_DIV_16	(3 << 3)
+#define SPI_CR1_BAUDRATE_FPCLK_DIV_32	(4 << 3)
+#define SPI_CR1_BAUDRATE_FPCLK_DIV_64	(5 << 3)
+#define SPI_CR1_BAUDRATE_FPCLK_DIV_128	(6 << 3)
+#define SPI_CR1_BAUDRATE_FPCLK_DIV_256	(7 << 3)
+#define SPI_CR1_BR_SHIFT		3
+#define SPI_CR1_BR_MASK			0x7
+#define SPI_CR1_SPE			(1 << 6)
+#define SPI_CR1_MSBFIRST		(0 << 7)
+#define SPI_CR1_LSBFIRST		(1 << 7)
+#define SPI_CR1_SSI			(1 << 8)
+#define SPI_CR1_SSM			(1 << 9)
+#define SPI_CR1_DFF_8BIT		(0 << 11)
+#define SPI_CR1_DFF_16BIT		(1 << 11)
+#define SPI_CR1_DFF			(1 << 11)
+#define SPI_CR1_BIDIOE			(1 << 14)
+#define SPI_CR1_BIDIMODE		(1 << 15)
+
+#define SPI_CR2_RXDMAEN			(1 << 0)
+#define SPI_CR2_TXDMAEN			(1 << 1)
+#define SPI_CR2_SSOE			(1 << 2)
+#define SPI_CR2_RXNEIE			(1 << 6)
+#define SPI_CR2_TXEIE			(1 << 7)
+
+#define SPI_SR_RXNE			(1 << 0)
+#define SPI_SR_TXE			(1 << 1)
+#define SPI_SR_MODF			(1 << 5)
+#define SPI_SR_BSY			(1 << 7)
+
+int spi_init_master(uint32_t spi, uint32_t br, uint32_t cpol, uint32_t cpha,
+		    uint32_t dff, uint32_t lsbfirst);
+void spi_enable(uint32_t spi);
+void spi_disable(uint32_t spi);
+void spi_enable_ss_output(uint32_t spi);
+void spi_enable_software_slave_management(uint32_t spi);
+void spi_set_nss_high(uint32_t spi);
+void spi_set_dff_8bit(uint32_t spi);
+void spi_set_dff_16bit(uint32_t spi);
+void spi_enable_tx_dma(uint32_t spi);
+void spi_disable_tx_dma(uint32_t spi);
+void spi_send(uint32_t spi, uint16_t data);
+uint16_t spi_xfer(uint32_t spi, uint16_t data);
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_LIBOPENCM3_STM32_USART_H
+#define HOST_LIBOPENCM3_STM32_USART_H
+
+#include <stdint.h>
+
+/*
+ * Only enough to build; the examples that print do it through
+ * console.c or stdio, and HOST=1 replaces those with host stdio.
+ */
+#define USART1		1
+#define USART2		2
+#define USART3		3
+#define USART6		6
+#define USART_PORTS	7
+
+struct host_usart {
+	uint32_t	sr, dr;
+};
+
+extern volatile struct host_usart host_usart[USART_PORTS];
+
+#define USART_SR(usart)		host_usart[usart].sr
+#define USART_DR(usart)		host_usart[usart].dr
+
+#define USART_SR_RXNE		(1 << 5)
+#define USART_SR_TC		(1 << 6)
+#define USART_SR_TXE		(1 << 7)
+
+#define USART_STOPBITS_1	0
+#define USART_MODE_RX		(1 << 2)
+#define USART_MODE_TX		(1 << 3)
+#define USART_MODE_TX_RX	(USART_MODE_RX | USART_MODE_TX)
+#define USART_PARITY_NONE	0
+#define USART_FLOWCONTROL_NONE	0
+
+void usart_set_baudrate(uint32_t usart, uint32_t baud);
+void usart_set_databits(uint32_t usart, uint32_t bits);
+void usart_set_stopbits(uint32_t usart, uint32_t stopbits);
+void usart_set_mode(uint32_t usart, uint32_t mode);
+void usart_set_parity(uint32_t usart, uint32_t parity);
+void usart_set_flow_control(uint32_t usart, uint32_t flowcontrol);
+void usart_enable(uint32_t usart);
+
+#endif
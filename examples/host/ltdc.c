@@ -0,0 +1,219 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The LCD-TFT controller.  A thread stands in for the scan: once a
+ * frame, at the rate the timing registers and the PLLSAI give (60 Hz
+ * until they are set up), it blends the enabled layers over the
+ * background colour into an image of the active area, hands it to
+ * host_ppm(), and raises the line interrupt if it is on.  The line in
+ * LIPCR isn't looked at: the interrupt comes at the end of the frame,
+ * which is where the examples put it.
+ */
+
+#define _DEFAULT_SOURCE
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/ltdc.h>
+#include <libopencm3/cm3/nvic.h>
+#include "host.h"
+
+volatile struct host_ltdc host_ltdc;
+
+static uint32_t clut[2][256];
+static volatile uint32_t clutwr[2];
+
+__attribute__((weak))
+void lcd_tft_isr(void)
+{
+}
+
+/*
+ * The last value written goes into the table now; filing it twice
+ * does no harm, so there is no need to know whether it was.
+ */
+static void clut_file(int l)
+{
+	uint32_t v = clutwr[l];
+
+	clut[l][v >> 24] = v & 0xffffff;
+}
+
+volatile uint32_t *host_ltdc_clutwr(int layer)
+{
+	clut_file(layer - 1);
+	return &clutwr[layer - 1];
+}
+
+/* Frame period in ns, from the pixel clock and the total size. */
+static long frame_ns(void)
+{
+	uint32_t n = RCC_PLLSAICFGR >> RCC_PLLSAICFGR_PLLSAIN_SHIFT &
+		     RCC_PLLSAICFGR_PLLSAIN_MASK;
+	uint32_t r = RCC_PLLSAICFGR >> RCC_PLLSAICFGR_PLLSAIR_SHIFT &
+		     RCC_PLLSAICFGR_PLLSAIR_MASK;
+	uint32_t div = 2 << (RCC_DCKCFGR >> RCC_DCKCFGR_PLLSAIDIVR_SHIFT &
+			     RCC_DCKCFGR_PLLSAIDIVR_MASK);
+	uint64_t w = (LTDC_TWCR >> LTDC_TWCR_TOTALW_SHIFT & 0xfff) + 1;
+	uint64_t h = (LTDC_TWCR >> LTDC_TWCR_TOTALH_SHIFT & 0x7ff) + 1;
+	uint64_t hz;
+
+	/* The VCO runs off 1 MHz, HSE / PLLM on the board. */
+	if (!n || !r || !(LTDC_GCR & LTDC_GCR_LTDC_ENABLE)) {
+		return 1000000000 / 60;
+	}
+	hz = 1000000ULL * n / r / div;
+	return w * h * 1000000000 / hz;
+}
+
+/* Pixel x of the line at p, in the layer's format, as ARGB8888. */
+static uint32_t layer_pixel(int l, const uint8_t *line, int x)
+{
+	int format = host_ltdc.layer[l].pfcr & 7;
+	const uint8_t *p;
+
+	switch (format) {
+	case LTDC_LxPFCR_L8:
+		return 0xff000000 | clut[l][line[x]];
+	case LTDC_LxPFCR_AL44:
+		return (line[x] >> 4) * 0x11000000U | clut[l][line[x] & 0xf];
+	case LTDC_LxPFCR_AL88:
+		p = line + 2 * x;
+		return (uint32_t)p[1] << 24 | clut[l][p[0]];
+	default:
+		return host_pixel_get(line + x * host_pixel_size(format),
+				      format);
+	}
+}
+
+/* Blend layer l onto the line 'out' of the active area, line y. */
+static void layer_line(int l, uint32_t *out, int w, int y)
+{
+	volatile struct host_ltdc_layer *ly = &host_ltdc.layer[l];
+	int ahbp = LTDC_BPCR >> LTDC_BPCR_AHBP_SHIFT & 0xfff;
+	int avbp = LTDC_BPCR >> LTDC_BPCR_AVBP_SHIFT & 0x7ff;
+	int x0 = (ly->whpcr >> LTDC_LxWHPCR_WHSTPOS_SHIFT & 0xfff) - ahbp - 1;
+	int x1 = (ly->whpcr >> LTDC_LxWHPCR_WHSPPOS_SHIFT & 0xfff) - ahbp - 1;
+	int y0 = (ly->wvpcr >> LTDC_LxWVPCR_WVSTPOS_SHIFT & 0x7ff) - avbp - 1;
+	int y1 = (ly->wvpcr >> LTDC_LxWVPCR_WVSPPOS_SHIFT & 0x7ff) - avbp - 1;
+	uint32_t pitch = ly->cfblr >> LTDC_LxCFBLR_CFBP_SHIFT & 0x1fff;
+	int lines = ly->cfblnr & 0x7ff;
+	const uint8_t *line = HOST_PTR(ly->cfbar + (y - y0) * pitch);
+	uint32_t cacr = ly->cacr & 0xff;
+	int pixel_alpha = (ly->bfcr >> 8 & 7) == 6;
+	int x;
+
+	for (x = 0; x < w; x++) {
+		uint32_t argb = ly->dccr, a, c, i;
+
+		if (x >= x0 && x <= x1 && y >= y0 && y <= y1 &&
+		    y - y0 < lines) {
+			argb = layer_pixel(l, line, x - x0);
+			if (ly->cr & LTDC_LxCR_COLKEY_ENABLE &&
+			    (argb & 0xffffff) == (ly->ckcr & 0xffffff)) {
+				argb &= 0xffffff;
+			}
+		}
+		a = pixel_alpha ? (argb >> 24) * cacr / 255 : cacr;
+		c = 0;
+		for (i = 0; i < 24; i += 8) {
+			c |= ((argb >> i & 0xff) * a +
+			      (out[x] >> i & 0xff) * (255 - a)) / 255 << i;
+		}
+		out[x] = c;
+	}
+}
+
+static void scan(void)
+{
+	static uint32_t *rgb;
+	static size_t size;
+	int ahbp = LTDC_BPCR >> LTDC_BPCR_AHBP_SHIFT & 0xfff;
+	int avbp = LTDC_BPCR >> LTDC_BPCR_AVBP_SHIFT & 0x7ff;
+	int w = (LTDC_AWCR >> LTDC_AWCR_AAW_SHIFT & 0xfff) - ahbp;
+	int h = (LTDC_AWCR >> LTDC_AWCR_AAH_SHIFT & 0x7ff) - avbp;
+	int x, y, l;
+
+	if (w <= 0 || h <= 0) {
+		return;
+	}
+	if (size < (size_t)w * h) {
+		size = (size_t)w * h;
+		rgb = realloc(rgb, size * sizeof(*rgb));
+	}
+	for (l = 0; l < 2; l++) {
+		clut_file(l);
+	}
+	for (y = 0; y < h; y++) {
+		uint32_t *out = rgb + y * w;
+
+		for (x = 0; x < w; x++) {
+			out[x] = LTDC_BCCR & 0xffffff;
+		}
+		for (l = 0; l < 2; l++) {
+			if (host_ltdc.layer[l].cr & LTDC_LxCR_LAYER_ENABLE) {
+				layer_line(l, out, w, y);
+			}
+		}
+	}
+	host_ppm(rgb, w, h);
+	host_stats.ltdc_frames++;
+}
+
+static void *ltdc_thread(void *arg)
+{
+	struct timespec next;
+	uint32_t raised;
+
+	(void)arg;
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	for (;;) {
+		next.tv_nsec += frame_ns();
+		while (next.tv_nsec >= 1000000000) {
+			next.tv_nsec -= 1000000000;
+			next.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+		if (!(LTDC_GCR & LTDC_GCR_LTDC_ENABLE)) {
+			continue;
+		}
+		scan();
+		raised = LTDC_ISR_LIF;
+		if (LTDC_SRCR & (LTDC_SRCR_IMR | LTDC_SRCR_VBR)) {
+			LTDC_SRCR = 0;
+			raised |= LTDC_ISR_RRIF;
+		}
+		LTDC_ISR |= raised;
+		if (LTDC_IER & raised) {
+			host_irq(NVIC_LCD_TFT_IRQ, lcd_tft_isr);
+		}
+		host_frame();
+	}
+	return NULL;
+}
+
+__attribute__((constructor))
+static void ltdc_init(void)
+{
+	pthread_t t;
+
+	pthread_create(&t, NULL, ltdc_thread, NULL);
+	pthread_detach(t);
+}
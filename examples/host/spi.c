@@ -0,0 +1,139 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * SPI: every byte sent is counted, and handed to the panel model.
+ * The bit clock for the statistics comes from CR1 as it is when the
+ * byte goes out.
+ */
+
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/spi.h>
+#include <libopencm3/cm3/nvic.h>
+#include "host.h"
+
+/* The receive interrupt of lcd-dma, weak for the examples without it. */
+__attribute__((weak))
+void spi5_isr(void)
+{
+}
+
+volatile struct host_spi host_spi[SPI_PORTS] = {
+	[SPI1] = { .sr = SPI_SR_TXE },
+	[SPI2] = { .sr = SPI_SR_TXE },
+	[SPI3] = { .sr = SPI_SR_TXE },
+	[SPI4] = { .sr = SPI_SR_TXE },
+	[SPI5] = { .sr = SPI_SR_TXE },
+	[SPI6] = { .sr = SPI_SR_TXE },
+};
+
+/* Send one frame of 8 or 16 bits, as CR1 says. */
+static void spi_out(uint32_t spi, uint16_t data, int dma)
+{
+	uint32_t cr1 = host_spi[spi].cr1;
+	uint32_t pclk = (spi == SPI2 || spi == SPI3) ? rcc_apb1_frequency :
+						       rcc_apb2_frequency;
+	int n = cr1 & SPI_CR1_DFF ? 2 : 1;
+
+	host_stats.spi[spi].hz =
+		pclk / (2 << (cr1 >> SPI_CR1_BR_SHIFT & SPI_CR1_BR_MASK));
+	host_stats.spi[spi].bytes += n;
+	if (dma) {
+		host_stats.spi[spi].dma_bytes += n;
+	}
+	if (n == 2) {
+		host_panel_byte(spi, data >> 8);
+	}
+	host_panel_byte(spi, data);
+
+	/* Whatever came back is in DR at once. */
+	if (spi == SPI5 && host_spi[spi].cr2 & SPI_CR2_RXNEIE) {
+		host_irq(NVIC_SPI5_IRQ, spi5_isr);
+	}
+}
+
+/* For the DMA model: a frame from memory, if the SPI asked for DMA. */
+void host_spi_dma(uint32_t spi, uint16_t data)
+{
+	if (host_spi[spi].cr2 & SPI_CR2_TXDMAEN) {
+		spi_out(spi, data, 1);
+	}
+}
+
+int spi_init_master(uint32_t spi, uint32_t br, uint32_t cpol, uint32_t cpha,
+		    uint32_t dff, uint32_t lsbfirst)
+{
+	host_spi[spi].cr1 = SPI_CR1_MSTR | br | cpol | cpha | dff | lsbfirst;
+	host_spi[spi].cr2 |= SPI_CR2_SSOE;
+	return 0;
+}
+
+void spi_enable(uint32_t spi)
+{
+	host_spi[spi].cr1 |= SPI_CR1_SPE;
+}
+
+void spi_disable(uint32_t spi)
+{
+	host_spi[spi].cr1 &= ~SPI_CR1_SPE;
+}
+
+void spi_enable_ss_output(uint32_t spi)
+{
+	host_spi[spi].cr2 |= SPI_CR2_SSOE;
+}
+
+void spi_enable_software_slave_management(uint32_t spi)
+{
+	host_spi[spi].cr1 |= SPI_CR1_SSM;
+}
+
+void spi_set_nss_high(uint32_t spi)
+{
+	host_spi[spi].cr1 |= SPI_CR1_SSI;
+}
+
+void spi_set_dff_8bit(uint32_t spi)
+{
+	host_spi[spi].cr1 &= ~SPI_CR1_DFF;
+}
+
+void spi_set_dff_16bit(uint32_t spi)
+{
+	host_spi[spi].cr1 |= SPI_CR1_DFF;
+}
+
+void spi_enable_tx_dma(uint32_t spi)
+{
+	host_spi[spi].cr2 |= SPI_CR2_TXDMAEN;
+}
+
+void spi_disable_tx_dma(uint32_t spi)
+{
+	host_spi[spi].cr2 &= ~SPI_CR2_TXDMAEN;
+}
+
+void spi_send(uint32_t spi, uint16_t data)
+{
+	spi_out(spi, data, 0);
+}
+
+uint16_t spi_xfer(uint32_t spi, uint16_t data)
+{
+	spi_out(spi, data, 0);
+	return 0;
+}
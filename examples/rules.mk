@@ -19,6 +19,11 @@
 ## along with this library.  If not, see <http://www.gnu.org/licenses/>.
 ##
 
+# 'make HOST=1' builds for the build machine instead, see host/README.md.
+ifeq ($(HOST),1)
+include $(dir $(lastword $(MAKEFILE_LIST)))host/host.mk
+else
+
 # Be silent per default, but 'make V=1' will show all compiler calls.
 ifneq ($(V),1)
 Q		:= @
@@ -268,3 +273,5 @@ endif
 .PHONY: images clean stylecheck styleclean elf bin hex srec list
 
 -include $(OBJS:.o=.d)
+
+endif
@@ -17,12 +17,40 @@
  * along with this library.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/dma.h>
 #include "./dogm128.h"
 
+/* SPI2 TX is DMA1 channel 5. */
+#define DOGM128_DMA		DMA1
+#define DOGM128_DMA_CHANNEL	DMA_CHANNEL5
+
+/*
+ * A clean gap shorter than this between two dirty column runs of a page
+ * is sent along with them, starting a new run costs three commands.
+ */
+#define DOGM128_SPAN_GAP	3
+
 uint8_t dogm128_ram[1024];
 uint8_t dogm128_cursor_x;
 uint8_t dogm128_cursor_y;
 
+/*
+ * One bit per column of each page, set when that byte of dogm128_ram
+ * has changed since it was last sent.
+ */
+static uint32_t dogm128_dirty[8][4];
+
+#ifdef DOGM128_DIFF
+/*
+ * What the display was last sent, dogm128_update_display() compares
+ * dogm128_ram against it as well, so code that writes dogm128_ram
+ * directly doesn't have to call dogm128_mark_dirty().
+ */
+static uint8_t dogm128_shown[1024];
+#endif
+
 void dogm128_send_command(uint8_t command)
 {
 	uint32_t i;
@@ -82,6 +110,32 @@ void dogm128_init(void)
 
 	/* End transfer. */
 	spi_set_nss_high(DOGM128_SPI);
+
+	/* The display RAM is whatever it powered up with. */
+	dogm128_mark_dirty(0, 7, 0, 127);
+
+	/* DMA for the column spans, byte wide into the SPI data register. */
+	rcc_periph_clock_enable(RCC_DMA1);
+	dma_channel_reset(DOGM128_DMA, DOGM128_DMA_CHANNEL);
+	dma_set_priority(DOGM128_DMA, DOGM128_DMA_CHANNEL, DMA_CCR_PL_HIGH);
+	dma_set_memory_size(DOGM128_DMA, DOGM128_DMA_CHANNEL,
+			    DMA_CCR_MSIZE_8BIT);
+	dma_set_peripheral_size(DOGM128_DMA, DOGM128_DMA_CHANNEL,
+				DMA_CCR_PSIZE_8BIT);
+	dma_enable_memory_increment_mode(DOGM128_DMA, DOGM128_DMA_CHANNEL);
+	dma_set_read_from_memory(DOGM128_DMA, DOGM128_DMA_CHANNEL);
+	dma_set_peripheral_address(DOGM128_DMA, DOGM128_DMA_CHANNEL,
+				   (uint32_t)&SPI_DR(DOGM128_SPI));
+}
+
+/* Mark columns x0 - x1 of pages page0 - page1 as changed. */
+void dogm128_mark_dirty(uint8_t page0, uint8_t page1, uint8_t x0, uint8_t x1)
+{
+	uint8_t page, x;
+
+	for (page = page0; page <= page1; page++)
+		for (x = x0; x <= x1; x++)
+			dogm128_dirty[page][x >> 5] |= 1UL << (x & 31);
 }
 
 void dogm128_print_char(uint8_t data)
@@ -101,6 +155,8 @@ void dogm128_print_char(uint8_t data)
 		if ((xcoord + i) > 127)
 			return;
 		dogm128_cursor_x++;
+		dogm128_mark_dirty((page > 0) ? page - 1 : 0, page,
+				   xcoord + i, xcoord + i);
 
 		/* 0xAA = end of character - no dots in this line. */
 		if (dogm128_font[data - 0x20][i] == 0xAA) {
@@ -146,28 +202,88 @@ void dogm128_set_dot(uint8_t xcoord, uint8_t ycoord)
 {
 	dogm128_ram[(((63 - ycoord) / 8) * 128) + xcoord] |=
 		(1 << ((63 - ycoord) % 8));
+	dogm128_dirty[(63 - ycoord) / 8][xcoord >> 5] |= 1UL << (xcoord & 31);
 }
 
 void dogm128_clear_dot(uint8_t xcoord, uint8_t ycoord)
 {
 	dogm128_ram[(((63 - ycoord) / 8) * 128) + xcoord] &=
 		~(1 << ((63 - ycoord) % 8));
+	dogm128_dirty[(63 - ycoord) / 8][xcoord >> 5] |= 1UL << (xcoord & 31);
 }
 
+/* Send columns x0 - x1 of a page, the data bytes by DMA. */
+static void dogm128_send_span(uint8_t page, uint8_t x0, uint8_t x1)
+{
+	const uint8_t *p = &dogm128_ram[(page * 128) + x0];
+	uint16_t n = x1 - x0 + 1;
+
+	dogm128_send_command(DOGM128_PAGE_BASE + page); /* Set page. */
+	dogm128_send_command(0x10 | (x0 >> 4)); /* Column upper address. */
+	dogm128_send_command(x0 & 0x0F); /* Column lower address. */
+
+	gpio_set(DOGM128_A0_PORT, DOGM128_A0_PIN); /* A0 high for data */
+	dma_set_memory_address(DOGM128_DMA, DOGM128_DMA_CHANNEL, (uint32_t)p);
+	dma_set_number_of_data(DOGM128_DMA, DOGM128_DMA_CHANNEL, n);
+	dma_enable_channel(DOGM128_DMA, DOGM128_DMA_CHANNEL);
+	spi_enable_tx_dma(DOGM128_SPI);
+
+	/* A0 may only change once the last byte is out of the shifter. */
+	while (!dma_get_interrupt_flag(DOGM128_DMA, DOGM128_DMA_CHANNEL,
+				       DMA_TCIF))
+		;
+	while (!(SPI_SR(DOGM128_SPI) & SPI_SR_TXE))
+		;
+	while (SPI_SR(DOGM128_SPI) & SPI_SR_BSY)
+		;
+	dma_clear_interrupt_flags(DOGM128_DMA, DOGM128_DMA_CHANNEL, DMA_TCIF);
+	dma_disable_channel(DOGM128_DMA, DOGM128_DMA_CHANNEL);
+	spi_disable_tx_dma(DOGM128_SPI);
+
+#ifdef DOGM128_DIFF
+	memcpy(&dogm128_shown[(page * 128) + x0], p, n);
+#endif
+}
+
+/*
+ * Send what changed since the last update. Each page is walked for runs
+ * of dirty columns and only those runs go out, so a changed digit costs
+ * a few bytes rather than all 1024.
+ */
 void dogm128_update_display(void)
 {
-	uint8_t page, column;
+	uint8_t page;
+	int x, start, end = 0;
 
 	/* Tell the display that we want to start. */
 	spi_set_nss_low(DOGM128_SPI);
 
 	for (page = 0; page <= 7; page++) {
-		dogm128_send_command(0xB0 + page); /* Set page. */
-		dogm128_send_command(0x10); /* Set column upper address to 0. */
-		dogm128_send_command(0x00); /* Set column lower address to 0. */
-
-		for (column = 0; column <= 127; column++)
-			dogm128_send_data(dogm128_ram[(page * 128) + column]);
+#ifdef DOGM128_DIFF
+		for (x = 0; x <= 127; x++)
+			if (dogm128_ram[(page * 128) + x] !=
+			    dogm128_shown[(page * 128) + x])
+				dogm128_dirty[page][x >> 5] |= 1UL << (x & 31);
+#endif
+		start = -1;
+		for (x = 0; x <= 127; x++) {
+			if (!dogm128_dirty[page][x >> 5]) {
+				x |= 31; /* Nothing in this word. */
+				continue;
+			}
+			if (!(dogm128_dirty[page][x >> 5] & (1UL << (x & 31))))
+				continue;
+			if ((start >= 0) && (x - end > DOGM128_SPAN_GAP)) {
+				dogm128_send_span(page, start, end);
+				start = -1;
+			}
+			if (start < 0)
+				start = x;
+			end = x;
+		}
+		if (start >= 0)
+			dogm128_send_span(page, start, end);
+		memset(dogm128_dirty[page], 0, sizeof(dogm128_dirty[page]));
 	}
 
 	spi_set_nss_high(DOGM128_SPI);
@@ -175,10 +291,8 @@ void dogm128_update_display(void)
 
 void dogm128_clear(void)
 {
-	int i;
-
-	for (i = 0; i <= 1023; i++)
-		dogm128_ram[i] = 0;
+	memset(dogm128_ram, 0, sizeof(dogm128_ram));
+	dogm128_mark_dirty(0, 7, 0, 127);
 
 	dogm128_update_display();
 }
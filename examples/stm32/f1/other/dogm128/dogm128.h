@@ -82,6 +82,8 @@ void dogm128_set_dot(uint8_t xcoord, uint8_t ycoord);
 void dogm128_clear_dot(uint8_t xcoord, uint8_t ycoord);
 void dogm128_send_data(uint8_t data);
 void dogm128_init(void);
+void dogm128_mark_dirty(uint8_t page0, uint8_t page1, uint8_t x0,
+			uint8_t x1);
 void dogm128_update_display(void);
 void dogm128_clear(void);
 
@@ -0,0 +1,174 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The DOGM128 behind the common driver in lcd_driver.h.
+ *
+ * The panel is 1 bit a pixel, in 8 pages of 8 rows, and can't take a window
+ * of rgb565 pixels. So pixels are drawn into dogm128_ram, any colour but
+ * black is a dot, and flush_region() sends the columns of each page the
+ * region covers, along with anything else changed since the last update.
+ * Coordinates are top left origin, unlike dogm128_set_dot().
+ */
+
+#include "./dogm128.h"
+#include "./lcd_driver.h"
+#include "./lcd_dogm128.h"
+
+#define DOGM128_WIDTH	128
+#define DOGM128_HEIGHT	64
+
+static void dogm128_bus_data(const uint8_t *data, uint32_t n)
+{
+	while (n--)
+		dogm128_send_data(*data++);
+}
+
+const struct lcd_transport dogm128_bus = {
+	.command = dogm128_send_command,
+	.data = dogm128_bus_data,
+	.pixels = NULL,
+	.fill = NULL,
+	.wait = NULL,
+};
+
+/* Rotated coordinates to native, the same quarter turns as the colour panels. */
+static void dogm128_native(const struct lcd *lcd, uint16_t x, uint16_t y,
+			   uint16_t *nx, uint16_t *ny)
+{
+	switch (lcd->rotation) {
+	default:
+		*nx = x;
+		*ny = y;
+		break;
+	case 1:
+		*nx = y;
+		*ny = DOGM128_HEIGHT - 1 - x;
+		break;
+	case 2:
+		*nx = DOGM128_WIDTH - 1 - x;
+		*ny = DOGM128_HEIGHT - 1 - y;
+		break;
+	case 3:
+		*nx = DOGM128_WIDTH - 1 - y;
+		*ny = x;
+		break;
+	}
+}
+
+static void dogm128_put(struct lcd *lcd, uint16_t color)
+{
+	uint16_t nx, ny;
+	uint8_t *p;
+
+	dogm128_native(lcd, lcd->wx + lcd->cx, lcd->wy + lcd->cy, &nx, &ny);
+	p = &dogm128_ram[(ny / 8) * DOGM128_WIDTH + nx];
+	if (color)
+		*p |= 1 << (ny % 8);
+	else
+		*p &= ~(1 << (ny % 8));
+	dogm128_mark_dirty(ny / 8, ny / 8, nx, nx);
+
+	if (++lcd->cx == lcd->ww) {
+		lcd->cx = 0;
+		if (++lcd->cy == lcd->wh)
+			lcd->cy = 0;
+	}
+}
+
+static void dogm128_drv_init(struct lcd *lcd)
+{
+	(void)lcd;
+
+	dogm128_init();
+	dogm128_clear();
+}
+
+static void dogm128_set_window(struct lcd *lcd, uint16_t x, uint16_t y,
+			       uint16_t w, uint16_t h)
+{
+	lcd->wx = x;
+	lcd->wy = y;
+	lcd->ww = w;
+	lcd->wh = h;
+	lcd->cx = 0;
+	lcd->cy = 0;
+}
+
+static void dogm128_push_pixels(struct lcd *lcd, const uint16_t *pixels,
+				uint32_t n)
+{
+	while (n--)
+		dogm128_put(lcd, *pixels++);
+}
+
+static void dogm128_fill(struct lcd *lcd, uint16_t color, uint32_t n)
+{
+	while (n--)
+		dogm128_put(lcd, color);
+}
+
+static void dogm128_flush_region(struct lcd *lcd, const uint16_t *fb,
+				 uint16_t stride, uint16_t x, uint16_t y,
+				 uint16_t w, uint16_t h)
+{
+	uint16_t x0, y0, x1, y1, t;
+
+	if (fb) {
+		dogm128_set_window(lcd, x, y, w, h);
+		for (t = 0; t < h; t++)
+			dogm128_push_pixels(lcd,
+					    fb + (uint32_t)(y + t) * stride + x,
+					    w);
+	}
+
+	/* Native bounding box, then the columns of each page it covers. */
+	dogm128_native(lcd, x, y, &x0, &y0);
+	dogm128_native(lcd, x + w - 1, y + h - 1, &x1, &y1);
+	if (x0 > x1) {
+		t = x0; x0 = x1; x1 = t;
+	}
+	if (y0 > y1) {
+		t = y0; y0 = y1; y1 = t;
+	}
+	dogm128_mark_dirty(y0 / 8, y1 / 8, x0, x1);
+	dogm128_update_display();
+}
+
+static void dogm128_set_rotation(struct lcd *lcd, uint8_t r)
+{
+	lcd->rotation = r % 4;
+	if (lcd->rotation & 1) {
+		lcd->width = DOGM128_HEIGHT;
+		lcd->height = DOGM128_WIDTH;
+	} else {
+		lcd->width = DOGM128_WIDTH;
+		lcd->height = DOGM128_HEIGHT;
+	}
+}
+
+const struct lcd_driver lcd_dogm128 = {
+	.name = "dogm128",
+	.width = DOGM128_WIDTH,
+	.height = DOGM128_HEIGHT,
+	.init = dogm128_drv_init,
+	.set_window = dogm128_set_window,
+	.push_pixels = dogm128_push_pixels,
+	.fill = dogm128_fill,
+	.flush_region = dogm128_flush_region,
+	.set_rotation = dogm128_set_rotation,
+};
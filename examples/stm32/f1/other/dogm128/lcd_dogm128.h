@@ -0,0 +1,32 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LCD_DOGM128_H
+#define LCD_DOGM128_H
+
+#include "./lcd_driver.h"
+
+/*
+ * Pixels are drawn into dogm128_ram, and only reach the panel with
+ * flush_region(). Pass a NULL frame buffer to just send the region.
+ */
+extern const struct lcd_driver lcd_dogm128;
+
+/* Commands and data over SPI2, with dogm128_send_command/_data(). */
+extern const struct lcd_transport dogm128_bus;
+
+#endif
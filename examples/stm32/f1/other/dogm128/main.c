@@ -25,6 +25,9 @@
 #include <libopencm3/cm3/nvic.h>
 #include <libopencm3/stm32/spi.h>
 #include "./dogm128.h"
+#include "./lcd_dogm128.h"
+
+static struct lcd lcd;
 
 static void gpio_setup(void)
 {
@@ -86,8 +89,8 @@ int main(void)
 	gpio_clear(GPIOB, GPIO7);	/* LED1 on */
 	gpio_set(GPIOB, GPIO6);		/* LED2 off */
 
-	dogm128_init();
-	dogm128_clear();
+	/* Init and clear, through the common driver. */
+	lcd_init(&lcd, &lcd_dogm128, &dogm128_bus, NULL);
 
 	dogm128_set_cursor(0, 56);
 	dogm128_print_string("ABCDEFGHIJKLMNOPQRSTUVWXYZ");
@@ -106,6 +109,11 @@ int main(void)
 
 	dogm128_update_display();
 
+	/* A box in the bottom right corner, only the columns it changed are sent. */
+	lcd_fill_rect(&lcd, 100, 40, 20, 16, 0xFFFF);
+	lcd_fill_rect(&lcd, 102, 42, 16, 12, 0x0000);
+	lcd.driver->flush_region(&lcd, NULL, 0, 100, 40, 20, 16);
+
 	gpio_set(GPIOB, GPIO7); /* LED1 off */
 	while (1); /* Halt. */
 
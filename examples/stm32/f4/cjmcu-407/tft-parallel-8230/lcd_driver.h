@@ -0,0 +1,130 @@
+#ifndef LCD_DRIVER_H
+#define LCD_DRIVER_H
+
+/*
+  common panel driver, so the ili9341, ili9486, uc8230/st7781 and dogm128
+  examples don't each have their own command and data plumbing.
+
+  two tables of function pointers,
+    transport - how bytes get to the panel. spi polled, spi dma, fsmc, gpio, or null.
+    driver    - what the panel wants. init, address window, rotation.
+
+  a driver only talks to the transport, so anything done to a transport (16 bit
+  frames, dma bursts) works for every panel that can sit on it.
+
+  this file and lcd_driver.c are the same in every example that uses them.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+struct lcd_transport
+{
+  // RS low, one command / register index byte
+  void (*command)(uint8_t cmd);
+
+  // RS high, parameter bytes
+  void (*data)(const uint8_t *data, uint32_t n);
+
+  // RS high, rgb565 pixels, high byte first on the wire.
+  // may be NULL for panels that aren't 16 bit colour (dogm128)
+  void (*pixels)(const uint16_t *pixels, uint32_t n);
+
+  // RS high, the same pixel n times. may be NULL, as above
+  void (*fill)(uint16_t color, uint32_t n);
+
+  // block until anything queued (dma) has gone out. NULL if the transport never queues
+  void (*wait)(void);
+};
+
+
+struct lcd;
+
+struct lcd_driver
+{
+  const char *name;
+  uint16_t width;       // native, rotation 0
+  uint16_t height;
+
+  void (*init)(struct lcd *lcd);
+
+  // address window, in rotated coordinates, and start a memory write.
+  // push_pixels() and fill() then go left to right, top to bottom.
+  void (*set_window)(struct lcd *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+  void (*push_pixels)(struct lcd *lcd, const uint16_t *pixels, uint32_t n);
+  void (*fill)(struct lcd *lcd, uint16_t color, uint32_t n);
+
+  // part of a frame buffer, 'stride' pixels a row, to the same place on the panel.
+  // drivers that keep their own buffer (dogm128) take a NULL fb to just send the region
+  void (*flush_region)(struct lcd *lcd, const uint16_t *fb, uint16_t stride,
+                       uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+  // 0-3, quarter turns. sets lcd->width and lcd->height
+  void (*set_rotation)(struct lcd *lcd, uint8_t r);
+};
+
+
+struct lcd
+{
+  const struct lcd_driver *driver;
+  const struct lcd_transport *bus;
+
+  uint16_t width;       // after rotation
+  uint16_t height;
+  uint8_t rotation;
+
+  // ms delay for init scripts and resets, msleep() on the f4 boards. may be NULL
+  void (*delay)(uint32_t ms);
+
+  // last window, and where the next pixel goes in it. only drivers that
+  // draw into their own buffer (dogm128) need these
+  uint16_t wx, wy, ww, wh;
+  uint16_t cx, cy;
+};
+
+
+// attach driver and transport, and run the driver init. reset is up to the board.
+void lcd_init(struct lcd *lcd, const struct lcd_driver *driver, const struct lcd_transport *bus,
+              void (*delay)(uint32_t ms));
+
+// transports can be swapped at any time, eg. to compare them. waits for the old one first.
+void lcd_set_transport(struct lcd *lcd, const struct lcd_transport *bus);
+
+void lcd_command(struct lcd *lcd, uint8_t cmd, const uint8_t *data, uint32_t n);
+void lcd_wait(struct lcd *lcd);
+
+/*
+  init script, the adafruit format.
+    command, count, count parameter bytes, ... 0
+  if the top bit of count is set, wait 150ms after the command (lcd->delay).
+*/
+void lcd_run_script(struct lcd *lcd, const uint8_t *script);
+
+void lcd_fill_rect(struct lcd *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+void lcd_write_rect(struct lcd *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels);
+
+// for drivers whose window is a plain memory write, so pixels go straight to the transport
+void lcd_bus_push_pixels(struct lcd *lcd, const uint16_t *pixels, uint32_t n);
+void lcd_bus_fill(struct lcd *lcd, uint16_t color, uint32_t n);
+void lcd_bus_flush_region(struct lcd *lcd, const uint16_t *fb, uint16_t stride,
+                          uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+
+/*
+  null transport. sends nothing, just counts. so a driver or the gfx code on top
+  can be timed without the bus, and the bytes and commands it would have sent
+  compared between drivers.
+*/
+struct lcd_null_stats
+{
+  uint32_t commands;    // also transactions. every window, every register, starts with one
+  uint32_t bytes;       // parameter and pixel bytes, not counting commands
+  uint32_t pixels;
+};
+
+extern struct lcd_null_stats lcd_null_stats;
+extern const struct lcd_transport lcd_null;
+
+#endif
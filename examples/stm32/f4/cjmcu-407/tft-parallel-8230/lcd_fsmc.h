@@ -0,0 +1,47 @@
+#ifndef LCD_FSMC_H
+#define LCD_FSMC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lcd_driver.h"
+
+// panel on fsmc bank 1, chip select NE1, and RS (D/CX) wired to A16. so a write
+// to the bank base goes out as a command (RS low), and a write 64k above it as
+// data (RS high). the fsmc does the WR strobe and timing in hardware.
+#define LCD_FSMC_BASE   0x60000000
+#define LCD_FSMC_RS     (1 << 16)
+
+#define LCD_CMD         (*(volatile uint8_t *)  (LCD_FSMC_BASE))
+#define LCD_DATA        (*(volatile uint8_t *)  (LCD_FSMC_BASE | LCD_FSMC_RS))
+
+// 8 bit bus. a 16 bit write gets split into two byte writes, low byte first.
+// the panel wants the high byte first, so 16 bit values go through lcd_swap16()
+#define LCD_CMD16       (*(volatile uint16_t *) (LCD_FSMC_BASE))
+#define LCD_DATA16      (*(volatile uint16_t *) (LCD_FSMC_BASE | LCD_FSMC_RS))
+
+// write timing in hclk (~6ns at 168MHz). a write takes ADDSET + DATAST + 1 hclk,
+// the uc8230 (ili9320 class) wants a 100ns cycle with WR low and high for 50ns
+// each, so 8 + 9 + 1 = 18 hclk = 107ns, DATAST is the WR low time.
+#define LCD_WR_ADDSET   8
+#define LCD_WR_DATAST   9
+
+#define lcd_swap16(x)   ((uint16_t)(((x) >> 8) | ((x) << 8)))
+
+void lcd_fsmc_setup(void);
+
+// pixels pushed with dma, memory to memory from 'pixels' into the data address.
+// the pixels must already be byte swapped, and be in flash or sram (dma can't see ccm).
+// both return as soon as the transfer is started.
+void lcd_fsmc_write(const uint16_t *pixels, uint32_t n);
+void lcd_fsmc_fill(uint16_t color, uint32_t n);
+
+bool lcd_fsmc_busy(void);
+void lcd_fsmc_wait(void);
+
+// transport for lcd_driver.h. pixels are swapped by the cpu and sent by dma,
+// see fsmc_pixels(), fills go by dma. after lcd_fsmc_setup()
+extern const struct lcd_transport lcd_fsmc;
+
+#endif
+
@@ -0,0 +1,38 @@
+#ifndef LCD_GPIO_H
+#define LCD_GPIO_H
+
+#include <stdint.h>
+
+#include "lcd_driver.h"
+
+// GPIOE, control lines. RST is a plain gpio with the fsmc as well
+#define LCD_PORT  GPIOE
+
+#define LCD_RST   GPIO2   // reset
+#define LCD_CS    GPIO3   // chip select
+#define LCD_RS    GPIO4   // register select
+#define LCD_WR    GPIO5   // write strobe
+#define LCD_RD    GPIO6   // read
+
+// D0-D7 on GPIOD 0-7
+#define LCD_DATA_PORT  GPIOD
+
+// 8080 write timing the panel needs, ns. uc8230 is ili9320 class, ili9320 datasheet
+#define LCD_TWC_NS    100   // write cycle
+#define LCD_TWRL_NS   50    // WR low
+#define LCD_TWRH_NS   50    // WR high
+
+// sets up the pins, leaves CS high, and works out how much padding the strobe needs
+void lcd_gpio_setup(void);
+
+void lcd_gpio_command(uint8_t command);
+void lcd_gpio_data(uint8_t data);
+
+// RS high and a burst of pixels, high byte first
+void send_pixels(const uint16_t *pixels, uint32_t n);
+void lcd_gpio_fill(uint16_t color, uint32_t n);
+
+// transport for lcd_driver.h, after lcd_gpio_setup(). CS is left to the caller
+extern const struct lcd_transport lcd_gpio;
+
+#endif
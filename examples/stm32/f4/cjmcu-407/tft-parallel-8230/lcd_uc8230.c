@@ -0,0 +1,198 @@
+/*
+  uc8230, 240x320. ili9320 class, so the st7781, ili9325 and spfd5408 have the
+  same registers, at least the ones used here.
+
+  unlike the ili9341 every register index and value is 16 bit, high byte first.
+  on the 8 bit bus an index goes out as two command bytes, and a value as one
+  pixel, which the transports already send high byte first.
+
+  register list and init from,
+    https://github.com/prenticedavid/MCUFRIEND_kbv/blob/master/MCUFRIEND_kbv.cpp
+    https://github.com/MichalKs/STM32F4_ILI9320/blob/master/STM32F4_ILI9320/app/src/ili9320.c
+*/
+
+#include "lcd_driver.h"
+#include "lcd_uc8230.h"
+
+
+#define UC8230_WIDTH    240
+#define UC8230_HEIGHT   320
+
+#define UC8230_ENTRY    0x03    // entry mode. BGR, ID1 ID0 (direction), AM (vertical first)
+#define UC8230_GRAM_X   0x20    // address counter
+#define UC8230_GRAM_Y   0x21
+#define UC8230_GRAM     0x22    // write data to gram
+#define UC8230_HSA      0x50    // window
+#define UC8230_HEA      0x51
+#define UC8230_VSA      0x52
+#define UC8230_VEA      0x53
+
+#define TFTLCD_DELAY 0xFFFF
+
+static const uint16_t ILI9320_regValues[] = {
+  0x00e5, 0x8000,
+  0x0000, 0x0001,
+  0x0001, 0x100,
+  0x0002, 0x0700,
+  0x0003, 0x1030,
+  0x0004, 0x0000,
+  0x0008, 0x0202,
+  0x0009, 0x0000,
+  0x000A, 0x0000,
+  0x000C, 0x0000,
+  0x000D, 0x0000,
+  0x000F, 0x0000,
+  //-----Power On sequence-----------------------
+  0x0010, 0x0000,
+  0x0011, 0x0007,
+  0x0012, 0x0000,
+  0x0013, 0x0000,
+  TFTLCD_DELAY, 50,
+  0x0010, 0x17B0,  //SAP=1, BT=7, APE=1, AP=3
+  0x0011, 0x0007,  //DC1=0, DC0=0, VC=7
+  TFTLCD_DELAY, 10,
+  0x0012, 0x013A,  //VCMR=1, PON=3, VRH=10
+  TFTLCD_DELAY, 10,
+  0x0013, 0x1A00,  //VDV=26
+  0x0029, 0x000c,  //VCM=12
+  TFTLCD_DELAY, 10,
+  //-----Gamma control-----------------------
+  0x0030, 0x0000,
+  0x0031, 0x0505,
+  0x0032, 0x0004,
+  0x0035, 0x0006,
+  0x0036, 0x0707,
+  0x0037, 0x0105,
+  0x0038, 0x0002,
+  0x0039, 0x0707,
+  0x003C, 0x0704,
+  0x003D, 0x0807,
+  //-----Set RAM area-----------------------
+  0x0060, 0xA700,     //GS=1
+  0x0061, 0x0001,
+  0x006A, 0x0000,
+  0x0021, 0x0000,
+  0x0020, 0x0000,
+  //-----Partial Display Control------------
+  0x0080, 0x0000,
+  0x0081, 0x0000,
+  0x0082, 0x0000,
+  0x0083, 0x0000,
+  0x0084, 0x0000,
+  0x0085, 0x0000,
+  //-----Panel Control----------------------
+  0x0090, 0x0010,
+  0x0092, 0x0000,
+  0x0093, 0x0003,
+  0x0095, 0x0110,
+  0x0097, 0x0000,
+  0x0098, 0x0000,
+  //-----Display on-----------------------
+  0x0007, 0x0173,
+  TFTLCD_DELAY, 50,
+};
+
+
+/*
+  there is no MADCTL. rotation is the direction the address counter moves in
+  (entry mode), and the window and start address mapped back to the native,
+  portrait, gram coordinates.
+*/
+static const uint16_t entry_mode[4] = {
+  0x1030,   // x+ then y+
+  0x1018,   // AM, y- then x+
+  0x1000,   // x- then y-
+  0x1028,   // AM, y+ then x-
+};
+
+
+
+static void uc8230_reg(struct lcd *lcd, uint16_t reg, uint16_t value)
+{
+  lcd->bus->command(reg >> 8);
+  lcd->bus->command(reg & 0xFF);
+  lcd->bus->pixels(&value, 1);
+}
+
+
+static void uc8230_init(struct lcd *lcd)
+{
+  for( unsigned i = 0; i < sizeof( ILI9320_regValues) / sizeof(uint16_t)  ; i += 2 )  {
+
+    uint16_t cmd = ILI9320_regValues[ i ];
+    uint16_t data = ILI9320_regValues[ i + 1];
+
+    if(cmd == TFTLCD_DELAY) {
+      if(lcd->delay)
+        lcd->delay(data);
+    }
+    else {
+      uc8230_reg(lcd, cmd, data);
+    }
+  }
+}
+
+
+static void uc8230_set_window(struct lcd *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  const uint16_t W = UC8230_WIDTH, H = UC8230_HEIGHT;
+  uint16_t x0, x1, y0, y1, cx, cy;
+
+  // native window, and where the first pixel (top left, rotated) is in it
+  switch(lcd->rotation) {
+    default:
+      x0 = x;           x1 = x + w - 1;   y0 = y;           y1 = y + h - 1;
+      cx = x;           cy = y;
+      break;
+    case 1:
+      x0 = y;           x1 = y + h - 1;   y0 = H - x - w;   y1 = H - 1 - x;
+      cx = y;           cy = H - 1 - x;
+      break;
+    case 2:
+      x0 = W - x - w;   x1 = W - 1 - x;   y0 = H - y - h;   y1 = H - 1 - y;
+      cx = W - 1 - x;   cy = H - 1 - y;
+      break;
+    case 3:
+      x0 = W - y - h;   x1 = W - 1 - y;   y0 = x;           y1 = x + w - 1;
+      cx = W - 1 - y;   cy = x;
+      break;
+  }
+
+  uc8230_reg(lcd, UC8230_HSA, x0);
+  uc8230_reg(lcd, UC8230_HEA, x1);
+  uc8230_reg(lcd, UC8230_VSA, y0);
+  uc8230_reg(lcd, UC8230_VEA, y1);
+  uc8230_reg(lcd, UC8230_GRAM_X, cx);
+  uc8230_reg(lcd, UC8230_GRAM_Y, cy);
+
+  lcd->bus->command(0);
+  lcd->bus->command(UC8230_GRAM);
+}
+
+
+static void uc8230_set_rotation(struct lcd *lcd, uint8_t r)
+{
+  lcd->rotation = r % 4;
+  if(lcd->rotation & 1) {
+    lcd->width = UC8230_HEIGHT;
+    lcd->height = UC8230_WIDTH;
+  } else {
+    lcd->width = UC8230_WIDTH;
+    lcd->height = UC8230_HEIGHT;
+  }
+  uc8230_reg(lcd, UC8230_ENTRY, entry_mode[lcd->rotation]);
+}
+
+
+const struct lcd_driver lcd_uc8230 = {
+  .name         = "uc8230",
+  .width        = UC8230_WIDTH,
+  .height       = UC8230_HEIGHT,
+  .init         = uc8230_init,
+  .set_window   = uc8230_set_window,
+  .push_pixels  = lcd_bus_push_pixels,
+  .fill         = lcd_bus_fill,
+  .flush_region = lcd_bus_flush_region,
+  .set_rotation = uc8230_set_rotation,
+};
+
@@ -0,0 +1,10 @@
+#ifndef LCD_UC8230_H
+#define LCD_UC8230_H
+
+#include "lcd_driver.h"
+
+// uc8230, and the ili9320 class panels with the same registers (st7781, ili9325).
+// needs a transport with pixels and fill. reset is up to the board
+extern const struct lcd_driver lcd_uc8230;
+
+#endif
@@ -74,19 +74,11 @@ item
 #include <libopencm3/stm32/gpio.h>
 
 #include "clock.h"
-
-// GPIOE
-#define LCD_PORT  GPIOE
-
-#define LCD_RST   GPIO2   // reset
-#define LCD_CS    GPIO3   // chip select
-#define LCD_RS    GPIO4   // register select
-#define LCD_WR    GPIO5   // write strobe
-#define LCD_RD    GPIO6   // read
-
-
-#define LCD_DATA_PORT  GPIOD
-
+#include "lcd_gpio.h"   // pins
+#include "lcd_uc8230.h"
+#if LCD_FSMC
+#include "lcd_fsmc.h"
+#endif
 
 #define LCD_WIDTH 30
 #define LCD_HEIGHT 30
@@ -105,182 +97,33 @@ static void led_setup(void)
 
 
 // OK. really not sure if we have to pad everything to 16 bit.
-// sendCommand16 is a specialization for 16 bit parallel path.
-// eg. should only require 16 bits, if its unavoidable because the bus is genuinely 16 bit.
-
-static inline void delay( uint16_t x )
-{
-  msleep(x);
-}
-
+// yes. registers and values are all 16 bit, even on the 8 bit bus. see lcd_uc8230.c
 
+#if LCD_FSMC
+// the fsmc does RS, CS and the WR strobe, see lcd_fsmc.c
+#define LCD_BUS   lcd_fsmc
+#else
+// bit-banged, see lcd_gpio.c
+#define LCD_BUS   lcd_gpio
+#endif
 
-static void send8( uint8_t x )
-{
-  gpio_port_write(LCD_DATA_PORT, x);    // setup port
-  gpio_clear(LCD_PORT, LCD_WR);         // clear write strobe. falling edge. host asserts.
-  delay(1);
-  gpio_set(LCD_PORT, LCD_WR);           // write on rising edge. tft reads.
-  delay(1);
+// uc8230 driver on top, registers and init in lcd_uc8230.c
+static struct lcd lcd;
 
-  // gpio_clear(LCD_PORT, LCD_WR);         // clear write strobe
-}
 
 
-static void send16( uint16_t x )
+// test pattern in the top left corner
+static void lcd_pattern(void)
 {
-  send8(x >> 8);   // Check
-  send8(x & 0xFF);
-
-}
-
-
-static void sendCommand16(uint16_t cmd, uint16_t data)
-{
-  gpio_clear(LCD_PORT, LCD_RS);   // low - to assert register, D/CX  p24
-  send16(cmd);
-  gpio_set(LCD_PORT, LCD_RS);     // high - to assert data
-  send16(data);
-}
-
-
-
-
-// https://github.com/prenticedavid/MCUFRIEND_kbv/blob/master/MCUFRIEND_kbv.cpp
-
-#define TFTLCD_DELAY 0xFFFF
-
-static const uint16_t ILI9320_regValues[] = {
-  0x00e5, 0x8000,
-  0x0000, 0x0001,
-  0x0001, 0x100,
-  0x0002, 0x0700,
-  0x0003, 0x1030,
-  0x0004, 0x0000,
-  0x0008, 0x0202,
-  0x0009, 0x0000,
-  0x000A, 0x0000,
-  0x000C, 0x0000,
-  0x000D, 0x0000,
-  0x000F, 0x0000,
-  //-----Power On sequence-----------------------
-  0x0010, 0x0000,
-  0x0011, 0x0007,
-  0x0012, 0x0000,
-  0x0013, 0x0000,
-  TFTLCD_DELAY, 50,
-  0x0010, 0x17B0,  //SAP=1, BT=7, APE=1, AP=3
-  0x0011, 0x0007,  //DC1=0, DC0=0, VC=7
-  TFTLCD_DELAY, 10,
-  0x0012, 0x013A,  //VCMR=1, PON=3, VRH=10
-  TFTLCD_DELAY, 10,
-  0x0013, 0x1A00,  //VDV=26
-  0x0029, 0x000c,  //VCM=12
-  TFTLCD_DELAY, 10,
-  //-----Gamma control-----------------------
-  0x0030, 0x0000,
-  0x0031, 0x0505,
-  0x0032, 0x0004,
-  0x0035, 0x0006,
-  0x0036, 0x0707,
-  0x0037, 0x0105,
-  0x0038, 0x0002,
-  0x0039, 0x0707,
-  0x003C, 0x0704,
-  0x003D, 0x0807,
-  //-----Set RAM area-----------------------
-  0x0060, 0xA700,     //GS=1
-  0x0061, 0x0001,
-  0x006A, 0x0000,
-  0x0021, 0x0000,
-  0x0020, 0x0000,
-  //-----Partial Display Control------------
-  0x0080, 0x0000,
-  0x0081, 0x0000,
-  0x0082, 0x0000,
-  0x0083, 0x0000,
-  0x0084, 0x0000,
-  0x0085, 0x0000,
-  //-----Panel Control----------------------
-  0x0090, 0x0010,
-  0x0092, 0x0000,
-  0x0093, 0x0003,
-  0x0095, 0x0110,
-  0x0097, 0x0000,
-  0x0098, 0x0000,
-  //-----Display on-----------------------
-  0x0007, 0x0173,
-  TFTLCD_DELAY, 50,
-};
-
-
-
-
-static void init( void ) {
-
-  for( unsigned i = 0; i < sizeof( ILI9320_regValues) / sizeof(uint16_t)  ; i += 2 )  {
-
-    uint16_t cmd = ILI9320_regValues[ i ];
-    uint16_t data = ILI9320_regValues[ i + 1];
-
-    if(cmd == TFTLCD_DELAY) {
-      // printf("delay %d\n", data );
-      msleep(data);
-    }
-    else {
-      // printf("cmd %x   data %x\n", cmd, data);
-      sendCommand16(cmd, data);
-    }
-  }
-}
+  uint16_t row[LCD_WIDTH];
+  uint16_t v = 999;
 
+  lcd.driver->set_window(&lcd, 0, 0, LCD_WIDTH, LCD_HEIGHT);
 
-
-
-
-
-static uint16_t min(uint16_t a, uint16_t b) {
-  return (a > b) ? b : a;
-}
-
-static uint16_t max(uint16_t a, uint16_t b) {
-  return (a > b) ? a : b;
-}
-
-static uint16_t sat(uint16_t val, uint16_t vmin, uint16_t vmax) {
-  return min(vmax, max(vmin, val));
-}
-
-static void lcd_set_cursor(uint16_t x, uint16_t y) {
-  sendCommand16(0x20, x);
-  sendCommand16(0x21, y);
-}
-
-
-static void lcd_set_window(uint16_t left, uint16_t top, uint16_t right, uint16_t bottom) {
-  sendCommand16(0x50, sat(left, 0, LCD_WIDTH-1));
-  sendCommand16(0x51, sat(right-1, 0, LCD_WIDTH-1));
-  sendCommand16(0x52, sat(top, 0, LCD_HEIGHT-1));
-  sendCommand16(0x53, sat(bottom-1, 0, LCD_HEIGHT-1));
-}
-
-static void lcd_fill(uint32_t color) {
-  // uint16_t data = lcd_pixel_from_rgb32(color);
-  // uint16_t data = 0xf7f7;
-  uint16_t data = 0x2200;
-
-  lcd_set_window(0, 0, 320 , 200);
-  lcd_set_cursor(0, 0);
-
-
-  gpio_clear(LCD_PORT, LCD_RS);   // low - to assert register, D/CX  p24
-  send16(0x22);
-
-  gpio_set(LCD_PORT, LCD_RS);   // high data
-
-  for(uint32_t i = 0; i < LCD_WIDTH*LCD_HEIGHT; i++) {
-      // _lcd_tx_data(data);
-      send16(i + 999 );
+  for(uint16_t y = 0; y < LCD_HEIGHT; y++) {
+    for(uint16_t x = 0; x < LCD_WIDTH; x++)
+      row[x] = v++;
+    lcd.driver->push_pixels(&lcd, row, LCD_WIDTH);
   }
 }
 
@@ -295,19 +138,19 @@ int main(void)
   rcc_periph_clock_enable( RCC_GPIOE );
   rcc_periph_clock_enable( RCC_GPIOD );
 
-
-  // gpio_mode_setup(LCD_DATA_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, 0xff ); // JA first 8 bits.
-  gpio_mode_setup(LCD_DATA_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, GPIO0 | GPIO1 | GPIO2 | GPIO3 | GPIO4 | GPIO5 | GPIO6 | GPIO7  ); // JA first 8 bits.
-  gpio_mode_setup(LCD_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, LCD_RST | LCD_CS | LCD_RS | LCD_WR | LCD_RD);
-
-
-  gpio_set(LCD_PORT, LCD_RD);   // turn read off. operates both the transceiver and the lcd which reads on rising edge.
-                                // when set to read - then if gpio is output - it will sink all the output voltage. very bad.
-                                // screen flashing resulted from drop in power supply, not initialisation.
+#if LCD_FSMC
+  // data, RD, WR, CS and RS all belong to the fsmc now. only reset is a gpio.
+  lcd_fsmc_setup();
+  gpio_mode_setup(LCD_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, LCD_RST);
+#else
+  // data and control pins, and the strobe timing. RD is held high (read off),
+  // screen flashing resulted from drop in power supply, not initialisation.
+  lcd_gpio_setup();
 
 
   // assert chip select, with low
   gpio_clear(LCD_PORT, LCD_CS);
+#endif
 
 
   // hardware reset - review
@@ -319,10 +162,10 @@ int main(void)
   msleep(150);
 
 
-  init();
+  lcd_init(&lcd, &lcd_uc8230, &LCD_BUS, msleep);
 
 
-  lcd_fill(0xf7f7 );
+  lcd_pattern();
 
  	while (1) {
     gpio_toggle(GPIOE, GPIO0);
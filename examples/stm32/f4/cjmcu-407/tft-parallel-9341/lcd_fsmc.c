@@ -0,0 +1,223 @@
+/*
+  8080 parallel bus on the fsmc, for the ili9341 / uc8230 8 bit shields.
+
+  The fsmc treats the panel as an 8 bit sram on bank 1. it drives CS (NE1),
+  WR (NWE), RD (NOE) and RS (A16) itself, so sending a byte is just a store,
+  and a stream of pixels can be moved by the dma with no cpu involved.
+
+  Pins, STM32F407VG (100 pin). these are fixed by the fsmc, so the shield
+  has to be wired this way rather than to GPIOD 0-7 for the bit-bang version.
+
+    D0  PD14    D4  PE7     RD  PD4   (NOE)
+    D1  PD15    D5  PE8     WR  PD5   (NWE)
+    D2  PD0     D6  PE9     CS  PD7   (NE1)
+    D3  PD1     D7  PE10    RS  PD11  (A16)
+
+  RST stays a gpio (PE2).
+
+  write timing depends on the panel so it is in lcd_fsmc.h. for the ili9341
+  it is 71ns a byte, 14MB/s, or a full 240x320 frame in about 11ms. reads are
+  much slower (450ns cycle for the ili9341 id registers) so they get their own
+  timing, extended mode.
+*/
+
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/gpio.h>
+#include <libopencm3/stm32/fsmc.h>
+#include <libopencm3/stm32/dma.h>
+#include <libopencm3/cm3/nvic.h>
+
+#include "lcd_fsmc.h"
+
+// timing fields in BTR/BWTR, in hclk
+#define FSMC_ADDSET(x)  ((x) << 0)
+#define FSMC_ADDHLD(x)  ((x) << 4)
+#define FSMC_DATAST(x)  ((x) << 8)
+
+#define LCD_RD_ADDSET   15
+#define LCD_RD_DATAST   60
+
+// mem to mem only works on dma2, any stream
+#define LCD_DMA         DMA2
+#define LCD_DMA_STREAM  DMA_STREAM0
+#define LCD_DMA_CHUNK   65535   // max items in one transfer
+#define LCD_DMA_MIN     64      // smaller than this, the cpu just writes them
+#define LCD_BOUNCE      1024    // pixels swapped at a time for the dma, see fsmc_pixels()
+
+static const uint16_t *dma_next;
+static uint32_t dma_remaining;
+static bool dma_inc;
+static volatile bool dma_busy;
+static uint16_t fill_color;
+
+static void lcd_fsmc_gpio_setup(void)
+{
+  uint16_t pd = GPIO0 | GPIO1 | GPIO4 | GPIO5 | GPIO7 | GPIO11 | GPIO14 | GPIO15;
+  uint16_t pe = GPIO7 | GPIO8 | GPIO9 | GPIO10;
+
+  rcc_periph_clock_enable(RCC_GPIOD);
+  rcc_periph_clock_enable(RCC_GPIOE);
+
+  gpio_mode_setup(GPIOD, GPIO_MODE_AF, GPIO_PUPD_NONE, pd);
+  gpio_set_output_options(GPIOD, GPIO_OTYPE_PP, GPIO_OSPEED_100MHZ, pd);
+  gpio_set_af(GPIOD, GPIO_AF12, pd);
+
+  gpio_mode_setup(GPIOE, GPIO_MODE_AF, GPIO_PUPD_NONE, pe);
+  gpio_set_output_options(GPIOE, GPIO_OTYPE_PP, GPIO_OSPEED_100MHZ, pe);
+  gpio_set_af(GPIOE, GPIO_AF12, pe);
+}
+
+static void lcd_fsmc_dma_setup(void)
+{
+  rcc_periph_clock_enable(RCC_DMA2);
+  dma_stream_reset(LCD_DMA, LCD_DMA_STREAM);
+  dma_set_priority(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_PL_HIGH);
+  // in mem to mem the 'peripheral' side is the source, 'memory' the destination
+  dma_set_transfer_mode(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_DIR_MEM_TO_MEM);
+  dma_set_peripheral_size(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_PSIZE_16BIT);
+  dma_set_memory_size(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_MSIZE_16BIT);
+  dma_disable_memory_increment_mode(LCD_DMA, LCD_DMA_STREAM);
+  dma_set_memory_address(LCD_DMA, LCD_DMA_STREAM, LCD_FSMC_BASE | LCD_FSMC_RS);
+  // mem to mem can't use direct mode
+  dma_enable_fifo_mode(LCD_DMA, LCD_DMA_STREAM);
+  dma_set_fifo_threshold(LCD_DMA, LCD_DMA_STREAM, DMA_SxFCR_FTH_4_4_FULL);
+  dma_enable_transfer_complete_interrupt(LCD_DMA, LCD_DMA_STREAM);
+  nvic_enable_irq(NVIC_DMA2_STREAM0_IRQ);
+}
+
+void lcd_fsmc_setup(void)
+{
+  lcd_fsmc_gpio_setup();
+  rcc_periph_clock_enable(RCC_FSMC);
+
+  // bank 1, sram, 8 bit, writes enabled, separate read and write timing
+  FSMC_BTR(0) = FSMC_ADDSET(LCD_RD_ADDSET) | FSMC_ADDHLD(1) | FSMC_DATAST(LCD_RD_DATAST);
+  FSMC_BWTR(0) = FSMC_ADDSET(LCD_WR_ADDSET) | FSMC_ADDHLD(1) | FSMC_DATAST(LCD_WR_DATAST);
+  FSMC_BCR(0) = FSMC_BCR_WREN | FSMC_BCR_EXTMOD | FSMC_BCR_MBKEN;
+
+  lcd_fsmc_dma_setup();
+}
+
+static void lcd_dma_next_chunk(void)
+{
+  uint32_t n = (dma_remaining > LCD_DMA_CHUNK) ? LCD_DMA_CHUNK : dma_remaining;
+
+  dma_set_peripheral_address(LCD_DMA, LCD_DMA_STREAM, (uint32_t) dma_next);
+  dma_set_number_of_data(LCD_DMA, LCD_DMA_STREAM, n);
+  if(dma_inc)
+    dma_next += n;
+  dma_remaining -= n;
+  dma_enable_stream(LCD_DMA, LCD_DMA_STREAM);
+}
+
+static void lcd_dma_start(const uint16_t *p, uint32_t n, bool inc)
+{
+  lcd_fsmc_wait();
+  if(inc)
+    dma_enable_peripheral_increment_mode(LCD_DMA, LCD_DMA_STREAM);
+  else
+    dma_disable_peripheral_increment_mode(LCD_DMA, LCD_DMA_STREAM);
+  dma_next = p;
+  dma_remaining = n;
+  dma_inc = inc;
+  dma_busy = true;
+  lcd_dma_next_chunk();
+}
+
+// chunk done, start the next or finish
+void dma2_stream0_isr(void)
+{
+  if(!dma_get_interrupt_flag(LCD_DMA, LCD_DMA_STREAM, DMA_TCIF))
+    return;
+  dma_clear_interrupt_flags(LCD_DMA, LCD_DMA_STREAM, DMA_TCIF);
+  if(dma_remaining) {
+    lcd_dma_next_chunk();
+    return;
+  }
+  dma_busy = false;
+}
+
+bool lcd_fsmc_busy(void)
+{
+  return dma_busy;
+}
+
+// anything sent to the panel by the cpu has to wait for the dma to finish first
+void lcd_fsmc_wait(void)
+{
+  while(dma_busy);
+}
+
+void lcd_fsmc_write(const uint16_t *pixels, uint32_t n)
+{
+  if(n < LCD_DMA_MIN) {
+    lcd_fsmc_wait();
+    while(n--)
+      LCD_DATA16 = *pixels++;
+    return;
+  }
+  lcd_dma_start(pixels, n, true);
+}
+
+void lcd_fsmc_fill(uint16_t color, uint32_t n)
+{
+  lcd_fsmc_wait();
+  fill_color = lcd_swap16(color);
+  if(n < LCD_DMA_MIN) {
+    while(n--)
+      LCD_DATA16 = fill_color;
+    return;
+  }
+  lcd_dma_start(&fill_color, n, false);
+}
+
+
+
+static void fsmc_command(uint8_t cmd)
+{
+  lcd_fsmc_wait();
+  LCD_CMD = cmd;
+}
+
+static void fsmc_data(const uint8_t *data, uint32_t n)
+{
+  lcd_fsmc_wait();
+  while(n--)
+    LCD_DATA = *data++;
+}
+
+// the dma can't swap bytes, so the cpu swaps the pixels from the driver into
+// one of two bounce buffers while the dma sends the other. swapping is much
+// quicker than the bus, so the cpu mostly waits in lcd_fsmc_write() for the
+// buffer to come free, and gets the last one back as soon as it is started.
+static void fsmc_pixels(const uint16_t *pixels, uint32_t n)
+{
+  static uint16_t bounce[2][LCD_BOUNCE];
+  static unsigned b;    // the other one may still be going out
+
+  if(n < LCD_DMA_MIN) {
+    lcd_fsmc_wait();
+    while(n--) {
+      LCD_DATA16 = lcd_swap16(*pixels);
+      ++pixels;
+    }
+    return;
+  }
+  while(n) {
+    uint32_t k = n > LCD_BOUNCE ? LCD_BOUNCE : n;
+    for(uint32_t i = 0; i < k; ++i)
+      bounce[b][i] = lcd_swap16(pixels[i]);
+    lcd_fsmc_write(bounce[b], k);
+    pixels += k;
+    n -= k;
+    b ^= 1;
+  }
+}
+
+const struct lcd_transport lcd_fsmc = {
+  .command  = fsmc_command,
+  .data     = fsmc_data,
+  .pixels   = fsmc_pixels,
+  .fill     = lcd_fsmc_fill,
+  .wait     = lcd_fsmc_wait,
+};
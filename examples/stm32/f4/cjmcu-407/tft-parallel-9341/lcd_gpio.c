@@ -0,0 +1,152 @@
+/*
+  bit-banged 8080 bus, for when the panel isn't on the fsmc pins.
+
+  a byte used to cost two msleep(1)s. now the 8 data lines are written with one
+  store to the GPIOD BSRR (set bits in the low half, clear bits in the high half,
+  so PD8-15 are left alone), and WR is a BSRR store low then high. WR is on
+  another port so it can't go in the same store as the data.
+
+  the panel wants the WR low and high for at least LCD_TWRL_NS / LCD_TWRH_NS, and
+  a whole write to take LCD_TWC_NS. rather than guess how long the stores take,
+  lcd_gpio_setup() times an unpadded write and a step of the nop pad loop with the
+  dwt cycle counter, and works out from the ahb clock how many pad steps to put
+  after each edge.
+*/
+
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/gpio.h>
+#include <libopencm3/cm3/dwt.h>
+
+#include "lcd_gpio.h"
+
+#define LCD_DATA_PINS (GPIO0 | GPIO1 | GPIO2 | GPIO3 | GPIO4 | GPIO5 | GPIO6 | GPIO7)
+
+// BSRR value that puts 'x' on D0-D7
+#define bsrr_byte(x)  ((uint32_t)(uint8_t)(x) | ((uint32_t)(uint8_t)~(x) << 16))
+
+static uint32_t wr_low_pad;     // pad steps with WR low
+static uint32_t wr_high_pad;    // and after it goes high again
+
+static inline void pad(uint32_t n)
+{
+  while(n--)
+    __asm__ volatile ("nop");
+}
+
+static inline void strobe(uint32_t bsrr)
+{
+  GPIO_BSRR(LCD_DATA_PORT) = bsrr;          // data
+  GPIO_BSRR(LCD_PORT) = LCD_WR << 16;       // WR low. host asserts
+  pad(wr_low_pad);
+  GPIO_BSRR(LCD_PORT) = LCD_WR;             // WR high. tft reads on the rising edge
+  pad(wr_high_pad);
+}
+
+static uint32_t ns_to_cycles(uint32_t ns)
+{
+  return (ns * (rcc_ahb_frequency / 1000000) + 999) / 1000;
+}
+
+static void calibrate(void)
+{
+  uint32_t t, step, write, low, high, i;
+
+  dwt_enable_cycle_counter();
+
+  t = dwt_read_cycle_counter();
+  pad(64);
+  step = (dwt_read_cycle_counter() - t + 63) / 64;
+
+  // CS is high, so the panel ignores these
+  wr_low_pad = wr_high_pad = 0;
+  t = dwt_read_cycle_counter();
+  for(i = 0; i < 64; ++i)
+    strobe(bsrr_byte(i));
+  write = (dwt_read_cycle_counter() - t) / 64;
+
+  // the stores either side of the low phase are not counted, so this is on the safe side
+  low = ns_to_cycles(LCD_TWRL_NS);
+  wr_low_pad = (low + step - 1) / step;
+
+  // high has to be long enough by itself, and make up the rest of the cycle
+  high = ns_to_cycles(LCD_TWRH_NS);
+  if(ns_to_cycles(LCD_TWC_NS) > write + wr_low_pad * step + high)
+    high = ns_to_cycles(LCD_TWC_NS) - write - wr_low_pad * step;
+  wr_high_pad = (high + step - 1) / step;
+}
+
+void lcd_gpio_setup(void)
+{
+  rcc_periph_clock_enable(RCC_GPIOD);
+  rcc_periph_clock_enable(RCC_GPIOE);
+
+  gpio_mode_setup(LCD_DATA_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, LCD_DATA_PINS);
+  gpio_set_output_options(LCD_DATA_PORT, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, LCD_DATA_PINS);
+  gpio_mode_setup(LCD_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, LCD_RST | LCD_CS | LCD_RS | LCD_WR | LCD_RD);
+  gpio_set_output_options(LCD_PORT, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, LCD_CS | LCD_RS | LCD_WR);
+
+  // turn read off. operates both the transceiver and the lcd which reads on rising edge.
+  // when set to read - then if gpio is output - it will sink all the output voltage. very bad.
+  gpio_set(LCD_PORT, LCD_RD | LCD_CS | LCD_WR);
+
+  calibrate();
+}
+
+void lcd_gpio_command(uint8_t command)
+{
+  gpio_clear(LCD_PORT, LCD_RS);   // low - to assert register, D/CX  p24
+  strobe(bsrr_byte(command));
+}
+
+void lcd_gpio_data(uint8_t data)
+{
+  gpio_set(LCD_PORT, LCD_RS);     // high - to assert data
+  strobe(bsrr_byte(data));
+}
+
+void send_pixels(const uint16_t *pixels, uint32_t n)
+{
+  gpio_set(LCD_PORT, LCD_RS);
+  while(n >= 2) {
+    strobe(bsrr_byte(pixels[0] >> 8));
+    strobe(bsrr_byte(pixels[0]));
+    strobe(bsrr_byte(pixels[1] >> 8));
+    strobe(bsrr_byte(pixels[1]));
+    pixels += 2;
+    n -= 2;
+  }
+  if(n) {
+    strobe(bsrr_byte(pixels[0] >> 8));
+    strobe(bsrr_byte(pixels[0]));
+  }
+}
+
+void lcd_gpio_fill(uint16_t color, uint32_t n)
+{
+  uint32_t hi = bsrr_byte(color >> 8);
+  uint32_t lo = bsrr_byte(color);
+
+  gpio_set(LCD_PORT, LCD_RS);
+  while(n--) {
+    strobe(hi);
+    strobe(lo);
+  }
+}
+
+
+static void gpio_data(const uint8_t *data, uint32_t n)
+{
+  gpio_set(LCD_PORT, LCD_RS);
+  while(n--) {
+    strobe(bsrr_byte(*data));
+    ++data;
+  }
+}
+
+const struct lcd_transport lcd_gpio = {
+  .command  = lcd_gpio_command,
+  .data     = gpio_data,
+  .pixels   = send_pixels,
+  .fill     = lcd_gpio_fill,
+  .wait     = NULL,
+};
@@ -0,0 +1,107 @@
+/*
+  ili9341, 240x320. the same on spi and on the 8 bit parallel bus, only the
+  transport differs.
+
+  https://www.displayfuture.com/Display/datasheet/controller/ILI9341.pdf
+*/
+
+#include "Adafruit_ILI9341.h"
+#include "lcd_driver.h"
+#include "lcd_ili9341.h"
+
+
+// clang-format off
+static const uint8_t initcmd[] = {
+  0xEF, 3, 0x03, 0x80, 0x02,
+  0xCF, 3, 0x00, 0xC1, 0x30,
+  0xED, 4, 0x64, 0x03, 0x12, 0x81,
+  0xE8, 3, 0x85, 0x00, 0x78,
+  0xCB, 5, 0x39, 0x2C, 0x00, 0x34, 0x02,
+  0xF7, 1, 0x20,
+  0xEA, 2, 0x00, 0x00,
+  ILI9341_PWCTR1  , 1, 0x23,             // Power control VRH[5:0]
+  ILI9341_PWCTR2  , 1, 0x10,             // Power control SAP[2:0];BT[3:0]
+  ILI9341_VMCTR1  , 2, 0x3e, 0x28,       // VCM control
+  ILI9341_VMCTR2  , 1, 0x86,             // VCM control2
+  ILI9341_MADCTL  , 1, 0x48,             // Memory Access Control
+  ILI9341_VSCRSADD, 1, 0x00,             // Vertical scroll zero
+  ILI9341_PIXFMT  , 1, 0x55,
+  ILI9341_FRMCTR1 , 2, 0x00, 0x18,
+  ILI9341_DFUNCTR , 3, 0x08, 0x82, 0x27, // Display Function Control
+  0xF2, 1, 0x00,                         // 3Gamma Function Disable
+  ILI9341_GAMMASET , 1, 0x01,             // Gamma curve selected
+  ILI9341_GMCTRP1 , 15, 0x0F, 0x31, 0x2B, 0x0C, 0x0E, 0x08, // Set Gamma
+    0x4E, 0xF1, 0x37, 0x07, 0x10, 0x03, 0x0E, 0x09, 0x00,
+  ILI9341_GMCTRN1 , 15, 0x00, 0x0E, 0x14, 0x03, 0x11, 0x07, // Set Gamma
+    0x31, 0xC1, 0x48, 0x08, 0x0F, 0x0C, 0x31, 0x36, 0x0F,
+  ILI9341_SLPOUT  , 0x80,                // Exit Sleep
+  ILI9341_DISPON  , 0x80,                // Display on
+  0x00                                   // End of list
+};
+// clang-format on
+
+
+#define MADCTL_MY 0x80  ///< Bottom to top
+#define MADCTL_MX 0x40  ///< Right to left
+#define MADCTL_MV 0x20  ///< Reverse Mode
+#define MADCTL_BGR 0x08 ///< Blue-Green-Red pixel order
+
+// MADCTL for each rotation. 0 is what the init script leaves it at
+static const uint8_t madctl[4] = {
+  MADCTL_MX | MADCTL_BGR,
+  MADCTL_MV | MADCTL_BGR,
+  MADCTL_MY | MADCTL_BGR,
+  MADCTL_MX | MADCTL_MY | MADCTL_MV | MADCTL_BGR,
+};
+
+
+
+static void ili9341_init(struct lcd *lcd)
+{
+  lcd_run_script(lcd, initcmd);
+}
+
+
+static void ili9341_set_window(struct lcd *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  uint16_t x1 = x + w - 1;
+  uint16_t y1 = y + h - 1;
+
+  {
+    uint8_t data[] = { x >> 8, x & 0xFF, x1 >> 8, x1 & 0xFF };
+    lcd_command(lcd, ILI9341_CASET, data, sizeof(data) ); // 2A
+  }
+  {
+    uint8_t data[] = { y >> 8, y & 0xFF, y1 >> 8, y1 & 0xFF };
+    lcd_command(lcd, ILI9341_PASET, data, sizeof(data) ); // 2B
+  }
+  lcd_command(lcd, ILI9341_RAMWR, NULL, 0);
+}
+
+
+static void ili9341_set_rotation(struct lcd *lcd, uint8_t r)
+{
+  lcd->rotation = r % 4;
+  if(lcd->rotation & 1) {
+    lcd->width = ILI9341_TFTHEIGHT;
+    lcd->height = ILI9341_TFTWIDTH;
+  } else {
+    lcd->width = ILI9341_TFTWIDTH;
+    lcd->height = ILI9341_TFTHEIGHT;
+  }
+  lcd_command(lcd, ILI9341_MADCTL, &madctl[lcd->rotation], 1);
+}
+
+
+const struct lcd_driver lcd_ili9341 = {
+  .name         = "ili9341",
+  .width        = ILI9341_TFTWIDTH,
+  .height       = ILI9341_TFTHEIGHT,
+  .init         = ili9341_init,
+  .set_window   = ili9341_set_window,
+  .push_pixels  = lcd_bus_push_pixels,
+  .fill         = lcd_bus_fill,
+  .flush_region = lcd_bus_flush_region,
+  .set_rotation = ili9341_set_rotation,
+};
+
@@ -0,0 +1,9 @@
+#ifndef LCD_ILI9341_H
+#define LCD_ILI9341_H
+
+#include "lcd_driver.h"
+
+// needs a transport with pixels and fill. reset and backlight are up to the board
+extern const struct lcd_driver lcd_ili9341;
+
+#endif
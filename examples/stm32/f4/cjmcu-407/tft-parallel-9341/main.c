@@ -46,18 +46,11 @@
 
 #include "clock.h"
 #include "Adafruit_ILI9341.h"
-
-// GPIOE
-#define LCD_PORT  GPIOE
-
-#define LCD_RST   GPIO2   // reset
-#define LCD_CS    GPIO3   // chip select
-#define LCD_RS    GPIO4   // register select
-#define LCD_WR    GPIO5   // write strobe
-#define LCD_RD    GPIO6   // read
-
-
-#define LCD_DATA_PORT  GPIOD
+#include "lcd_gpio.h"   // pins
+#include "lcd_ili9341.h"
+#if LCD_FSMC
+#include "lcd_fsmc.h"
+#endif
 
 // LCD
 
@@ -76,23 +69,18 @@ static void led_setup(void)
 // sendCommand16 is a specialization for 16 bit parallel path.
 // eg. should only require 16 bits, if its unavoidable because the bus is genuinely 16 bit.
 
-static inline void delay( uint16_t x )
-{
-  msleep(x);
-}
-
 
 
-static void send8( uint8_t x )
-{
-  gpio_port_write(LCD_DATA_PORT, x);    // setup port
-  gpio_clear(LCD_PORT, LCD_WR);         // clear write strobe. falling edge. host asserts.
-  delay(1);
-  gpio_set(LCD_PORT, LCD_WR);           // write on rising edge. tft reads.
-  delay(1);
+#if LCD_FSMC
+// the fsmc does RS, CS and the WR strobe, see lcd_fsmc.c
+#define LCD_BUS   lcd_fsmc
+#else
+// bit-banged, see lcd_gpio.c
+#define LCD_BUS   lcd_gpio
+#endif
 
-  // gpio_clear(LCD_PORT, LCD_WR);         // clear write strobe
-}
+// ili9341 driver on top, see lcd_driver.h
+static struct lcd lcd;
 
 // OK. screen does same thing - whether we asset chip select or not.
 // So, think we want to check...
@@ -126,138 +114,10 @@ static void send8( uint8_t x )
   // note also that reading, involves a write from host first to select what to read.
 */
 
-static void sendCommand(uint8_t command, const uint8_t *dataBytes, uint8_t numDataBytes)
-{
-
-  gpio_clear(LCD_PORT, LCD_RS);   // low - to assert register, D/CX  p24
-  send8(command);
-
-  gpio_set(LCD_PORT, LCD_RS);     // high - to assert data
-  for(unsigned i = 0; i < numDataBytes; ++i) {
-    send8(dataBytes[ i ]);
-  }
-
-}
-
-
-static void sendCommand0(uint8_t command)
-{
-
-  gpio_clear(LCD_PORT, LCD_RS);   // low - to assert register, D/CX  p24
-  send8(command);
-}
-
-static void sendData0(uint8_t data)
-{
-  // advantage is that it can be done in a loop. without allocating stack for buffer.
-  gpio_set(LCD_PORT, LCD_RS);     // high - to assert data
-  send8(data);
-}
-
-
-
 
 
 // https://github.com/juj/fbcp-ili9341/blob/master/ili9341.cpp  <- explains more
-
-// static const uint8_t PROGMEM initcmd[] = {
-static uint8_t initcmd[] = {
-  0xEF, 3, 0x03, 0x80, 0x02,
-  0xCF, 3, 0x00, 0xC1, 0x30,
-  0xED, 4, 0x64, 0x03, 0x12, 0x81,
-  0xE8, 3, 0x85, 0x00, 0x78,
-  0xCB, 5, 0x39, 0x2C, 0x00, 0x34, 0x02,
-  0xF7, 1, 0x20,
-  0xEA, 2, 0x00, 0x00,
-  ILI9341_PWCTR1  , 1, 0x23,             // Power control VRH[5:0]
-  ILI9341_PWCTR2  , 1, 0x10,             // Power control SAP[2:0];BT[3:0]
-  ILI9341_VMCTR1  , 2, 0x3e, 0x28,       // VCM control
-  ILI9341_VMCTR2  , 1, 0x86,             // VCM control2
-  ILI9341_MADCTL  , 1, 0x48,             // Memory Access Control
-  ILI9341_VSCRSADD, 1, 0x00,             // Vertical scroll zero
-  ILI9341_PIXFMT  , 1, 0x55,
-  ILI9341_FRMCTR1 , 2, 0x00, 0x18,
-  ILI9341_DFUNCTR , 3, 0x08, 0x82, 0x27, // Display Function Control
-  0xF2, 1, 0x00,                         // 3Gamma Function Disable
-  ILI9341_GAMMASET , 1, 0x01,             // Gamma curve selected
-  ILI9341_GMCTRP1 , 15, 0x0F, 0x31, 0x2B, 0x0C, 0x0E, 0x08, // Set Gamma
-    0x4E, 0xF1, 0x37, 0x07, 0x10, 0x03, 0x0E, 0x09, 0x00,
-  ILI9341_GMCTRN1 , 15, 0x00, 0x0E, 0x14, 0x03, 0x11, 0x07, // Set Gamma
-    0x31, 0xC1, 0x48, 0x08, 0x0F, 0x0C, 0x31, 0x36, 0x0F,
-  ILI9341_SLPOUT  , 0x80,                // Exit Sleep
-  ILI9341_DISPON  , 0x80,                // Display on
-  0x00                                   // End of list
-};
-
-
-static uint8_t pgm_read_byte(const uint8_t *addr) { return *addr; }
-
-
-
-
-
-
-
-
-static void ILI9341_SetAddressWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
-#if 0
-    // column address set
-    ILI9341_WriteCommand(0x2A); // CASET
-    {
-        uint8_t data[] = { (x0 >> 8) & 0xFF, x0 & 0xFF, (x1 >> 8) & 0xFF, x1 & 0xFF };
-        ILI9341_WriteData(data, sizeof(data));
-    }
-
-    // row address set
-    ILI9341_WriteCommand(0x2B); // RASET
-    {
-        uint8_t data[] = { (y0 >> 8) & 0xFF, y0 & 0xFF, (y1 >> 8) & 0xFF, y1 & 0xFF };
-        ILI9341_WriteData(data, sizeof(data));
-    }
-
-    // write to RAM
-    ILI9341_WriteCommand(0x2C); // RAMWR
-#endif
-    {
-        uint8_t data[] = { (x0 >> 8) & 0xFF, x0 & 0xFF, (x1 >> 8) & 0xFF, x1 & 0xFF };
-        // ILI9341_WriteData(data, sizeof(data));
-        sendCommand(ILI9341_CASET, data, sizeof(data) ); // 2A
-    }
-
-    // ILI9341_WriteCommand(0x2B); // RASET
-    {
-        uint8_t data[] = { (y0 >> 8) & 0xFF, y0 & 0xFF, (y1 >> 8) & 0xFF, y1 & 0xFF };
-        sendCommand(ILI9341_PASET, data, sizeof(data) ); // 2B
-        // ILI9341_WriteData(data, sizeof(data));
-    }
-
-    //
-
-    // write to RAM
-    // ILI9341_WriteCommand(0x2C); // RAMWR
-    // sendCommand(ILI9341_RAMWR, 0 , 0 ); // 2C
-}
-
-
-
-static void ILI9341_DrawPixel(uint16_t x, uint16_t y, uint16_t color) {
-    // if((x >= ILI9341_WIDTH) || (y >= ILI9341_HEIGHT))
-    //  return;
-
-
-    ILI9341_SetAddressWindow(x, y, x+20, y+20);
-    // uint8_t data[] = { color >> 8, color & 0xFF };
-
-
-    // send command
-    sendCommand0(ILI9341_RAMWR ); // 2C
-
-    int i;
-    for( i = 0; i < 20 * 20; ++i) {
-      sendData0( color >> 8 );
-      sendData0( color & 0xFF );
-    }
-}
+// the init script is in lcd_ili9341.c
 
 
 // Good example, https://github.com/afiskon/stm32-ili9341/blob/master/Lib/ili9341/ili9341.c
@@ -398,19 +258,18 @@ int main(void)
   rcc_periph_clock_enable( RCC_GPIOE );
   rcc_periph_clock_enable( RCC_GPIOD );
 
-
-  // gpio_mode_setup(LCD_DATA_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, 0xff ); // JA first 8 bits.
-  gpio_mode_setup(LCD_DATA_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, GPIO0 | GPIO1 | GPIO2 | GPIO3 | GPIO4 | GPIO5 | GPIO6 | GPIO7  ); // JA first 8 bits.
-  gpio_mode_setup(LCD_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, LCD_RST | LCD_CS | LCD_RS | LCD_WR | LCD_RD);
-
-
-  gpio_set(LCD_PORT, LCD_RD);   // turn read off. operates both the transceiver and the lcd which reads on rising edge. 
-                                // when set to read - then if gpio is output - it will sink all the output voltage. very bad.
-                                // screen flashing resulted from drop in power supply
-
+#if LCD_FSMC
+  // data, RD, WR, CS and RS all belong to the fsmc now. only reset is a gpio.
+  lcd_fsmc_setup();
+  gpio_mode_setup(LCD_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, LCD_RST);
+#else
+  // data and control pins, and the strobe timing. RD is held high (read off),
+  // screen flashing resulted from drop in power supply when it wasn't
+  lcd_gpio_setup();
 
   // assert chip select, with low
   gpio_clear(LCD_PORT, LCD_CS);
+#endif
 
 
   // hardware reset - review
@@ -422,6 +281,9 @@ int main(void)
   msleep(150);
 
 
+  // init script, see lcd_ili9341.c
+  lcd_init(&lcd, &lcd_ili9341, &LCD_BUS, msleep);
+
 
   // not sure that the correct commands and data are being sent...
   // display off, or changing the brightness should have done something.
@@ -432,20 +294,22 @@ int main(void)
    // 0x6809:
 
     // OK this actually does something.
-    sendCommand0(0x68  );
-    sendData0(0x9 );
+    {
+    uint8_t data[] = { 0x9 };
+    lcd_command(&lcd, 0x68, data, sizeof(data) );
+    }
 
 #if 0
 #if 0
-  sendCommand0(0x01 ); // software reset
+  lcd_command(&lcd, 0x01, NULL, 0 ); // software reset
   msleep(5);
-  sendCommand0(0x28 ); // display off. would think would do something ....'t work
+  lcd_command(&lcd, 0x28, NULL, 0 ); // display off. would think would do something ....'t work
 
  
   { 
   // sendCommand0(0x28 ); // display off. would think would do something ....'t work
   uint8_t data[] = { 0x0 };
-  sendCommand(0x28, data, sizeof(data) ); // display off. would think would do something ....'t work
+  lcd_command(&lcd, 0x28, data, sizeof(data) ); // display off. would think would do something ....'t work
   msleep(500);
   }
 #endif
@@ -454,36 +318,22 @@ int main(void)
   // OK. this should have dimmed stuff...
   {
     uint8_t data[] = { 0x0/*VCOMH=4.250V*/, 0x0/*VCOML=-1.500V*/ };
-    sendCommand(0xC5/*VCOM Control 1*/, data, sizeof(data) );
+    lcd_command(&lcd, 0xC5/*VCOM Control 1*/, data, sizeof(data) );
   }
   {
     uint8_t data[] = { 0x0 /*VCOMH=VMH-58,VCOML=VML-58*/ };
-    sendCommand(0xC7/*VCOM Control 2*/, data, sizeof(data) );
+    lcd_command(&lcd, 0xC7/*VCOM Control 2*/, data, sizeof(data) );
     msleep(1000);
   }
 #endif
 
-  // ok running this - changes the screen brightness down a bit. or something
-  //
-  uint8_t cmd, x, numArgs;
-  const uint8_t *addr = initcmd;
-  while ((cmd = pgm_read_byte(addr++)) > 0) {
-    x = pgm_read_byte(addr++);
-    numArgs = x & 0x7F;
-    sendCommand(cmd, addr, numArgs);
-    addr += numArgs;
-    // Ok, hi bit determines if needs a delay... horrible
-    if (x & 0x80)
-      delay(150);
-  }
-
 /*
   // normal orientation
   uint8_t m = (MADCTL_MX | MADCTL_BGR);
-  sendCommand(ILI9341_MADCTL, &m, 1);
+  lcd_command(&lcd, ILI9341_MADCTL, &m, 1);
 */
 
-  ILI9341_DrawPixel(50, 50, 0xf777 );
+  lcd_fill_rect(&lcd, 50, 50, 20, 20, 0xf777 );
 
   // OK. its very slow... running... because there are a lot of pixel data to send
 
@@ -501,15 +351,15 @@ int main(void)
     if(on) {
       // led on draws more power... how...
       gpio_set(GPIOE, GPIO0);
-      sendCommand0( ILI9341_SLPIN);
-      // sendCommand0(ILI9341_INVOFF );
-      // ILI9341_DrawPixel(50, 50, 0xf777 );
+      lcd_command(&lcd, ILI9341_SLPIN, NULL, 0);
+      // lcd_command(&lcd, ILI9341_INVOFF, NULL, 0);
+      // lcd_fill_rect(&lcd, 50, 50, 20, 20, 0xf777 );
     }
     else {
       gpio_clear(GPIOE, GPIO0);
-      sendCommand0( ILI9341_SLPOUT);
-      // sendCommand0(ILI9341_INVON);
-      // ILI9341_DrawPixel(50, 50, 0x7700 );
+      lcd_command(&lcd, ILI9341_SLPOUT, NULL, 0);
+      // lcd_command(&lcd, ILI9341_INVON, NULL, 0);
+      // lcd_fill_rect(&lcd, 50, 50, 20, 20, 0x7700 );
     }
     on = ! on;
 
@@ -2,6 +2,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "lcd_driver.h"
+
 
 #if 0
 
@@ -21,7 +23,8 @@ Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h) {
 
 typedef struct Context
 {
-    // could almost include opaque spi structure here, if needed
+    // the panel, driver and transport. see lcd_driver.h
+    struct lcd *lcd;
 
     uint8_t rotation  ;
     uint16_t width;
@@ -65,7 +68,9 @@ void endWrite(Context *ctx);
 
 void delay( uint16_t x ); 
 
-void initialize(Context *ctx);
+void initialize(Context *ctx, struct lcd *lcd, const struct lcd_transport *bus);
+
+// names kept from when these talked to the ili9341 directly. they now go through ctx->lcd
 
 void ILI9341_setRotation(Context *ctx, uint8_t m) ;
 
@@ -73,5 +78,9 @@ void ILI9341_SetAddressWindow(Context *ctx, uint16_t x0, uint16_t y0, uint16_t x
 
 void ILI9341_DrawRectangle(Context *ctx, uint16_t x, uint16_t y, uint16_t x_off, uint16_t y_off, uint16_t color);
 
+void ILI9341_BeginPixels(Context *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+void ILI9341_WritePixels(Context *ctx, const uint16_t *pixels, uint32_t n);
+
 
 
@@ -0,0 +1,223 @@
+/*
+  host test of the GFXfont text in gfx.c, make HOST=1 && ./font-test.host
+
+  draws strings in a small made up font through the whole stack, ili9341 model and all,
+  at sizes 1-3, wrapped, partly off screen, with newlines and chars the font doesn't have.
+  each one is read back off the panel and compared with font-test.txt, the box getTextBounds()
+  gives for the string with the pixels in it as '#' and '.'. anything drawn outside that box fails too.
+
+  ./font-test.host -w writes font-test.txt from what is drawn now. only do that once the
+  pictures in it have been checked by eye.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+
+#include "clock.h"
+#include "Adafruit_ILI9341.h"
+#include "lcd_spi.h"
+#include "lcd_ili9341.h"
+#include "context.h"
+#include "gfx.h"
+
+
+#define GOLDEN  "font-test.txt"
+
+
+/*
+  the font, 'a' to 'e'. odd widths so rows aren't byte aligned, wider than a byte,
+  a negative x offset, a descender, and 'd' is blank like a space.
+*/
+static const struct
+{
+  int8_t xo, yo;
+  uint8_t xa;
+  const char *rows[10];
+} art[] = {
+  { 0, -7, 7, { ".###.",
+                "#...#",
+                "....#",
+                ".####",
+                "#...#",
+                "#..##",
+                ".##.#" } },
+  { 1, -9, 5, { "#..",
+                "#..",
+                "#..",
+                "##.",
+                "#.#",
+                "#.#",
+                "#.#",
+                "#.#",
+                "##." } },
+  { -1, -4, 10, { "..#######..",
+                  ".#.......#.",
+                  "#.........#",
+                  "###########" } },
+  { 0, 0, 4, { NULL } },
+  { 0, -2, 8, { "#######",
+                "#.....#",
+                "###.###",
+                "..#.#..",
+                "..###.." } },
+};
+
+#define GLYPHS  (sizeof(art) / sizeof(art[0]))
+
+static uint8_t bitmap[64];
+static GFXglyph glyphs[GLYPHS];
+static GFXfont test_font = {
+  .bitmap = bitmap, .glyph = glyphs, .first = 'a', .last = 'a' + GLYPHS - 1, .yAdvance = 12,
+};
+
+
+// pack the art into the bitmap, the bits run on from row to row as in any GFXfont
+static void make_font(void)
+{
+  uint32_t bit = 0;
+
+  for (unsigned i = 0; i < GLYPHS; i++) {
+    GFXglyph *g = &glyphs[i];
+    g->bitmapOffset = (bit + 7) / 8;
+    g->width = art[i].rows[0] ? strlen(art[i].rows[0]) : 0;
+    g->height = 0;
+    g->xAdvance = art[i].xa;
+    g->xOffset = art[i].xo;
+    g->yOffset = art[i].yo;
+    bit = g->bitmapOffset * 8;
+    for (; g->height < 10 && art[i].rows[g->height]; g->height++)
+      for (const char *p = art[i].rows[g->height]; *p; p++, bit++)
+        if (*p == '#')
+          bitmap[bit / 8] |= 0x80 >> (bit % 8);
+  }
+}
+
+
+static const struct
+{
+  uint8_t size_x, size_y;
+  int16_t x, y;
+  bool wrap;
+  const char *s;
+} cases[] = {
+  { 1, 1, 10, 20, true, "abcde" },
+  { 2, 2, 10, 40, true, "abcde" },
+  { 3, 3, 4, 60, true, "eca" },
+  { 3, 1, 10, 20, true, "abc" },
+  { 1, 3, 10, 40, true, "cab" },
+  { 2, 2, 180, 40, true, "abcabc" },                    // wraps
+  { 2, 2, 180, 40, false, "abcabc" },                   // runs off the right
+  { 2, 2, -7, 6, true, "cab" },                         // off the left and the top
+  { 1, 2, 100, 315, true, "eeb" },                      // off the bottom
+  { 2, 1, 20, 100, true, "ab\ncde\r\n\nxa?b" },         // newlines, and chars not in the font
+};
+
+#define CASES   (sizeof(cases) / sizeof(cases[0]))
+
+
+static Context ctx;
+static struct lcd lcd;
+
+// what each case drew, as it goes in the golden file
+static char out[CASES][16384];
+
+
+static void draw(unsigned i, char *p)
+{
+  const uint16_t *fb = host_panel_frame();
+  int16_t x1, y1;
+  uint16_t w, h;
+  int bad = 0;
+
+  fillScreen(&ctx, ILI9341_WHITE);
+  setTextSize(&ctx, cases[i].size_x, cases[i].size_y);
+  setTextColor(&ctx, ILI9341_BLACK);
+  ctx.wrap = cases[i].wrap;
+  getTextBounds(&ctx, cases[i].s, cases[i].x, cases[i].y, &x1, &y1, &w, &h);
+  setCursor(&ctx, cases[i].x, cases[i].y);
+  writeString(&ctx, cases[i].s);
+
+  // the rotation is 0, the panel model's frame is the screen as ctx sees it
+  for (int y = 0; y < ctx.height; y++)
+    for (int x = 0; x < ctx.width; x++)
+      if (fb[y * ctx.width + x] != ILI9341_WHITE
+          && (x < x1 || x >= x1 + w || y < y1 || y >= y1 + h))
+        bad++;
+
+  p += sprintf(p, "case %u: size %ux%u at %d,%d%s \"", i, cases[i].size_x, cases[i].size_y,
+               cases[i].x, cases[i].y, cases[i].wrap ? "" : " nowrap");
+  for (const char *s = cases[i].s; *s; s++)
+    p += sprintf(p, *s == '\n' ? "\\n" : *s == '\r' ? "\\r" : "%c", *s);
+  p += sprintf(p, "\"\nbounds %d,%d %ux%u\n", x1, y1, w, h);
+  if (bad)
+    p += sprintf(p, "%d pixels drawn outside the bounds\n", bad);
+
+  // the box, the part of it on screen
+  for (int y = y1 < 0 ? 0 : y1; y < y1 + h && y < ctx.height; y++) {
+    for (int x = x1 < 0 ? 0 : x1; x < x1 + w && x < ctx.width; x++)
+      *p++ = fb[y * ctx.width + x] != ILI9341_WHITE ? '#' : '.';
+    *p++ = '\n';
+  }
+  *p++ = '\n';
+  *p = 0;
+}
+
+
+int main(int argc, char **argv)
+{
+  static char golden[sizeof(out)];
+  bool update = argc > 1 && !strcmp(argv[1], "-w");
+  FILE *f;
+  int failed = 0;
+
+  host_no_limits();
+  clock_setup();
+  lcd_spi_setup();
+  initialize(&ctx, &lcd, &lcd_spi_polled);
+  ILI9341_setRotation(&ctx, 0);
+
+  make_font();
+  setFont(&ctx, &test_font);
+  for (unsigned i = 0; i < CASES; i++)
+    draw(i, out[i]);
+
+  if (update) {
+    f = fopen(GOLDEN, "w");
+    if (!f) {
+      perror(GOLDEN);
+      return 1;
+    }
+    for (unsigned i = 0; i < CASES; i++)
+      fputs(out[i], f);
+    fclose(f);
+    printf("wrote %s, %u cases\n", GOLDEN, (unsigned) CASES);
+    return 0;
+  }
+
+  f = fopen(GOLDEN, "r");
+  if (!f) {
+    perror(GOLDEN);
+    return 1;
+  }
+  size_t n = fread(golden, 1, sizeof(golden) - 1, f);
+  golden[n] = 0;
+  fclose(f);
+
+  // the golden file is the cases one after the other, each ends in a blank line
+  char *g = golden;
+  for (unsigned i = 0; i < CASES; i++) {
+    size_t len = strlen(out[i]);
+    bool ok = strncmp(g, out[i], len) == 0 && !strstr(out[i], "outside the bounds");
+    printf("case %u %s\n", i, ok ? "ok" : "FAILED");
+    if (!ok) {
+      fputs(out[i], stdout);
+      failed = 1;
+    }
+    char *next = strstr(g, "\n\n");
+    g = next ? next + 2 : g + strlen(g);
+  }
+  return failed;
+}
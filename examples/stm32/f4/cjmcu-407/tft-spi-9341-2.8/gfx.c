@@ -1,11 +1,13 @@
 
 
 #include <stdint.h> // uint16_t etc
+#include <string.h> // memcpy
 
 #include "Adafruit-GFX-Library/gfxfont.h"
 #include "Adafruit-GFX-Library/glcdfont.c"
 
 
+#include "Adafruit_ILI9341.h"
 #include "context.h"
 #include "gfx.h"
 
@@ -27,6 +29,21 @@ void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
 
 void fillRect(Context *ctx, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 {
+  // clip to the screen. else the address window is garbage
+  if (x < 0) {
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    h += y;
+    y = 0;
+  }
+  if (x + w > ctx->width)
+    w = ctx->width - x;
+  if (y + h > ctx->height)
+    h = ctx->height - y;
+  if (w <= 0 || h <= 0)
+    return;
 
   ILI9341_DrawRectangle(ctx, x, y, w, h, color);
 #if 0
@@ -129,10 +146,58 @@ void writePixel(Context *ctx, int16_t x, int16_t y, uint16_t color) {
 
 
 
+// cohen-sutherland outcodes. which side(s) of the screen a point is off
+#define OUT_LEFT    1
+#define OUT_RIGHT   2
+#define OUT_TOP     4
+#define OUT_BOTTOM  8
+
+static int outcode(Context *ctx, int16_t x, int16_t y)
+{
+  int code = 0;
+  if (x < 0)
+    code |= OUT_LEFT;
+  else if (x >= ctx->width)
+    code |= OUT_RIGHT;
+  if (y < 0)
+    code |= OUT_TOP;
+  else if (y >= ctx->height)
+    code |= OUT_BOTTOM;
+  return code;
+}
+
+
+/*
+  same bresenham line as adafruit, pixel for pixel.
+  but drawn as horizontal runs (vertical for steep lines), so each run is one address window and one burst.
+  instead of a window per pixel. run length is worked out with a divide, rather than stepping.
+
+  lines entirely off one side of the screen are rejected up front.
+  for partly visible lines, we compute the first and last step that land on screen, and only walk those.
+*/
 void writeLine(Context *ctx, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
-#if defined(ESP8266)
-  yield();
-#endif
+
+  if (outcode(ctx, x0, y0) & outcode(ctx, x1, y1))
+    return;
+
+  // clamp these to the screen, so the length fits int16_t
+  if (y0 == y1) {
+    if (x0 > x1)
+      _swap_int16_t(x0, x1);
+    x0 = x0 < 0 ? 0 : x0;
+    x1 = x1 >= ctx->width ? ctx->width - 1 : x1;
+    writeFastHLine(ctx, x0, y0, x1 - x0 + 1, color);
+    return;
+  }
+  if (x0 == x1) {
+    if (y0 > y1)
+      _swap_int16_t(y0, y1);
+    y0 = y0 < 0 ? 0 : y0;
+    y1 = y1 >= ctx->height ? ctx->height - 1 : y1;
+    writeFastVLine(ctx, x0, y0, y1 - y0 + 1, color);
+    return;
+  }
+
   int16_t steep = abs(y1 - y0) > abs(x1 - x0);
   if (steep) {
     _swap_int16_t(x0, y0);
@@ -144,31 +209,65 @@ void writeLine(Context *ctx, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uin
     _swap_int16_t(y0, y1);
   }
 
-  int16_t dx, dy;
-  dx = x1 - x0;
-  dy = abs(y1 - y0);
-
-  int16_t err = dx / 2;
-  int16_t ystep;
-
-  if (y0 < y1) {
-    ystep = 1;
+  int32_t dx = x1 - x0;
+  int32_t dy = abs(y1 - y0);
+  int32_t ystep = y0 < y1 ? 1 : -1;
+  int32_t e0 = dx / 2;
+
+  /*
+    step n of the line is at x0 + n, and has moved m(n) rows,
+    where m(n) is the smallest m with e0 - n * dy + m * dx >= 0.
+    clip n to the screen on the major axis, then to the rows that are on screen on the minor axis.
+  */
+  int32_t major = steep ? ctx->height : ctx->width;
+  int32_t minor = steep ? ctx->width : ctx->height;
+  int32_t nlo = x0 < 0 ? -x0 : 0;
+  int32_t nhi = x1 >= major ? major - 1 - x0 : dx;
+  int32_t mlo, mhi, m;
+
+  if (ystep > 0) {
+    mlo = -y0;
+    mhi = minor - 1 - y0;
   } else {
-    ystep = -1;
+    mlo = y0 - (minor - 1);
+    mhi = y0;
   }
+  if (mhi < 0 || mlo > dy)
+    return;
 
-  for (; x0 <= x1; x0++) {
-    if (steep) {
-      writePixel(ctx, y0, x0, color);
-    } else {
-      writePixel(ctx, x0, y0, color);
-    }
-    err -= dy;
-    if (err < 0) {
-      y0 += ystep;
-      err += dx;
-    }
+  if (mlo > 0) {
+    m = ((int64_t)e0 + (int64_t)(mlo - 1) * dx) / dy + 1;
+    if (m > nlo)
+      nlo = m;
+  }
+  if (mhi < dy) {
+    m = ((int64_t)e0 + (int64_t)mhi * dx) / dy;
+    if (m < nhi)
+      nhi = m;
+  }
+  if (nlo > nhi)
+    return;
+
+  m = ((int64_t)nlo * dy - e0 + dx - 1) / dx;
+  int32_t err = e0 - (int64_t)nlo * dy + (int64_t)m * dx;
+  int32_t x = x0 + nlo;
+  int32_t y = y0 + m * ystep;
+  int32_t xend = x0 + nhi;
+
+  startWrite(ctx);
+  while (x <= xend) {
+    int32_t k = err / dy + 1;
+    if (x + k - 1 > xend)
+      k = xend - x + 1;
+    if (steep)
+      writeFastVLine(ctx, y, x, k, color);
+    else
+      writeFastHLine(ctx, x, y, k, color);
+    x += k;
+    err += dx - k * dy;
+    y += ystep;
   }
+  endWrite(ctx);
 }
 
 
@@ -221,6 +320,93 @@ static inline uint8_t pgm_read_byte(const uint8_t *addr) {
   return *addr;
 }
 
+static inline const GFXglyph *pgm_read_glyph_ptr(const GFXfont *gfxFont, uint8_t c) {
+  return gfxFont->glyph + c;
+}
+
+static inline const uint8_t *pgm_read_bitmap_ptr(const GFXfont *gfxFont) {
+  return gfxFont->bitmap;
+}
+
+
+
+
+/*
+  glyph cache.
+  opaque characters are expanded to rgb565 once, for a given (c, color, bg, size),
+  and then sent as one address window and one burst of pixels.
+  least recently used entry gets thrown out. bigger text than GLYPH_MAX_SIZE is not cached.
+*/
+#define GLYPH_CACHE     8
+#define GLYPH_MAX_SIZE  3
+#define GLYPH_PIXELS    (6 * 8 * GLYPH_MAX_SIZE * GLYPH_MAX_SIZE)
+
+typedef struct Glyph
+{
+  uint16_t color, bg;
+  uint8_t c;
+  uint8_t size_x, size_y;   // 0 == empty slot
+  uint32_t used;            // glyph_clock when last used
+  uint16_t pixels[GLYPH_PIXELS];
+} Glyph;
+
+static Glyph glyph_cache[GLYPH_CACHE];
+static uint32_t glyph_clock;
+
+
+// column i (0..5) of char c. bit 0 is the top row. column 5 is the gap between chars.
+static inline uint8_t glyphColumn(unsigned char c, int8_t i)
+{
+  return i < 5 ? pgm_read_byte(&font[c * 5 + i]) : 0;
+}
+
+
+// one row of pixels of the char, as the display wants them, left to right. returns next position
+static uint16_t *glyphRow(uint16_t *p, unsigned char c, int8_t j, uint16_t color, uint16_t bg, uint8_t size_x)
+{
+  for (int8_t i = 0; i < 6; i++) {
+    uint16_t v = (glyphColumn(c, i) >> j) & 1 ? color : bg;
+    for (uint8_t k = 0; k < size_x; k++)
+      *p++ = v;
+  }
+  return p;
+}
+
+
+static const uint16_t *glyphLookup(unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y)
+{
+  Glyph *lru = &glyph_cache[0];
+
+  ++glyph_clock;
+  for (int i = 0; i < GLYPH_CACHE; i++) {
+    Glyph *g = &glyph_cache[i];
+    if (g->c == c && g->color == color && g->bg == bg && g->size_x == size_x && g->size_y == size_y) {
+      g->used = glyph_clock;
+      return g->pixels;
+    }
+    if (g->used < lru->used)
+      lru = g;
+  }
+
+  // miss, expand into the oldest slot
+  Glyph *g = lru;
+  g->c = c;
+  g->color = color;
+  g->bg = bg;
+  g->size_x = size_x;
+  g->size_y = size_y;
+  g->used = glyph_clock;
+
+  uint16_t w = 6 * size_x;
+  uint16_t *p = g->pixels;
+  for (int8_t j = 0; j < 8; j++) {
+    p = glyphRow(p, c, j, color, bg, size_x);
+    for (uint8_t k = 1; k < size_y; k++, p += w)
+      memcpy(p, p - w, w * sizeof(uint16_t));
+  }
+  return g->pixels;
+}
+
 
 
 // Draw a character
@@ -255,92 +441,78 @@ void drawChar(
     if (!ctx->cp437 && (c >= 176))
       c++; // Handle 'classic' charset behavior
 
+    int16_t w = 6 * size_x, h = 8 * size_y;
+
+    if (bg != color && size_x <= GLYPH_MAX_SIZE && size_y <= GLYPH_MAX_SIZE
+        && x >= 0 && y >= 0 && x + w <= ctx->width && y + h <= ctx->height) {
+      // opaque and all on screen. so one window, and one burst from the cache
+      ILI9341_BeginPixels(ctx, x, y, w, h);
+      ILI9341_WritePixels(ctx, glyphLookup(c, color, bg, size_x, size_y), w * h);
+      return;
+    }
+
+    // otherwise, runs of the same bit down each column as one rect, instead of a rect per bit.
     startWrite(ctx);
-    for (int8_t i = 0; i < 5; i++) { // Char bitmap = 5 columns
-      uint8_t line = pgm_read_byte(&font[c * 5 + i]);
-      for (int8_t j = 0; j < 8; j++, line >>= 1) {
-        if (line & 1) {
-          if (size_x == 1 && size_y == 1)
-            writePixel(ctx, x + i, y + j, color);
-          else
-            writeFillRect(ctx, x + i * size_x, y + j * size_y, size_x, size_y, color);
-        } else if (bg != color) {
-          if (size_x == 1 && size_y == 1)
-            writePixel(ctx, x + i, y + j, bg);
-          else
-            writeFillRect(ctx, x + i * size_x, y + j * size_y, size_x, size_y, bg);
-        }
+    for (int8_t i = 0; i < 6; i++) { // Char bitmap = 5 columns, and the gap
+      uint8_t line = glyphColumn(c, i);
+      int8_t k;
+      for (int8_t j = 0; j < 8; j = k) {
+        uint8_t bit = (line >> j) & 1;
+        for (k = j + 1; k < 8 && ((line >> k) & 1) == bit; k++)
+          ;
+        if (bit)
+          writeFillRect(ctx, x + i * size_x, y + j * size_y, size_x, (k - j) * size_y, color);
+        else if (bg != color)
+          writeFillRect(ctx, x + i * size_x, y + j * size_y, size_x, (k - j) * size_y, bg);
       }
     }
-    if (bg != color) { // If opaque, draw vertical line for last column
-      if (size_x == 1 && size_y == 1)
-        writeFastVLine(ctx, x + 5, y, 8, bg);
-      else
-        writeFillRect(ctx, x + 5 * size_x, y, size_x, 8 * size_y, bg);
-    }
     endWrite(ctx);
 
   } else { // Custom font
 
-#if 0
     // Character is assumed previously filtered by write() to eliminate
     // newlines, returns, non-printable characters, etc.  Calling
     // drawChar() directly with 'bad' characters of font may cause mayhem!
 
-    c -= (uint8_t)pgm_read_byte(&gfxFont->first);
-    GFXglyph *glyph = pgm_read_glyph_ptr(gfxFont, c);
-    uint8_t *bitmap = pgm_read_bitmap_ptr(gfxFont);
-
-    uint16_t bo = pgm_read_word(&glyph->bitmapOffset);
-    uint8_t w = pgm_read_byte(&glyph->width), h = pgm_read_byte(&glyph->height);
-    int8_t xo = pgm_read_byte(&glyph->xOffset),
-           yo = pgm_read_byte(&glyph->yOffset);
-    uint8_t xx, yy, bits = 0, bit = 0;
-    int16_t xo16 = 0, yo16 = 0;
+    const GFXfont *gfxFont = ctx->gfxFont;
 
-    if (size_x > 1 || size_y > 1) {
-      xo16 = xo;
-      yo16 = yo;
-    }
+    c -= (uint8_t)gfxFont->first;
+    const GFXglyph *glyph = pgm_read_glyph_ptr(gfxFont, c);
+    const uint8_t *bitmap = pgm_read_bitmap_ptr(gfxFont);
 
-    // Todo: Add character clipping here
+    uint16_t bo = glyph->bitmapOffset;
+    uint8_t w = glyph->width, h = glyph->height;
+    int8_t xo = glyph->xOffset, yo = glyph->yOffset;
+    uint8_t xx, yy, bits = 0, bit = 0;
 
     // NOTE: THERE IS NO 'BACKGROUND' COLOR OPTION ON CUSTOM FONTS.
-    // THIS IS ON PURPOSE AND BY DESIGN.  The background color feature
-    // has typically been used with the 'classic' font to overwrite old
-    // screen contents with new data.  This ONLY works because the
-    // characters are a uniform size; it's not a sensible thing to do with
-    // proportionally-spaced fonts with glyphs of varying sizes (and that
-    // may overlap).  To replace previously-drawn text when using a custom
-    // font, use the getTextBounds() function to determine the smallest
-    // rectangle encompassing a string, erase the area with fillRect(),
-    // then draw new text.  This WILL infortunately 'blink' the text, but
-    // is unavoidable.  Drawing 'background' pixels will NOT fix this,
-    // only creates a new set of problems.  Have an idea to work around
-    // this (a canvas object type for MCUs that can afford the RAM and
-    // displays supporting setAddrWindow() and pushColors()), but haven't
-    // implemented this yet.
+    // as adafruit. proportional glyphs overlap, so use getTextBounds() and fillRect() to erase old text.
 
-    startWrite();
+    // bits are packed continuously, rows are not byte aligned.
+    // each run of set bits in a row goes out as one rect, so one address window per run instead of per pixel.
+    // writeFillRect() clips, so glyphs that hang off the edge are fine.
+    startWrite(ctx);
     for (yy = 0; yy < h; yy++) {
+      int16_t run = -1;   // start of current run of set bits
       for (xx = 0; xx < w; xx++) {
         if (!(bit++ & 7)) {
           bits = pgm_read_byte(&bitmap[bo++]);
         }
         if (bits & 0x80) {
-          if (size_x == 1 && size_y == 1) {
-            writePixel(x + xo + xx, y + yo + yy, color);
-          } else {
-            writeFillRect(x + (xo16 + xx) * size_x, y + (yo16 + yy) * size_y,
-                          size_x, size_y, color);
-          }
+          if (run < 0)
+            run = xx;
+        } else if (run >= 0) {
+          writeFillRect(ctx, x + (xo + run) * size_x, y + (yo + yy) * size_y,
+                        (xx - run) * size_x, size_y, color);
+          run = -1;
         }
         bits <<= 1;
       }
+      if (run >= 0)
+        writeFillRect(ctx, x + (xo + run) * size_x, y + (yo + yy) * size_y,
+                      (w - run) * size_x, size_y, color);
     }
-    endWrite();
-
-#endif
+    endWrite(ctx);
 
   } // End classic vs custom font
 }
@@ -366,32 +538,32 @@ size_t write(Context *ctx, uint8_t c)
 
   } else { // Custom font
 
-#if 0
+    const GFXfont *gfxFont = ctx->gfxFont;
+
     if (c == '\n') {
-      cursor_x = 0;
-      cursor_y +=
-          (int16_t)textsize_y * (uint8_t)pgm_read_byte(&gfxFont->yAdvance);
+      ctx->cursor_x = 0;
+      ctx->cursor_y +=
+          (int16_t)ctx->textsize_y * (uint8_t)gfxFont->yAdvance;
     } else if (c != '\r') {
-      uint8_t first = pgm_read_byte(&gfxFont->first);
-      if ((c >= first) && (c <= (uint8_t)pgm_read_byte(&gfxFont->last))) {
-        GFXglyph *glyph = pgm_read_glyph_ptr(gfxFont, c - first);
-        uint8_t w = pgm_read_byte(&glyph->width),
-                h = pgm_read_byte(&glyph->height);
+      uint8_t first = gfxFont->first;
+      if ((c >= first) && (c <= (uint8_t)gfxFont->last)) {
+        const GFXglyph *glyph = pgm_read_glyph_ptr(gfxFont, c - first);
+        uint8_t w = glyph->width,
+                h = glyph->height;
         if ((w > 0) && (h > 0)) { // Is there an associated bitmap?
-          int16_t xo = (int8_t)pgm_read_byte(&glyph->xOffset); // sic
-          if (wrap && ((cursor_x + textsize_x * (xo + w)) > _width)) {
-            cursor_x = 0;
-            cursor_y += (int16_t)textsize_y *
-                        (uint8_t)pgm_read_byte(&gfxFont->yAdvance);
+          int16_t xo = glyph->xOffset; // sic
+          if (ctx->wrap && ((ctx->cursor_x + ctx->textsize_x * (xo + w)) > ctx->width)) {
+            ctx->cursor_x = 0;
+            ctx->cursor_y += (int16_t)ctx->textsize_y *
+                        (uint8_t)gfxFont->yAdvance;
           }
-          drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x,
-                   textsize_y);
+          drawChar(ctx, ctx->cursor_x, ctx->cursor_y, c, ctx->textcolor, ctx->textbgcolor, ctx->textsize_x,
+                   ctx->textsize_y);
         }
-        cursor_x +=
-            (uint8_t)pgm_read_byte(&glyph->xAdvance) * (int16_t)textsize_x;
+        ctx->cursor_x +=
+            (uint8_t)glyph->xAdvance * (int16_t)ctx->textsize_x;
       }
     }
-#endif
   }
   return 1;
 }
@@ -399,6 +571,64 @@ size_t write(Context *ctx, uint8_t c)
 
 
 
+
+/*
+  how many chars of s can go out as a single block at the cursor.
+  opaque classic font, all on screen, and stops at end of line or where write() would wrap.
+*/
+static int lineRun(Context *ctx, const char *s)
+{
+  int16_t x = ctx->cursor_x, y = ctx->cursor_y;
+  int16_t w = 6 * ctx->textsize_x;
+  int n = 0;
+
+  if (ctx->gfxFont || ctx->textcolor == ctx->textbgcolor
+      || x < 0 || y < 0 || y + 8 * ctx->textsize_y > ctx->height)
+    return 0;
+
+  while (s[n] && s[n] != '\n' && s[n] != '\r' && x + (n + 1) * w <= ctx->width)
+    ++n;
+  return n;
+}
+
+
+/*
+  like calling write() for each char.
+  but opaque text is batched into one address window per line, and sent a pixel row at a time.
+*/
+void writeString(Context *ctx, const char *s)
+{
+  static uint16_t row[ILI9341_TFTHEIGHT];  // longest line, in any rotation
+
+  while (*s) {
+    int n = lineRun(ctx, s);
+    if (n < 2) {
+      write(ctx, *s++);
+      continue;
+    }
+
+    uint16_t w = n * 6 * ctx->textsize_x;
+    ILI9341_BeginPixels(ctx, ctx->cursor_x, ctx->cursor_y, w, 8 * ctx->textsize_y);
+
+    for (int8_t j = 0; j < 8; j++) {
+      uint16_t *p = row;
+      for (int k = 0; k < n; k++) {
+        unsigned char c = s[k];
+        if (!ctx->cp437 && (c >= 176))
+          c++; // Handle 'classic' charset behavior
+        p = glyphRow(p, c, j, ctx->textcolor, ctx->textbgcolor, ctx->textsize_x);
+      }
+      for (uint8_t k = 0; k < ctx->textsize_y; k++)
+        ILI9341_WritePixels(ctx, row, w);
+    }
+
+    ctx->cursor_x += n * 6 * ctx->textsize_x;
+    s += n;
+  }
+}
+
+
+
 void setCursor(Context *ctx, int16_t x, int16_t y) 
 {
     ctx->cursor_x = x;
@@ -419,6 +649,124 @@ void setTextSize(Context *ctx, uint8_t s_x, uint8_t s_y)
 
 
 
+void setFont(Context *ctx, const GFXfont *f)
+{
+  if (f) {          // Font struct pointer passed in?
+    if (!ctx->gfxFont) { // And no current font struct?
+      // Switching from classic to new font behavior.
+      // Move cursor pos down 6 pixels so it's on baseline.
+      ctx->cursor_y += 6;
+    }
+  } else if (ctx->gfxFont) { // NULL passed.  Current font struct defined?
+    // Switching from new to classic font behavior.
+    // Move cursor pos up 6 pixels so it's at top-left of char.
+    ctx->cursor_y -= 6;
+  }
+  ctx->gfxFont = (void *)f;
+}
+
+
+
+/*
+  grow the bounding box minx..maxy by char c drawn at *x, *y, and advance *x, *y like write() does.
+  no kerning, same as drawing.
+*/
+static void charBounds(Context *ctx, unsigned char c, int16_t *x, int16_t *y,
+                       int16_t *minx, int16_t *miny, int16_t *maxx, int16_t *maxy)
+{
+  if (ctx->gfxFont) {
+
+    const GFXfont *gfxFont = ctx->gfxFont;
+
+    if (c == '\n') { // Newline?
+      *x = 0;        // Reset x to zero, advance y by one line
+      *y += ctx->textsize_y * (uint8_t)gfxFont->yAdvance;
+    } else if (c != '\r') { // Not a carriage return; is normal char
+      uint8_t first = gfxFont->first,
+              last = gfxFont->last;
+      if ((c >= first) && (c <= last)) { // Char present in this font?
+        const GFXglyph *glyph = pgm_read_glyph_ptr(gfxFont, c - first);
+        uint8_t gw = glyph->width,
+                gh = glyph->height,
+                xa = glyph->xAdvance;
+        int8_t xo = glyph->xOffset,
+               yo = glyph->yOffset;
+        if (ctx->wrap && ((*x + (((int16_t)xo + gw) * ctx->textsize_x)) > ctx->width)) {
+          *x = 0; // Reset x to zero, advance y by one line
+          *y += ctx->textsize_y * (uint8_t)gfxFont->yAdvance;
+        }
+        int16_t tsx = (int16_t)ctx->textsize_x, tsy = (int16_t)ctx->textsize_y,
+                x1 = *x + xo * tsx, y1 = *y + yo * tsy, x2 = x1 + gw * tsx - 1,
+                y2 = y1 + gh * tsy - 1;
+        if (x1 < *minx)
+          *minx = x1;
+        if (y1 < *miny)
+          *miny = y1;
+        if (x2 > *maxx)
+          *maxx = x2;
+        if (y2 > *maxy)
+          *maxy = y2;
+        *x += xa * tsx;
+      }
+    }
+
+  } else { // Default font
+
+    if (c == '\n') {        // Newline?
+      *x = 0;               // Reset x to zero,
+      *y += ctx->textsize_y * 8; // advance y one line
+      // min/max x/y unchaged -- that waits for next 'normal' character
+    } else if (c != '\r') { // Normal char; ignore carriage returns
+      if (ctx->wrap && ((*x + ctx->textsize_x * 6) > ctx->width)) { // Off right?
+        *x = 0;                                       // Reset x to zero,
+        *y += ctx->textsize_y * 8;                         // advance y one line
+      }
+      int x2 = *x + ctx->textsize_x * 6 - 1, // Lower-right pixel of char
+          y2 = *y + ctx->textsize_y * 8 - 1;
+      if (x2 > *maxx)
+        *maxx = x2; // Track max x, y
+      if (y2 > *maxy)
+        *maxy = y2;
+      if (*x < *minx)
+        *minx = *x; // Track min x, y
+      if (*y < *miny)
+        *miny = *y;
+      *x += ctx->textsize_x * 6; // Advance x one char
+    }
+  }
+}
+
+
+
+void getTextBounds(Context *ctx, const char *str, int16_t x, int16_t y,
+                   int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h)
+{
+  uint8_t c; // Current character
+  int16_t minx = 0x7FFF, miny = 0x7FFF, maxx = -1, maxy = -1; // Bound rect
+  // Bound rect is intentionally initialized inverted, so 1st char sets it
+
+  *x1 = x; // Initial position is value passed in
+  *y1 = y;
+  *w = *h = 0; // Initial size is zero
+
+  while ((c = *str++)) {
+    // charBounds() modifies x/y to advance for each character,
+    // and min/max x/y are updated to incrementally build bounding rect.
+    charBounds(ctx, c, &x, &y, &minx, &miny, &maxx, &maxy);
+  }
+
+  if (maxx >= minx) {     // If legit string bounds were found...
+    *x1 = minx;           // Update x1 to least X coord,
+    *w = maxx - minx + 1; // And w to bound rect width
+  }
+  if (maxy >= miny) { // Same for height
+    *y1 = miny;
+    *h = maxy - miny + 1;
+  }
+}
+
+
+
 
 
 
@@ -14,6 +14,8 @@
 #include <stdint.h> // uint16_t
 #include <stddef.h> // size_t
 
+#include "Adafruit-GFX-Library/gfxfont.h"
+
 
 // prefix with gfx_
 
@@ -55,12 +57,22 @@ void drawChar(
 */
 size_t write(Context *ctx, uint8_t c);
 
+// same as write() for each char, but opaque text goes out a line at a time
+void writeString(Context *ctx, const char *s);
+
 void setCursor(Context *ctx, int16_t x, int16_t y) ;
 void setTextColor(Context *ctx, uint16_t c) ;
 //void setTextColor2(uint16_t c, uint16_t bg) ;
 
 void setTextSize(Context *ctx, uint8_t s_x, uint8_t s_y) ;
 
+// NULL for the classic built in font. else an adafruit GFXfont, eg. from Adafruit-GFX-Library/Fonts/
+void setFont(Context *ctx, const GFXfont *f);
+
+// box that str would cover, if written with the cursor at x,y. same wrapping as write()
+void getTextBounds(Context *ctx, const char *str, int16_t x, int16_t y,
+                   int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h);
+
 
 
 
@@ -59,9 +59,12 @@
 */
 
 
+#include <stdbool.h>
+
 #include <libopencm3/stm32/spi.h>
 // #include <libopencm3/stm32/rcc.h>
 #include <libopencm3/stm32/gpio.h>
+#include <libopencm3/stm32/dma.h>
 
 
 #include "lcd_spi.h"
@@ -90,13 +93,49 @@
 #define LCD_CTL_LED   GPIO6
 
 
+/*
+  spi1 tx is dma2, stream 3, channel 3.
+  (stream 5 channel 3 also works, but that one is free for spi1 rx)
+*/
+#define LCD_DMA         DMA2
+#define LCD_DMA_STREAM  DMA_STREAM3
+#define LCD_DMA_CHANNEL DMA_SxCR_CHSEL_3
+
+// ndtr is 16 bit, so longer fills are sent in chunks of this many pixels
+#define LCD_DMA_CHUNK   65535
+
+// below this, setting up dma costs more than just pushing the pixels
+#define LCD_DMA_MIN     64
+
 
+// whether the spi is currently in 16 bit data frame mode
+static bool frame16 = false;
 
+// source for the dma fill. memory increment is off, so the same word is sent each time.
+static uint16_t fill_color;
 
 
 
 
 
+
+
+
+
+static void lcd_dma_setup( void )
+{
+  // caller must have done, rcc_periph_clock_enable(RCC_DMA2);
+  dma_stream_reset(LCD_DMA, LCD_DMA_STREAM);
+  dma_channel_select(LCD_DMA, LCD_DMA_STREAM, LCD_DMA_CHANNEL);
+  dma_set_priority(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_PL_HIGH);
+  dma_set_memory_size(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_MSIZE_16BIT);
+  dma_set_peripheral_size(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_PSIZE_16BIT);
+  dma_set_transfer_mode(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_DIR_MEM_TO_PERIPHERAL);
+  dma_set_peripheral_address(LCD_DMA, LCD_DMA_STREAM, (uint32_t) &SPI_DR(LCD_SPI));
+}
+
+
+
 void lcd_spi_setup( void )
 {
   // uart_printf("dac setup spi\n\r");
@@ -139,6 +178,8 @@ void lcd_spi_setup( void )
   // set up gpio
   gpio_mode_setup(LCD_CTL_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, LCD_CTL_RST | LCD_CTL_DC | LCD_CTL_LED);
 
+  lcd_dma_setup();
+
   // uart_printf("dac setup spi done\n\r");
 }
 
@@ -283,6 +324,63 @@ static void lcd_spi_send8( uint8_t x )
 
 
 
+/*
+  DFF may only be changed while the spi is disabled (RM0090 28.5.1).
+  so drain, disable, flip, enable.
+  the flag means we only pay for this when the mode actually changes.
+*/
+static void lcd_spi_frame16( bool on )
+{
+  if(on == frame16)
+    return;
+
+  wait_for_transfer_finish();
+  spi_disable(LCD_SPI);
+  if(on)
+    spi_set_dff_16bit(LCD_SPI);
+  else
+    spi_set_dff_8bit(LCD_SPI);
+  spi_enable(LCD_SPI);
+  frame16 = on;
+}
+
+
+
+/*
+  send n 16 bit words with dma.
+  for a fill, the source is a single word with no memory increment. so the spi just gets the same pixel
+  n times, and the cpu only re-arms the stream every 64k pixels.
+  still blocks until done, since the next command has to toggle D/CX.
+*/
+static void lcd_spi_send_dma( const uint16_t *p, uint32_t n, bool inc )
+{
+  if(inc)
+    dma_enable_memory_increment_mode(LCD_DMA, LCD_DMA_STREAM);
+  else
+    dma_disable_memory_increment_mode(LCD_DMA, LCD_DMA_STREAM);
+
+  spi_enable_tx_dma(LCD_SPI);
+
+  while(n) {
+    uint32_t chunk = n > LCD_DMA_CHUNK ? LCD_DMA_CHUNK : n;
+
+    dma_clear_interrupt_flags(LCD_DMA, LCD_DMA_STREAM, DMA_TCIF);
+    dma_set_memory_address(LCD_DMA, LCD_DMA_STREAM, (uint32_t) p);
+    dma_set_number_of_data(LCD_DMA, LCD_DMA_STREAM, chunk);
+    dma_enable_stream(LCD_DMA, LCD_DMA_STREAM);
+
+    while(!dma_get_interrupt_flag(LCD_DMA, LCD_DMA_STREAM, DMA_TCIF));
+
+    if(inc)
+      p += chunk;
+    n -= chunk;
+  }
+
+  spi_disable_tx_dma(LCD_SPI);
+}
+
+
+
 
 
 
@@ -298,37 +396,119 @@ static void lcd_spi_send8( uint8_t x )
 */
 
 
-void lcd_send_command(uint8_t command, const uint8_t *dataBytes, uint32_t numDataBytes)
-{
+/*
+  the transports. a command leaves D/CX high, so the data or pixels that follow
+  don't have to touch it. they only differ in how pixels go out,
+    8bit    two 8 bit spi_send() per pixel
+    polled  16 bit frames, one spi_send() per pixel
+    dma     16 bit frames, and dma for runs of LCD_DMA_MIN or more
+*/
 
+static void spi_command(uint8_t command)
+{
   wait_for_transfer_finish();
+  lcd_spi_frame16(false);
   lcd_spi_assert_command();
   lcd_spi_send8(command);
 
   wait_for_transfer_finish();
   lcd_spi_assert_data();
-  for(unsigned i = 0; i < numDataBytes; ++i) {
-    lcd_spi_send8(dataBytes[ i ]);
-  }
+}
 
+
+static void spi_data(const uint8_t *data, uint32_t n)
+{
+  lcd_spi_frame16(false);
+  for(unsigned i = 0; i < n; ++i) {
+    lcd_spi_send8(data[ i ]);
+  }
 }
 
 
-void lcd_send_command_repeat(uint8_t command, uint16_t x, uint32_t n )
+static void spi8_pixels(const uint16_t *pixels, uint32_t n)
 {
-  // n is *not* bytes, but number of 16bit elements
+  lcd_spi_frame16(false);
+  for(unsigned i = 0; i < n; ++i) {
+    lcd_spi_send8( pixels[i] >> 8 );
+    lcd_spi_send8( pixels[i] & 0xFF );
+  }
+}
 
-  wait_for_transfer_finish();
-  lcd_spi_assert_command();
-  lcd_spi_send8(command);
 
-  wait_for_transfer_finish();
-  lcd_spi_assert_data();
+static void spi8_fill(uint16_t x, uint32_t n)
+{
+  lcd_spi_frame16(false);
   for(unsigned i = 0; i < n; ++i) {
     lcd_spi_send8( x >> 8 );
     lcd_spi_send8( x & 0xFF );
   }
+}
+
+
+// whole pixels. msb first, so same byte order on the wire as 8 bit.
+// we stay in 16 bit, until the next command needs 8 bit again.
+static void spi16_pixels(const uint16_t *pixels, uint32_t n)
+{
+  lcd_spi_frame16(true);
+  for(unsigned i = 0; i < n; ++i) {
+    spi_send( LCD_SPI, pixels[i] );
+  }
+}
+
+
+static void spi16_fill(uint16_t x, uint32_t n)
+{
+  lcd_spi_frame16(true);
+  for(unsigned i = 0; i < n; ++i) {
+    spi_send( LCD_SPI, x );
+  }
+}
+
+
+static void spidma_pixels(const uint16_t *pixels, uint32_t n)
+{
+  if(n < LCD_DMA_MIN) {
+    spi16_pixels(pixels, n);
+    return;
+  }
+  lcd_spi_frame16(true);
+  lcd_spi_send_dma(pixels, n, true);
+}
+
 
+static void spidma_fill(uint16_t x, uint32_t n)
+{
+  if(n < LCD_DMA_MIN) {
+    spi16_fill(x, n);
+    return;
+  }
+  lcd_spi_frame16(true);
+  fill_color = x;
+  lcd_spi_send_dma(&fill_color, n, false);
 }
 
 
+const struct lcd_transport lcd_spi_8bit = {
+  .command  = spi_command,
+  .data     = spi_data,
+  .pixels   = spi8_pixels,
+  .fill     = spi8_fill,
+  .wait     = wait_for_transfer_finish,
+};
+
+const struct lcd_transport lcd_spi_polled = {
+  .command  = spi_command,
+  .data     = spi_data,
+  .pixels   = spi16_pixels,
+  .fill     = spi16_fill,
+  .wait     = wait_for_transfer_finish,
+};
+
+const struct lcd_transport lcd_spi_dma = {
+  .command  = spi_command,
+  .data     = spi_data,
+  .pixels   = spidma_pixels,
+  .fill     = spidma_fill,
+  .wait     = wait_for_transfer_finish,
+};
+
@@ -1,5 +1,7 @@
 
 
+#include "lcd_driver.h"
+
 // low-level spi primitives, that hide underlying stm32 spi details.
 
 void lcd_spi_setup( void );
@@ -16,11 +18,8 @@ void lcd_spi_enable(void);
 void lcd_spi_disable(void);
 
 
-void lcd_send_command(uint8_t command, const uint8_t *dataBytes, uint32_t numDataBytes);
-
-
-void lcd_send_command_repeat(uint8_t command, uint16_t x, uint32_t n );
-
-
-
-
+// spi transports for lcd_driver.h, that differ in how pixels are pushed.
+// 8 bit frames, 16 bit frames polled, and 16 bit frames with dma for longer runs
+extern const struct lcd_transport lcd_spi_8bit;
+extern const struct lcd_transport lcd_spi_polled;
+extern const struct lcd_transport lcd_spi_dma;
@@ -0,0 +1,173 @@
+/*
+  host benchmark of writeLine(), make HOST=1 && ./lines-bench.host
+
+  the host side of bench() in main.c. random lines per second, the old per-pixel
+  bresenham (ref_writeLine, as gfx.c had it) against the runs writeLine() draws now.
+  timed on the null transport, so it is the cost of gfx and the driver alone, as the
+  "null" row on the board. then the bytes per line that go out on the SPI port.
+
+  two sets of lines. "screen" are the ones bench() draws, both ends on the screen.
+  "clipped" have their ends anywhere up to a screen away, so most are partly off it.
+  every line is also drawn both ways on the panel model, and has to come out the same.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libopencm3/stm32/spi.h>
+
+#include "host.h"
+
+#include "clock.h"
+#include "Adafruit_ILI9341.h"
+#include "lcd_spi.h"
+#include "context.h"
+#include "gfx.h"
+
+
+#define LINES   1000
+#define REPEAT  5       // timed best of this many
+#define CHUNK   50      // lines drawn between compares
+
+
+static Context ctx;
+static struct lcd lcd;
+
+
+// writeLine() as it was, one writePixel() per pixel
+static void ref_writeLine(Context *c, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+  int16_t steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    int16_t t = x0; x0 = y0; y0 = t;
+    t = x1; x1 = y1; y1 = t;
+  }
+  if (x0 > x1) {
+    int16_t t = x0; x0 = x1; x1 = t;
+    t = y0; y0 = y1; y1 = t;
+  }
+
+  int16_t dx = x1 - x0;
+  int16_t dy = abs(y1 - y0);
+  int16_t err = dx / 2;
+  int16_t ystep = y0 < y1 ? 1 : -1;
+
+  for (; x0 <= x1; x0++) {
+    if (steep)
+      writePixel(c, y0, x0, color);
+    else
+      writePixel(c, x0, y0, color);
+    err -= dy;
+    if (err < 0) {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+}
+
+
+static int16_t lines[LINES][4];
+
+// the same generator as bench(), 'margin' is how far off the screen the ends can go
+static void make_lines(int16_t margin)
+{
+  uint32_t seed = 12345;
+
+  for (unsigned k = 0; k < LINES; ++k) {
+    for (unsigned j = 0; j < 4; ++j) {
+      int16_t n = j & 1 ? ctx.height : ctx.width;
+      seed = seed * 1103515245 + 12345;
+      lines[k][j] = (int16_t)((seed >> 16) % (n + 2 * margin)) - margin;
+    }
+  }
+}
+
+
+typedef void (*line_fn)(Context *, int16_t, int16_t, int16_t, int16_t, uint16_t);
+
+static void draw(line_fn line, unsigned from, unsigned to)
+{
+  for (unsigned k = from; k < to; ++k)
+    line(&ctx, lines[k][0], lines[k][1], lines[k][2], lines[k][3], 0x1000 + k * 37);
+}
+
+
+// lines per second on the null transport
+static double rate(line_fn line)
+{
+  clock_t best = 0;
+
+  lcd_set_transport(ctx.lcd, &lcd_null);
+  for (unsigned r = 0; r < REPEAT; ++r) {
+    clock_t t = clock();
+    draw(line, 0, LINES);
+    t = clock() - t;
+    best = (r == 0 || t < best) ? t : best;
+  }
+  return (double) LINES * CLOCKS_PER_SEC / (best ? best : 1);
+}
+
+
+// spi bytes per line on the panel model
+static double bytes(line_fn line)
+{
+  lcd_set_transport(ctx.lcd, &lcd_spi_polled);
+  fillScreen(&ctx, ILI9341_BLACK);
+  uint64_t start = host_stats.spi[SPI1].bytes;
+  draw(line, 0, LINES);
+  return (double)(host_stats.spi[SPI1].bytes - start) / LINES;
+}
+
+
+// number of CHUNKs of lines that don't come out the same both ways
+static int compare(void)
+{
+  static uint16_t ref[ILI9341_TFTWIDTH * ILI9341_TFTHEIGHT];
+  int differ = 0;
+
+  lcd_set_transport(ctx.lcd, &lcd_spi_polled);
+  for (unsigned k = 0; k < LINES; k += CHUNK) {
+    fillScreen(&ctx, ILI9341_BLACK);
+    draw(ref_writeLine, k, k + CHUNK);
+    memcpy(ref, host_panel_frame(), sizeof(ref));
+    fillScreen(&ctx, ILI9341_BLACK);
+    draw(writeLine, k, k + CHUNK);
+    if (memcmp(ref, host_panel_frame(), sizeof(ref)))
+      ++differ;
+  }
+  return differ;
+}
+
+
+int main(void)
+{
+  static const struct { const char *name; int16_t margin; } sets[] = {
+    { "screen", 0 },
+    { "clipped", 320 },
+  };
+  int failed = 0;
+
+  host_no_limits();
+  clock_setup();
+  lcd_spi_setup();
+  initialize(&ctx, &lcd, &lcd_spi_polled);
+  ILI9341_setRotation(&ctx, 3);   // as main.c
+
+  printf("%-8s %14s %14s %14s %14s\n", "", "old lines/s", "new lines/s", "old bytes/line", "new bytes/line");
+  for (unsigned i = 0; i < sizeof(sets) / sizeof(sets[0]); ++i) {
+    make_lines(sets[i].margin);
+    double ref_rate = rate(ref_writeLine), new_rate = rate(writeLine);
+    double ref_bytes = bytes(ref_writeLine), new_bytes = bytes(writeLine);
+    int differ = compare();
+
+    printf("%-8s %14.0f %14.0f %14.0f %14.0f", sets[i].name, ref_rate, new_rate, ref_bytes, new_bytes);
+    if (differ) {
+      printf(", %d of %d groups of %d lines differ", differ, LINES / CHUNK, CHUNK);
+      failed = 1;
+    }
+    printf("\n");
+  }
+  return failed;
+}
@@ -4,6 +4,7 @@
 #include <libopencm3/stm32/spi.h>
 #include <libopencm3/stm32/rcc.h>
 #include <libopencm3/stm32/gpio.h>
+#include <libopencm3/cm3/dwt.h>
 
 #include "clock.h"
 #include "Adafruit_ILI9341.h"
@@ -14,6 +15,12 @@
 #include "context.h"
 #include "gfx.h"
 
+// fonts are made for the arduino, where PROGMEM puts them in flash. here they are there anyway
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#include "Adafruit-GFX-Library/Fonts/FreeSans9pt7b.h"
+
 
 
 
@@ -35,11 +42,83 @@ static void led_setup(void)
 
 
 
-static void drawText(Context *ctx, const char *s)
+static void drawNumber(Context *ctx, uint32_t v)
+{
+  char buf[11];
+  char *p = buf + sizeof(buf);
+  *--p = 0;
+  do {
+    *--p = '0' + v % 10;
+    v /= 10;
+  } while(v);
+  writeString(ctx, p);
+}
+
+
+
+/*
+  cycle count for each transport - see lcd_spi.c.
+  fillScreen, a line of text, and 100 random lines (lines/sec = 100 * 168000000 / cycles).
+  no uart on this board, so results are just drawn on the screen.
+  cycles are at 168MHz. so divide by 168 for usec.
+
+  text is drawn transparent at size 1, so every pixel is its own 1x1 rect.
+  which is mostly command overhead and too short for dma. so 16bit and dma should be about the same.
+
+  the null transport sends nothing, so it is the cost of gfx and the driver alone.
+  what it would have sent is left in lcd_null_stats.
+*/
+static void bench(Context *ctx)
 {
-  while(*s) {
-    write(ctx, *s);     // This won't work very well with printf if have to pass a context...
-    ++s;
+  static const struct lcd_transport *modes[] = { &lcd_spi_8bit, &lcd_spi_polled, &lcd_null, &lcd_spi_dma };
+  static const char *names[] = { "8bit", "16bit", "null", "dma" };
+  uint32_t fill[4], text[4], lines[4];
+
+  dwt_enable_cycle_counter();
+
+  for(unsigned i = 0; i < 4; ++i) {
+    lcd_set_transport(ctx->lcd, modes[i]);
+
+    uint32_t t = dwt_read_cycle_counter();
+    fillScreen(ctx, ILI9341_BLACK);
+    fill[i] = dwt_read_cycle_counter() - t;
+
+    setTextColor(ctx, ILI9341_WHITE);
+    setTextSize(ctx, 1, 1);
+    setCursor(ctx, 0, 0);
+    t = dwt_read_cycle_counter();
+    writeString(ctx, "The quick brown fox jumps over the lazy dog 0123456789");
+    text[i] = dwt_read_cycle_counter() - t;
+
+    // 100 random lines. same seed each mode, so the same lines
+    uint32_t seed = 12345;
+    t = dwt_read_cycle_counter();
+    for(unsigned k = 0; k < 100; ++k) {
+      int16_t c[4];
+      for(unsigned j = 0; j < 4; ++j) {
+        seed = seed * 1103515245 + 12345;
+        c[j] = (seed >> 16) % (j & 1 ? ctx->height : ctx->width);
+      }
+      writeLine(ctx, c[0], c[1], c[2], c[3], ILI9341_YELLOW);
+    }
+    lines[i] = dwt_read_cycle_counter() - t;
+  }
+
+  fillScreen(ctx, ILI9341_WHITE);
+  setTextColor(ctx, ILI9341_BLACK);
+  setTextSize(ctx, 2, 2);
+
+  for(unsigned i = 0; i < 4; ++i) {
+    setCursor(ctx, 10, 10 + i * 58);
+    writeString(ctx, names[i]);
+    writeString(ctx, " fill ");
+    drawNumber(ctx, fill[i]);
+    setCursor(ctx, 10, 10 + i * 58 + 18);
+    writeString(ctx, "text ");
+    drawNumber(ctx, text[i]);
+    setCursor(ctx, 10, 10 + i * 58 + 36);
+    writeString(ctx, "lines ");
+    drawNumber(ctx, lines[i]);
   }
 }
 
@@ -53,6 +132,7 @@ int main(void)
   rcc_periph_clock_enable(RCC_SPI1);
   rcc_periph_clock_enable(RCC_GPIOA);
   rcc_periph_clock_enable(RCC_GPIOB);
+  rcc_periph_clock_enable(RCC_DMA2);
 
   clock_setup();
   led_setup();
@@ -63,12 +143,18 @@ int main(void)
 
 
   Context   ctx;
+  static struct lcd lcd;
 
   // low level
-  initialize(&ctx);
+  initialize(&ctx, &lcd, &lcd_spi_dma);
   ILI9341_setRotation(&ctx, 3); // 0 == trhs, 1 == brhs, 2 == blhs,  3 == tlhs
 
 
+  // how long does it take. leaves dma as the transport
+  bench(&ctx);
+  msleep(5000);
+
+
   // gfx
   fillScreen(&ctx, ILI9341_WHITE );
   fillRect(&ctx, 20, 20, 40, 20, ILI9341_RED );
@@ -91,9 +177,21 @@ int main(void)
   setTextSize(&ctx, 0.3, 0.3);
 
   // ok. this will actually wrap correctly...
-  drawText(&ctx, "hi there friends all  ");
+  writeString(&ctx, "hi there friends all  ");
+
+  writeString(&ctx, "77.123");
+
+  // proportional text. no background with these, so clear its box first
+  int16_t bx, by;
+  uint16_t bw, bh;
 
-  drawText(&ctx, "77.123");
+  setFont(&ctx, &FreeSans9pt7b);
+  getTextBounds(&ctx, "Proportional 9pt", 60, 200, &bx, &by, &bw, &bh);
+  fillRect(&ctx, bx - 4, by - 4, bw + 8, bh + 8, ILI9341_YELLOW);
+  setTextColor(&ctx, ILI9341_BLACK);
+  setCursor(&ctx, 60, 200);
+  writeString(&ctx, "Proportional 9pt");
+  setFont(&ctx, NULL);
 
   // int u = ILI9341_BLACK;
   // blink led
@@ -0,0 +1,151 @@
+/*
+  the panel independent half of lcd_driver.h. nothing here touches hardware,
+  so it builds for the host as well, eg. against the null transport.
+*/
+
+#include "lcd_driver.h"
+
+
+void lcd_init(struct lcd *lcd, const struct lcd_driver *driver, const struct lcd_transport *bus,
+              void (*delay)(uint32_t ms))
+{
+  lcd->driver = driver;
+  lcd->bus = bus;
+  lcd->delay = delay;
+  lcd->width = driver->width;
+  lcd->height = driver->height;
+  lcd->rotation = 0;
+  lcd->wx = lcd->wy = lcd->cx = lcd->cy = 0;
+  lcd->ww = driver->width;
+  lcd->wh = driver->height;
+
+  driver->init(lcd);
+}
+
+
+void lcd_set_transport(struct lcd *lcd, const struct lcd_transport *bus)
+{
+  lcd_wait(lcd);
+  lcd->bus = bus;
+}
+
+
+void lcd_wait(struct lcd *lcd)
+{
+  if(lcd->bus->wait)
+    lcd->bus->wait();
+}
+
+
+void lcd_command(struct lcd *lcd, uint8_t cmd, const uint8_t *data, uint32_t n)
+{
+  lcd->bus->command(cmd);
+  if(n)
+    lcd->bus->data(data, n);
+}
+
+
+void lcd_run_script(struct lcd *lcd, const uint8_t *script)
+{
+  uint8_t cmd, x, n;
+
+  while((cmd = *script++) > 0) {
+    x = *script++;
+    n = x & 0x7F;
+    lcd_command(lcd, cmd, script, n);
+    script += n;
+    if((x & 0x80) && lcd->delay)
+      lcd->delay(150);
+  }
+}
+
+
+void lcd_fill_rect(struct lcd *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+  lcd->driver->set_window(lcd, x, y, w, h);
+  lcd->driver->fill(lcd, color, (uint32_t) w * h);
+}
+
+
+void lcd_write_rect(struct lcd *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels)
+{
+  lcd->driver->set_window(lcd, x, y, w, h);
+  lcd->driver->push_pixels(lcd, pixels, (uint32_t) w * h);
+}
+
+
+
+void lcd_bus_push_pixels(struct lcd *lcd, const uint16_t *pixels, uint32_t n)
+{
+  lcd->bus->pixels(pixels, n);
+}
+
+
+void lcd_bus_fill(struct lcd *lcd, uint16_t color, uint32_t n)
+{
+  lcd->bus->fill(color, n);
+}
+
+
+void lcd_bus_flush_region(struct lcd *lcd, const uint16_t *fb, uint16_t stride,
+                          uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  const uint16_t *p;
+
+  // nothing kept on this side to send
+  if(!fb)
+    return;
+
+  p = fb + (uint32_t) y * stride + x;
+
+  lcd->driver->set_window(lcd, x, y, w, h);
+
+  // whole rows are contiguous, so one burst. otherwise a row at a time, the window wraps them
+  if(w == stride) {
+    lcd->driver->push_pixels(lcd, p, (uint32_t) w * h);
+    return;
+  }
+  for(uint16_t j = 0; j < h; ++j, p += stride)
+    lcd->driver->push_pixels(lcd, p, w);
+}
+
+
+
+////////////////////////////////
+
+struct lcd_null_stats lcd_null_stats;
+
+static void null_command(uint8_t cmd)
+{
+  (void) cmd;
+  ++lcd_null_stats.commands;
+}
+
+static void null_data(const uint8_t *data, uint32_t n)
+{
+  (void) data;
+  lcd_null_stats.bytes += n;
+}
+
+static void null_pixels(const uint16_t *pixels, uint32_t n)
+{
+  (void) pixels;
+  lcd_null_stats.bytes += n * 2;
+  lcd_null_stats.pixels += n;
+}
+
+static void null_fill(uint16_t color, uint32_t n)
+{
+  (void) color;
+  lcd_null_stats.bytes += n * 2;
+  lcd_null_stats.pixels += n;
+}
+
+const struct lcd_transport lcd_null = {
+  .command  = null_command,
+  .data     = null_data,
+  .pixels   = null_pixels,
+  .fill     = null_fill,
+  .wait     = NULL,
+};
+
@@ -0,0 +1,116 @@
+/*
+  ili9486, 320x480. same command set as the ili9341 for the window and rotation,
+  different power and gamma setup.
+
+  https://www.waveshare.com/w/upload/7/78/ILI9486_Datasheet.pdf
+  https://github.com/ImpulseAdventure/Waveshare_ILI9486/blob/master/src/Waveshare_ILI9486.cpp
+*/
+
+#include "lcd_driver.h"
+#include "lcd_ili9486.h"
+
+
+#define ILI9486_WIDTH   320
+#define ILI9486_HEIGHT  480
+
+#define ILI9486_CASET   0x2A
+#define ILI9486_PASET   0x2B
+#define ILI9486_RAMWR   0x2C
+#define ILI9486_MADCTL  0x36
+
+#define MADCTL_MY 0x80  ///< Bottom to top
+#define MADCTL_MX 0x40  ///< Right to left
+#define MADCTL_MV 0x20  ///< Reverse Mode
+#define MADCTL_BGR 0x08 ///< Blue-Green-Red pixel order
+
+
+// clang-format off
+static const uint8_t initcmd[] = {
+  //  Power control settings
+  0xC0, 2, 0x19, 0x1a,
+  0xC1, 2, 0x45, 0x00,
+  0xC2, 1, 0x33,                          //  Power/Reset on default
+  0xC5, 2, 0x00, 0x28,                    //  VCOM control
+  0xB1, 2, 0xA0, 0x11,                    //  Frame rate control
+  0xB4, 1, 0x02,                          //  Display Z Inversion
+  0xB6, 3, 0x00, 0x42, 0x3B,              //  Display Control Function
+  0xE0, 15, 0x1F, 0x25, 0x22, 0x0B, 0x06, //  Positive Gamma control
+    0x0A, 0x4E, 0xC6, 0x39, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0xE1, 15, 0x1F, 0x3F, 0x3F, 0x0F, 0x1F, //  Negative Gamma control
+    0x0F, 0x46, 0x49, 0x31, 0x05, 0x09, 0x03, 0x1C, 0x1A, 0x00,
+#if 0
+  //  From original driver, but register numbers don't make any sense.
+  0xF1, 8, 0x36, 0x04, 0x00, 0x3C, 0x0F, 0x0F, 0xA4, 0x02,
+  0xF2, 9, 0x18, 0xA3, 0x12, 0x02, 0x32, 0x12, 0xFF, 0x32, 0x00,
+  0xF4, 5, 0x40, 0x00, 0x08, 0x91, 0x04,
+  0xF8, 2, 0x21, 0x04,
+#endif
+  0x3A, 1, 0x55,                          //  16 bit pixels
+  //  Set initial rotation to match AFX defaults - tall / narrow
+  0xB6, 2, 0x00, 0x22,
+  ILI9486_MADCTL, 1, MADCTL_BGR,
+  0x11, 0x80,                             //  Sleep out
+  0x29, 0,                                //  Turn on display
+  0x00                                    //  End of list
+};
+// clang-format on
+
+
+static const uint8_t madctl[4] = {
+  MADCTL_BGR,
+  MADCTL_MX | MADCTL_MV | MADCTL_BGR,
+  MADCTL_MX | MADCTL_MY | MADCTL_BGR,
+  MADCTL_MY | MADCTL_MV | MADCTL_BGR,
+};
+
+
+
+static void ili9486_init(struct lcd *lcd)
+{
+  lcd_run_script(lcd, initcmd);
+}
+
+
+static void ili9486_set_window(struct lcd *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  uint16_t x1 = x + w - 1;
+  uint16_t y1 = y + h - 1;
+
+  {
+    uint8_t data[] = { x >> 8, x & 0xFF, x1 >> 8, x1 & 0xFF };
+    lcd_command(lcd, ILI9486_CASET, data, sizeof(data) );
+  }
+  {
+    uint8_t data[] = { y >> 8, y & 0xFF, y1 >> 8, y1 & 0xFF };
+    lcd_command(lcd, ILI9486_PASET, data, sizeof(data) );
+  }
+  lcd_command(lcd, ILI9486_RAMWR, NULL, 0);
+}
+
+
+static void ili9486_set_rotation(struct lcd *lcd, uint8_t r)
+{
+  lcd->rotation = r % 4;
+  if(lcd->rotation & 1) {
+    lcd->width = ILI9486_HEIGHT;
+    lcd->height = ILI9486_WIDTH;
+  } else {
+    lcd->width = ILI9486_WIDTH;
+    lcd->height = ILI9486_HEIGHT;
+  }
+  lcd_command(lcd, ILI9486_MADCTL, &madctl[lcd->rotation], 1);
+}
+
+
+const struct lcd_driver lcd_ili9486 = {
+  .name         = "ili9486",
+  .width        = ILI9486_WIDTH,
+  .height       = ILI9486_HEIGHT,
+  .init         = ili9486_init,
+  .set_window   = ili9486_set_window,
+  .push_pixels  = lcd_bus_push_pixels,
+  .fill         = lcd_bus_fill,
+  .flush_region = lcd_bus_flush_region,
+  .set_rotation = ili9486_set_rotation,
+};
+
@@ -0,0 +1,9 @@
+#ifndef LCD_ILI9486_H
+#define LCD_ILI9486_H
+
+#include "lcd_driver.h"
+
+// needs a transport with pixels and fill. reset is up to the board
+extern const struct lcd_driver lcd_ili9486;
+
+#endif
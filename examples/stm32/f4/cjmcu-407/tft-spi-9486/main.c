@@ -130,6 +130,7 @@ spi2
 #include <libopencm3/stm32/gpio.h>
 
 #include "clock.h"
+#include "lcd_ili9486.h"
 
 // GPIOB
 #define LCD_NSS   GPIO12 // not AF
@@ -178,7 +179,13 @@ static inline void endWrite(void)
 	gpio_set(GPIOB, LCD_NSS);	// deslect, pull high
  }
 
-static inline void lcdWriteReg(uint8_t reg)
+/*
+  transport for lcd_driver.h. the shield has a 16 bit bus behind the spi, so
+  every command or parameter byte goes out as a 16 bit word with a zero high byte,
+  and a pixel is one whole word.
+*/
+
+static void spi_command(uint8_t reg)
  {
 #if 0
   digitalWrite(LCD_DC, LOW);
@@ -191,37 +198,43 @@ static inline void lcdWriteReg(uint8_t reg)
 	(void) spi_xfer(LCD_SPI, reg );
  }
 
-static inline void lcdWriteData(uint8_t data)
+static void spi_data(const uint8_t *data, uint32_t n)
  {
-#if 0
-  digitalWrite(LCD_DC, HIGH);
-  SPI.transfer(0);
-  SPI.transfer(data);
-#endif
   gpio_set(GPIOE, LCD_RS);	/* Set the D/CX pin */
+  while(n--) {
 	(void) spi_xfer(LCD_SPI, 0 );
-	(void) spi_xfer(LCD_SPI, data );
+	(void) spi_xfer(LCD_SPI, *data++ );
+  }
  }
 
-static inline void lcdWriteDataContinue(uint8_t data)
+static void spi_pixels(const uint16_t *pixels, uint32_t n)
  {
-  // eg. no change of RS
-	(void) spi_xfer(LCD_SPI, 0 );
-	(void) spi_xfer(LCD_SPI, data );
+  gpio_set(GPIOE, LCD_RS);
+  while(n--) {
+	(void) spi_xfer(LCD_SPI, *pixels >> 8 );
+	(void) spi_xfer(LCD_SPI, *pixels & 0xFF );
+	++pixels;
+  }
  }
 
-static inline void lcdWriteCommand(uint8_t reg, uint8_t data)
+static void spi_fill(uint16_t color, uint32_t n)
  {
-  lcdWriteReg(reg);
-  lcdWriteData(data);
+  gpio_set(GPIOE, LCD_RS);
+  while(n--) {
+	(void) spi_xfer(LCD_SPI, color >> 8 );
+	(void) spi_xfer(LCD_SPI, color & 0xFF );
+  }
  }
 
-static inline void lcdWriteCommand2(uint8_t reg, uint8_t data, uint8_t data2)
- {
-  lcdWriteReg(reg);
-  lcdWriteData(data);
-  lcdWriteDataContinue(data2);
- }
+static const struct lcd_transport lcd_spi16 = {
+  .command  = spi_command,
+  .data     = spi_data,
+  .pixels   = spi_pixels,
+  .fill     = spi_fill,
+  .wait     = NULL,
+};
+
+static struct lcd lcd;
 
 
 
@@ -252,112 +265,9 @@ static void initializeLcd(void)
   msleep(65);  // milli
 
 
+  // init script, power, gamma and rotation, see lcd_ili9486.c
   startWrite();
-
-{
-   //  Power control settings
-   lcdWriteCommand2(0xC0, 0x19, 0x1a);
-   lcdWriteCommand2(0xC1, 0x45, 0x00);
-   lcdWriteCommand(0xC2, 0x33);        //  Power/Reset on default
-
-   lcdWriteCommand2(0xC5, 0x00, 0x28);  //  VCOM control
-
-   lcdWriteCommand2(0xB1, 0xA0, 0x11);  //  Frame rate control
-
-   lcdWriteCommand(0xB4, 0x02);        //  Display Z Inversion
-
-   lcdWriteReg(0xB6);                  //  Display Control Function
-   lcdWriteData(0x00);
-   lcdWriteDataContinue(0x42);
-   lcdWriteDataContinue(0x3B);
-
-   lcdWriteReg(0xE0);                  //  Positive Gamma control
-   lcdWriteData(0x1F);
-   lcdWriteDataContinue(0x25);
-   lcdWriteDataContinue(0x22);
-   lcdWriteDataContinue(0x0B);
-   lcdWriteDataContinue(0x06);
-   lcdWriteDataContinue(0x0A);
-   lcdWriteDataContinue(0x4E);
-   lcdWriteDataContinue(0xC6);
-   lcdWriteDataContinue(0x39);
-   lcdWriteDataContinue(0x00);
-   lcdWriteDataContinue(0x00);
-   lcdWriteDataContinue(0x00);
-   lcdWriteDataContinue(0x00);
-   lcdWriteDataContinue(0x00);
-   lcdWriteDataContinue(0x00);
-
-   lcdWriteReg(0XE1);                  //  Negative Gamma control
-   lcdWriteData(0x1F);
-   lcdWriteDataContinue(0x3F);
-   lcdWriteDataContinue(0x3F);
-   lcdWriteDataContinue(0x0F);
-   lcdWriteDataContinue(0x1F);
-   lcdWriteDataContinue(0x0F);
-   lcdWriteDataContinue(0x46);
-   lcdWriteDataContinue(0x49);
-   lcdWriteDataContinue(0x31);
-   lcdWriteDataContinue(0x05);
-   lcdWriteDataContinue(0x09);
-   lcdWriteDataContinue(0x03);
-   lcdWriteDataContinue(0x1C);
-   lcdWriteDataContinue(0x1A);
-   lcdWriteDataContinue(0x00);
-
-   //  From original driver, but register numbers don't make any sense.
-   if (0)
-   {
-    lcdWriteReg(0XF1);
-    lcdWriteData(0x36);
-    lcdWriteDataContinue(0x04);
-    lcdWriteDataContinue(0x00);
-    lcdWriteDataContinue(0x3C);
-    lcdWriteDataContinue(0x0F);
-    lcdWriteDataContinue(0x0F);
-    lcdWriteDataContinue(0xA4);
-    lcdWriteDataContinue(0x02);
-
-    lcdWriteReg(0XF2);
-    lcdWriteData(0x18);
-    lcdWriteDataContinue(0xA3);
-    lcdWriteDataContinue(0x12);
-    lcdWriteDataContinue(0x02);
-    lcdWriteDataContinue(0x32);
-    lcdWriteDataContinue(0x12);
-    lcdWriteDataContinue(0xFF);
-    lcdWriteDataContinue(0x32);
-    lcdWriteDataContinue(0x00);
-
-    lcdWriteReg(0XF4);
-    lcdWriteData(0x40);
-    lcdWriteDataContinue(0x00);
-    lcdWriteDataContinue(0x08);
-    lcdWriteDataContinue(0x91);
-    lcdWriteDataContinue(0x04);
-
-    lcdWriteReg(0XF8);
-    lcdWriteData(0x21);
-    lcdWriteDataContinue(0x04);
-   }
-
-   lcdWriteCommand(0x3A, 0x55);
-
-   //  Set initial rotation to match AFX defaults - tall / narrow
-   lcdWriteCommand2(0xB6, 0x00, 0x22);
-   lcdWriteCommand(0x36, 0x08);
-
-   lcdWriteReg(0x11); // Sleep out
-
-/*
-
-    JA
-   //  Fill screen to black
-   writeFillRect2(0, 0, LCD_WIDTH, LCD_HEIGHT, 0x0000);
-*/
-
-   lcdWriteReg(0x29);  // Turn on display
-  }
+  lcd_init(&lcd, &lcd_ili9486, &lcd_spi16, msleep);
   endWrite();
  }
 
@@ -366,7 +276,7 @@ static void invertDisplay(bool i)
  {
   startWrite();
   {
-   lcdWriteReg(i ? 0x21 : 0x20);
+   lcd_command(&lcd, i ? 0x21 : 0x20, NULL, 0);
   }
   endWrite();
  }
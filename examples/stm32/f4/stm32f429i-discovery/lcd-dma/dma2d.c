@@ -0,0 +1,224 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A queue of DMA2D operations (see dma2d.h).
+ *
+ * Each operation is kept as the values for the engine's registers, so
+ * starting one is just storing them. The queue is a ring, 'q_head' is
+ * the operation the engine is working on and 'q_tail' the next free
+ * slot. When an operation completes the interrupt handler starts the
+ * next one, so the CPU only gets involved once per rectangle.
+ */
+#include <stdint.h>
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/cm3/nvic.h>
+#include "dma2d.h"
+
+/* The registers (RM0090, section 11.5) */
+#ifndef DMA2D_BASE
+#define DMA2D_BASE	0x4002B000U
+#endif
+#define DMA2D_REG(off)	(*(volatile uint32_t *)(DMA2D_BASE + (off)))
+#define DMA2D_CR	DMA2D_REG(0x00)
+#define DMA2D_IFCR	DMA2D_REG(0x08)
+#define DMA2D_FGMAR	DMA2D_REG(0x0c)
+#define DMA2D_FGOR	DMA2D_REG(0x10)
+#define DMA2D_BGMAR	DMA2D_REG(0x14)
+#define DMA2D_BGOR	DMA2D_REG(0x18)
+#define DMA2D_FGPFCCR	DMA2D_REG(0x1c)
+#define DMA2D_BGPFCCR	DMA2D_REG(0x24)
+#define DMA2D_OPFCCR	DMA2D_REG(0x34)
+#define DMA2D_OCOLR	DMA2D_REG(0x38)
+#define DMA2D_OMAR	DMA2D_REG(0x3c)
+#define DMA2D_OOR	DMA2D_REG(0x40)
+#define DMA2D_NLR	DMA2D_REG(0x44)
+
+#define DMA2D_CR_START		(1 << 0)
+#define DMA2D_CR_TEIE		(1 << 8)
+#define DMA2D_CR_TCIE		(1 << 9)
+#define DMA2D_CR_CEIE		(1 << 13)
+#define DMA2D_CR_M2M		(0 << 16)
+#define DMA2D_CR_M2M_PFC	(1 << 16)
+#define DMA2D_CR_M2M_BLEND	(2 << 16)
+#define DMA2D_CR_R2M		(3 << 16)
+#define DMA2D_IFCR_ALL		0x3f
+
+/* multiply the alpha of each pixel by the one in bits 31:24 */
+#define DMA2D_PFCCR_AM_MULTIPLY	(2 << 16)
+
+struct dma2d_op {
+	uint32_t	cr;
+	uint32_t	fgmar, fgor, fgpfccr;
+	uint32_t	bgmar, bgor, bgpfccr;
+	uint32_t	opfccr, ocolr, omar, oor, nlr;
+};
+
+static struct dma2d_op		queue[DMA2D_QUEUE];
+static volatile uint8_t		q_head, q_tail;
+volatile int			dma2d_running;
+
+static void
+dma2d_start(const struct dma2d_op *op)
+{
+	DMA2D_FGMAR = op->fgmar;
+	DMA2D_FGOR = op->fgor;
+	DMA2D_FGPFCCR = op->fgpfccr;
+	DMA2D_BGMAR = op->bgmar;
+	DMA2D_BGOR = op->bgor;
+	DMA2D_BGPFCCR = op->bgpfccr;
+	DMA2D_OPFCCR = op->opfccr;
+	DMA2D_OCOLR = op->ocolr;
+	DMA2D_OMAR = op->omar;
+	DMA2D_OOR = op->oor;
+	DMA2D_NLR = op->nlr;
+	DMA2D_CR = op->cr | DMA2D_CR_TCIE | DMA2D_CR_TEIE | DMA2D_CR_CEIE |
+		   DMA2D_CR_START;
+}
+
+/*
+ * Put an operation on the queue, and start it if the engine has
+ * nothing to do. When the queue is full this waits for the engine to
+ * finish one.
+ */
+static void
+dma2d_submit(const struct dma2d_op *op)
+{
+	uint8_t	next = (q_tail + 1) % DMA2D_QUEUE;
+
+	while (next == q_head);
+	queue[q_tail] = *op;
+
+	nvic_disable_irq(NVIC_DMA2D_IRQ);
+	q_tail = next;
+	if (!dma2d_running) {
+		dma2d_running = 1;
+		dma2d_start(&queue[q_head]);
+	}
+	nvic_enable_irq(NVIC_DMA2D_IRQ);
+}
+
+/*
+ * An operation is done (or it was refused, a transfer or
+ * configuration error ends it just the same), start the next one.
+ */
+void
+dma2d_isr(void)
+{
+	DMA2D_IFCR = DMA2D_IFCR_ALL;
+	q_head = (q_head + 1) % DMA2D_QUEUE;
+	if (q_head != q_tail) {
+		dma2d_start(&queue[q_head]);
+	} else {
+		dma2d_running = 0;
+	}
+}
+
+void
+dma2d_init(void)
+{
+	rcc_periph_clock_enable(RCC_DMA2D);
+	q_head = q_tail = 0;
+	dma2d_running = 0;
+	nvic_enable_irq(NVIC_DMA2D_IRQ);
+}
+
+/* Fill a rectangle with 'color', given in the output format */
+void
+dma2d_fill(void *dst, int stride, int w, int h, uint8_t format,
+	   uint32_t color)
+{
+	struct dma2d_op	op = {
+		.cr = DMA2D_CR_R2M,
+		.opfccr = format,
+		.ocolr = color,
+		.omar = (uint32_t) dst,
+		.oor = stride - w,
+		.nlr = ((uint32_t) w << 16) | h,
+	};
+
+	dma2d_submit(&op);
+}
+
+/* Copy a rectangle of pixels, both sides in the same format */
+void
+dma2d_copy(void *dst, int dst_stride, const void *src, int src_stride,
+	   int w, int h, uint8_t format)
+{
+	struct dma2d_op	op = {
+		.cr = DMA2D_CR_M2M,
+		.fgmar = (uint32_t) src,
+		.fgor = src_stride - w,
+		.fgpfccr = format,
+		.opfccr = format,
+		.omar = (uint32_t) dst,
+		.oor = dst_stride - w,
+		.nlr = ((uint32_t) w << 16) | h,
+	};
+
+	dma2d_submit(&op);
+}
+
+/* Copy a rectangle of pixels changing them to another format */
+void
+dma2d_convert(void *dst, int dst_stride, uint8_t dst_format,
+	      const void *src, int src_stride, uint8_t src_format,
+	      int w, int h)
+{
+	struct dma2d_op	op = {
+		.cr = DMA2D_CR_M2M_PFC,
+		.fgmar = (uint32_t) src,
+		.fgor = src_stride - w,
+		.fgpfccr = src_format,
+		.opfccr = dst_format,
+		.omar = (uint32_t) dst,
+		.oor = dst_stride - w,
+		.nlr = ((uint32_t) w << 16) | h,
+	};
+
+	dma2d_submit(&op);
+}
+
+/*
+ * Mix the pixels of 'fg' over those of 'bg' using the alpha of each
+ * 'fg' pixel, scaled by 'fg_alpha' (255 leaves it as it is), and store
+ * the result in 'dst'. 'dst' may be the same rectangle as 'bg', which
+ * is how an overlay is laid on to a frame.
+ */
+void
+dma2d_blend(void *dst, int dst_stride, uint8_t dst_format,
+	    const void *fg, int fg_stride, uint8_t fg_format,
+	    uint8_t fg_alpha, const void *bg, int bg_stride,
+	    uint8_t bg_format, int w, int h)
+{
+	struct dma2d_op	op = {
+		.cr = DMA2D_CR_M2M_BLEND,
+		.fgmar = (uint32_t) fg,
+		.fgor = fg_stride - w,
+		.fgpfccr = ((uint32_t) fg_alpha << 24) |
+			   DMA2D_PFCCR_AM_MULTIPLY | fg_format,
+		.bgmar = (uint32_t) bg,
+		.bgor = bg_stride - w,
+		.bgpfccr = bg_format,
+		.opfccr = dst_format,
+		.omar = (uint32_t) dst,
+		.oor = dst_stride - w,
+		.nlr = ((uint32_t) w << 16) | h,
+	};
+
+	dma2d_submit(&op);
+}
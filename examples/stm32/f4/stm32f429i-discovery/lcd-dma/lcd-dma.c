@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <libopencm3/cm3/dwt.h>
 #include <libopencm3/cm3/nvic.h>
 #include <libopencm3/stm32/rcc.h>
 #include <libopencm3/stm32/gpio.h>
@@ -9,6 +10,7 @@
 
 #include "clock.h"
 #include "console.h"
+#include "dma2d.h"
 #include "lcd-spi.h"
 #include "sdram.h"
 
@@ -24,29 +26,224 @@
 #define VBP          2
 #define VFP          4
 
-/* Layer 1 (bottom layer) is ARGB8888 format, full screen. */
+/* The first line after the active area, the flip is done there. */
+#define LCD_BLANK_LINE (VSYNC + VBP + LCD_HEIGHT)
 
-typedef uint32_t layer1_pixel;
-#define LCD_LAYER1_PIXFORMAT LTDC_LxPFCR_ARGB8888
+/* See lcd_dma_init() for where these come from. */
+#define LCD_PIXEL_CLOCK 6000000
+#define LCD_FRAME_CLOCKS ((VSYNC + VBP + LCD_HEIGHT + VFP) * \
+			  (HSYNC + HBP + LCD_WIDTH + HFP))
 
-layer1_pixel *const lcd_layer1_frame_buffer = (void *)SDRAM_BASE_ADDRESS;
-#define LCD_LAYER1_PIXEL_SIZE (sizeof(layer1_pixel))
+/*
+ * Layer 1 (bottom layer) is full screen, in one of the formats
+ * below.  The buffers have room for the largest one.
+ */
+
+#ifndef LCD_LAYER1_FORMAT
+#define LCD_LAYER1_FORMAT ltdc_l8
+#endif
+
+#define LCD_LAYER1_PIXEL_SIZE 4
 #define LCD_LAYER1_WIDTH  LCD_WIDTH
 #define LCD_LAYER1_HEIGHT LCD_HEIGHT
 #define LCD_LAYER1_PIXELS (LCD_LAYER1_WIDTH * LCD_LAYER1_HEIGHT)
 #define LCD_LAYER1_BYTES  (LCD_LAYER1_PIXELS * LCD_LAYER1_PIXEL_SIZE)
+#define LCD_LAYER1_BUFFERS 2
 
 /* Layer 2 (top layer) is ARGB4444, a 128x128 square. */
 
 typedef uint16_t layer2_pixel;
 #define LCD_LAYER2_PIXFORMAT LTDC_LxPFCR_ARGB4444
-layer2_pixel *const lcd_layer2_frame_buffer =
-	(void *)SDRAM_BASE_ADDRESS + LCD_LAYER1_BYTES;
 #define LCD_LAYER2_PIXEL_SIZE (sizeof(layer2_pixel))
 #define LCD_LAYER2_WIDTH 128
 #define LCD_LAYER2_HEIGHT 128
-#define LCD_LAYER2_PIXELS (LCD_LAYER2_WIDTH * LCD_LAYER2_HEIGH)
+#define LCD_LAYER2_PIXELS (LCD_LAYER2_WIDTH * LCD_LAYER2_HEIGHT)
 #define LCD_LAYER2_BYTES (LCD_LAYER2_PIXELS * LCD_LAYER2_PIXEL_SIZE)
+#define LCD_LAYER2_BUFFERS 3
+
+/*
+ * The frame buffers come from sdram_alloc(), in layer_alloc().  The
+ * one on the screen and the one being drawn into should never share
+ * an SDRAM bank, nor should the two layers' front buffers.  Layer 1
+ * only changes at start-up, so its front buffer has bank 0 to itself
+ * and its spare goes in bank 1.  Layer 2 gets one buffer in each of
+ * banks 1 to 3.
+ */
+#define LCD_LAYER1_BANK 0
+#define LCD_LAYER2_BANK 1
+
+/*
+ * Page flipping.
+ *
+ * Each layer has two or three frame buffers.  One is on the screen
+ * (front), one may be finished and waiting for the next vertical
+ * blanking (pending) and the rest can be drawn into (back).
+ * ltdc_swap_buffers() hands the back buffer over and returns the
+ * next one to draw into.  The interrupt at the first line after the
+ * active area points LTDC_LxCFBAR at the pending buffer and reloads
+ * the shadow registers right away, while nothing is being scanned
+ * out, so a frame is never shown half drawn.
+ *
+ * With three buffers drawing never waits for the display.  If a
+ * second frame is finished before the first one got to the screen,
+ * the first one is dropped and its buffer reused.  With two buffers
+ * the only one left to draw into is the one on the screen, so the
+ * swap waits for the flip.
+ */
+
+struct ltdc_stats {
+	uint32_t flips;		/* frames that made it to the screen */
+	uint32_t dropped;	/* frames replaced before they were shown */
+	uint32_t frame_us;	/* time between the last two swaps */
+};
+
+struct ltdc_layer {
+	volatile uint32_t *cfbar;	/* LTDC_LxCFBAR */
+	void *buffer[3];
+	int n_buffers;
+	volatile int front;
+	volatile int pending;		/* -1 if none */
+	int back;
+	uint32_t swap_cycles;		/* DWT_CYCCNT at the last swap */
+	struct ltdc_stats stats;
+};
+
+static struct ltdc_layer layer1 = {
+	.cfbar = &LTDC_L1CFBAR,
+	.n_buffers = LCD_LAYER1_BUFFERS,
+	.front = 0,
+	.pending = -1,
+	.back = 1,
+};
+
+static struct ltdc_layer layer2 = {
+	.cfbar = &LTDC_L2CFBAR,
+	.n_buffers = LCD_LAYER2_BUFFERS,
+	.front = 0,
+	.pending = -1,
+	.back = 1,
+};
+
+/*
+ * Pixel formats for layer 1.
+ *
+ * Layer 1 is read from SDRAM for every frame, so its format decides
+ * how much of the FMC bandwidth scanout takes: a quarter of ARGB8888
+ * for the 8 bit formats.  L8 and AL44 look their colors up in the
+ * CLUT, which is loaded from clut() when the format is set up.  L8
+ * and RGB565 have no alpha, so the transparent squares are drawn in
+ * LCD_COLOR_KEY and keyed out.  ARGB8888 is drawn as RGB565, half
+ * the bytes for the CPU to write, and DMA2D widens it, so it is keyed
+ * the same way.
+ */
+
+struct ltdc_format {
+	const char *name;
+	uint32_t pfcr;			/* LTDC_LxPFCR */
+	uint8_t pixel_size;		/* bytes */
+	uint16_t clut_size;		/* 0 if no CLUT */
+	uint32_t (*clut)(uint32_t i);	/* RGB888 for entry i */
+	int color_key;
+	int widen;			/* drawn as RGB565, see above */
+	void (*put)(void *fb, size_t i,
+		    uint8_t a, uint8_t r, uint8_t g, uint8_t b);
+};
+
+/* Magenta, which the drawing below never uses. */
+#define LCD_COLOR_KEY        0xFF00FF
+#define LCD_COLOR_KEY_RGB565 0xF81F
+#define LCD_COLOR_KEY_L8     0xE3	/* in the RGB332 CLUT */
+
+static void put_rgb565(void *fb, size_t i,
+		       uint8_t a, uint8_t r, uint8_t g, uint8_t b)
+{
+	uint16_t pix = (r >> 3) << 11 | (g >> 2) << 5 | b >> 3;
+
+	if (!a) {
+		pix = LCD_COLOR_KEY_RGB565;
+	} else if (pix == LCD_COLOR_KEY_RGB565) {
+		pix ^= 1;
+	}
+	((uint16_t *)fb)[i] = pix;
+}
+
+/* 3 bits of red, 3 of green and 2 of blue. */
+static uint32_t clut_rgb332(uint32_t i)
+{
+	uint32_t r = (i >> 5) * 0xFF / 7;
+	uint32_t g = (i >> 2 & 7) * 0xFF / 7;
+	uint32_t b = (i & 3) * 0xFF / 3;
+
+	return r << 16 | g << 8 | b;
+}
+
+static void put_l8(void *fb, size_t i,
+		   uint8_t a, uint8_t r, uint8_t g, uint8_t b)
+{
+	uint8_t pix = (r >> 5) << 5 | (g >> 5) << 2 | b >> 6;
+
+	if (!a) {
+		pix = LCD_COLOR_KEY_L8;
+	} else if (pix == LCD_COLOR_KEY_L8) {
+		pix ^= 1 << 2;
+	}
+	((uint8_t *)fb)[i] = pix;
+}
+
+/* 16 grays; AL44 has room for nothing more. */
+static uint32_t clut_gray16(uint32_t i)
+{
+	return i * 0x111111;
+}
+
+static void put_al44(void *fb, size_t i,
+		     uint8_t a, uint8_t r, uint8_t g, uint8_t b)
+{
+	uint8_t l = (r * 77 + g * 150 + b * 29) >> 8;
+
+	((uint8_t *)fb)[i] = (a & 0xF0) | l >> 4;
+}
+
+static const struct ltdc_format ltdc_argb8888 = {
+	.name = "ARGB8888",
+	.pfcr = LTDC_LxPFCR_ARGB8888,
+	.pixel_size = 4,
+	.color_key = 1,
+	.widen = 1,
+	.put = put_rgb565,
+};
+
+static const struct ltdc_format ltdc_rgb565 = {
+	.name = "RGB565",
+	.pfcr = LTDC_LxPFCR_RGB565,
+	.pixel_size = 2,
+	.color_key = 1,
+	.put = put_rgb565,
+};
+
+static const struct ltdc_format ltdc_al44 = {
+	.name = "AL44",
+	.pfcr = LTDC_LxPFCR_AL44,
+	.pixel_size = 1,
+	.clut_size = 16,
+	.clut = clut_gray16,
+	.put = put_al44,
+};
+
+static const struct ltdc_format ltdc_l8 = {
+	.name = "L8",
+	.pfcr = LTDC_LxPFCR_L8,
+	.pixel_size = 1,
+	.clut_size = 256,
+	.clut = clut_rgb332,
+	.color_key = 1,
+	.put = put_l8,
+};
+
+static const struct ltdc_format *layer1_format = &LCD_LAYER1_FORMAT;
+
+/* Vertical blanking periods since the LTDC was started. */
+static volatile uint32_t ltdc_vblanks;
 
 /*
  * Pin assignments
@@ -85,6 +282,42 @@ layer2_pixel *const lcd_layer2_frame_buffer =
  *     NRST    = NRST
  */
 
+/*
+ * Set layer 1 up for a pixel format and enable it.  The CLUT is only
+ * written with the layer off, so the layer is switched off at once
+ * and comes back at the next reload.  The frame buffers must already
+ * be drawn in the new format.
+ */
+static void ltdc_layer1_format(const struct ltdc_format *f)
+{
+	uint32_t cr = LTDC_LxCR_LAYER_ENABLE;
+	uint32_t pitch = LCD_LAYER1_WIDTH * f->pixel_size;
+	uint32_t i;
+
+	LTDC_L1CR = 0;
+	LTDC_SRCR |= LTDC_SRCR_IMR;
+
+	LTDC_L1PFCR = f->pfcr;
+	LTDC_L1CFBLR = pitch << LTDC_LxCFBLR_CFBP_SHIFT |
+		       (pitch + 3) << LTDC_LxCFBLR_CFBLL_SHIFT;
+
+	/* Address in the top byte, RGB888 below it. */
+	for (i = 0; i < f->clut_size; i++) {
+		LTDC_L1CLUTWR = i << 24 | f->clut(i);
+	}
+	if (f->clut_size) {
+		cr |= LTDC_LxCR_CLUT_ENABLE;
+	}
+	if (f->color_key) {
+		LTDC_L1CKCR = LCD_COLOR_KEY;
+		cr |= LTDC_LxCR_COLKEY_ENABLE;
+	}
+	LTDC_L1CR = cr;
+	LTDC_SRCR |= LTDC_SRCR_VBR;
+
+	layer1_format = f;
+}
+
 static void lcd_dma_init(void)
 {
 	/* init GPIO clocks */
@@ -193,7 +426,8 @@ static void lcd_dma_init(void)
 	LTDC_BCCR = 0x00000000;
 
 	/* Configure the needed interrupts. */
-	LTDC_IER = LTDC_IER_RRIE;
+	LTDC_LIPCR = LCD_BLANK_LINE;
+	LTDC_IER = LTDC_IER_LIE;
 	nvic_enable_irq(NVIC_LCD_TFT_IRQ);
 
 	/* Configure the Layer 1 parameters.
@@ -209,23 +443,17 @@ static void lcd_dma_init(void)
 		LTDC_L1WVPCR = v_stop << LTDC_LxWVPCR_WVSPPOS_SHIFT |
 			       v_start << LTDC_LxWVPCR_WVSTPOS_SHIFT;
 
-		/* The pixel input format */
-		LTDC_L1PFCR = LCD_LAYER1_PIXFORMAT;
-
 		/* The color frame buffer start address */
-		LTDC_L1CFBAR = (uint32_t)lcd_layer1_frame_buffer;
-
-		/* The line length and pitch of the color frame buffer */
-		uint32_t pitch = LCD_LAYER1_WIDTH * LCD_LAYER1_PIXEL_SIZE;
-		uint32_t length = LCD_LAYER1_WIDTH * LCD_LAYER1_PIXEL_SIZE + 3;
-		LTDC_L1CFBLR = pitch << LTDC_LxCFBLR_CFBP_SHIFT |
-			       length << LTDC_LxCFBLR_CFBLL_SHIFT;
+		LTDC_L1CFBAR = (uint32_t)layer1.buffer[layer1.front];
 
 		/* The number of lines of the color frame buffer */
 		LTDC_L1CFBLNR = LCD_LAYER1_HEIGHT;
 
-		/* If needed, load the CLUT */
-		/* (not using CLUT) */
+		/*
+		 * The pixel format, line length, CLUT and color key
+		 * are set, and the layer enabled, by
+		 * ltdc_layer1_format() below.
+		 */
 
 		/* If needed, configure the default color and blending
 		 * factors
@@ -251,7 +479,7 @@ static void lcd_dma_init(void)
 		LTDC_L2PFCR = LCD_LAYER2_PIXFORMAT;
 
 		/* The color frame buffer start address */
-		LTDC_L2CFBAR = (uint32_t)lcd_layer2_frame_buffer;
+		LTDC_L2CFBAR = (uint32_t)layer2.buffer[layer2.front];
 
 		/* The line length and pitch of the color frame buffer */
 		uint32_t pitch = LCD_LAYER2_WIDTH * LCD_LAYER2_PIXEL_SIZE;
@@ -274,7 +502,7 @@ static void lcd_dma_init(void)
 	}
 
 	/* Enable Layer1 and if needed the CLUT */
-	LTDC_L1CR |= LTDC_LxCR_LAYER_ENABLE;
+	ltdc_layer1_format(layer1_format);
 
 	/* Enable Layer2 and if needed the CLUT */
 	LTDC_L2CR |= LTDC_LxCR_LAYER_ENABLE;
@@ -368,18 +596,74 @@ static void move_sprite(void)
 }
 
 /*
- * Here is where all the work is done.  We poke a total of 6 registers
- * for each frame.
+ * Put the pending buffer of a layer on the screen, if there is one.
+ * Only called in vertical blanking.
+ */
+static void ltdc_flip(struct ltdc_layer *l)
+{
+	if (l->pending < 0) {
+		return;
+	}
+	*l->cfbar = (uint32_t)l->buffer[l->pending];
+	l->front = l->pending;
+	l->pending = -1;
+	l->stats.flips++;
+}
+
+/*
+ * Hand the back buffer of a layer over to be shown at the next
+ * vertical blanking, and return the buffer to draw the next frame
+ * into.  See above for when this waits.
+ */
+static void *ltdc_swap_buffers(struct ltdc_layer *l)
+{
+	uint32_t now = dwt_read_cycle_counter();
+	int i, back = -1;
+
+	l->stats.frame_us = (now - l->swap_cycles) /
+			    (rcc_ahb_frequency / 1000000);
+	l->swap_cycles = now;
+
+	nvic_disable_irq(NVIC_LCD_TFT_IRQ);
+	if (l->pending >= 0) {
+		l->stats.dropped++;
+	}
+	l->pending = l->back;
+	nvic_enable_irq(NVIC_LCD_TFT_IRQ);
+
+	while (back < 0) {
+		nvic_disable_irq(NVIC_LCD_TFT_IRQ);
+		for (i = 0; i < l->n_buffers; i++) {
+			if (i != l->front && i != l->pending) {
+				back = i;
+				break;
+			}
+		}
+		nvic_enable_irq(NVIC_LCD_TFT_IRQ);
+	}
+	l->back = back;
+	return l->buffer[back];
+}
+
+/*
+ * Here is where all the work is done.  The line interrupt comes at
+ * the first line after the active area, so everything written here
+ * is loaded at once and shows from the top of the next frame.  We
+ * poke a total of 6 registers for the animation, and the frame
+ * buffer address of any layer with a new frame.
  */
 
 void lcd_tft_isr(void)
 {
-	LTDC_ICR |= LTDC_ICR_CRRIF;
+	LTDC_ICR |= LTDC_ICR_CLIF;
+	ltdc_vblanks++;
 
 	mutate_background_color();
 	move_sprite();
+	ltdc_flip(&layer1);
+	ltdc_flip(&layer2);
 
-	LTDC_SRCR |= LTDC_SRCR_VBR;
+	LTDC_SRCR |= LTDC_SRCR_IMR;
 }
 
 /*
@@ -387,7 +671,7 @@ void lcd_tft_isr(void)
  * all different colors.
  */
 
-static void draw_layer_1(void)
+static void draw_layer_1(void *fb, const struct ltdc_format *f)
 {
 	int row, col;
 	int cel_count = (LCD_LAYER1_WIDTH >> 5) + (LCD_LAYER1_HEIGHT >> 5);
@@ -409,7 +693,6 @@ static void draw_layer_1(void)
 				r = g = b = a ? 0xFF : 0;
 				a = 0xFF;
 			}
-			layer1_pixel pix = a << 24 | r << 16 | g << 8 | b << 0;
 
 			/*
 			 * Outline the screen in white.  Put a black
@@ -418,21 +701,23 @@ static void draw_layer_1(void)
 			 * (The origin is in the lower left!)
 			 */
 			if (row == 0 || col == 0 || row == 319 || col == 239) {
-				pix = 0xFFFFFFFF;
+				a = r = g = b = 0xFF;
 			} else if (row < 20 && col < 20) {
-				pix = 0xFF000000;
+				a = 0xFF;
+				r = g = b = 0;
 			}
-			lcd_layer1_frame_buffer[i] = pix;
+			f->put(fb, i, a, r, g, b);
 		}
 	}
 }
 
 /*
  * Layer 2 holds the sprite.  The sprite is a semitransparent
- * magenta/cyan diamond outlined in black.
+ * magenta/cyan diamond outlined in black, with 'blue' (0 to 0xF)
+ * added to its colors.
  */
 
-static void draw_layer_2(void)
+static void draw_layer_2(layer2_pixel *fb, uint8_t blue)
 {
 	int row, col;
 	const uint8_t hw = LCD_LAYER2_WIDTH / 2;
@@ -455,16 +740,148 @@ static void draw_layer_2(void)
 			}
 			uint8_t r = dx >= dy ? 0xF : 0x0;
 			uint8_t g = dy >= dx ? 0xF : 0x0;
-			uint8_t b = 0xF;
+			uint8_t b = blue;
 			if (dx + dy >= sz - 2 || dx == dy) {
 				r = g = b = 0;
 			}
 			layer2_pixel pix = a << 12 | r << 8 | g << 4 | b << 0;
-			lcd_layer2_frame_buffer[i] = pix;
+			fb[i] = pix;
 		}
 	}
 }
 
+/*
+ * For every frame the sprite is made again with the blue going up and
+ * down with 'phase', to give the page flipping something to do.  The
+ * CPU draws it only twice, with no blue and with all of it, and DMA2D
+ * blends the two, the blue one on top with an alpha that follows
+ * 'phase'.  Where the sprite is partly transparent the blend also
+ * makes it a little more solid half way through.
+ */
+static layer2_pixel *sprite_dark, *sprite_blue;
+
+static void compose_layer_2(layer2_pixel *fb, uint32_t phase)
+{
+	uint8_t b = (phase & 0x10) ? ~phase & 0xF : phase & 0xF;
+
+	dma2d_blend(fb, LCD_LAYER2_WIDTH, DMA2D_ARGB4444,
+		    sprite_blue, LCD_LAYER2_WIDTH, DMA2D_ARGB4444, b * 0x11,
+		    sprite_dark, LCD_LAYER2_WIDTH, DMA2D_ARGB4444,
+		    LCD_LAYER2_WIDTH, LCD_LAYER2_HEIGHT);
+}
+
+/*
+ * Draw layer 1 in format f and copy it to the other buffer, so that
+ * both are ready before the layer is switched over.  Lines of every
+ * format are a whole number of words, so DMA2D copies them as
+ * ARGB8888 pixels.  A format that is widened is drawn into the other
+ * buffer first, which is free until the copy.
+ */
+static void layer1_load(const struct ltdc_format *f)
+{
+	uint32_t words = LCD_LAYER1_WIDTH * f->pixel_size / 4;
+	void *spare = layer1.buffer[(layer1.front + 1) % LCD_LAYER1_BUFFERS];
+	int i;
+
+	if (f->widen) {
+		draw_layer_1(spare, f);
+		dma2d_convert(layer1.buffer[layer1.front], LCD_LAYER1_WIDTH,
+			      DMA2D_ARGB8888, spare, LCD_LAYER1_WIDTH,
+			      DMA2D_RGB565, LCD_LAYER1_WIDTH,
+			      LCD_LAYER1_HEIGHT);
+	} else {
+		draw_layer_1(layer1.buffer[layer1.front], f);
+	}
+	for (i = 0; i < LCD_LAYER1_BUFFERS; i++) {
+		if (i != layer1.front) {
+			dma2d_copy(layer1.buffer[i], words,
+				   layer1.buffer[layer1.front], words,
+				   words, LCD_LAYER1_HEIGHT, DMA2D_ARGB8888);
+		}
+	}
+	dma2d_wait();
+}
+
+/*
+ * How fast the CPU gets at SDRAM while the LTDC is scanning out:
+ * copy a block between two spare areas after the frame buffers a
+ * few times and return the time it took.
+ */
+#define SDRAM_BENCH_WORDS 16384	/* 64 KB */
+#define SDRAM_BENCH_PASSES 16
+#define SDRAM_BENCH_BYTES (2 * 4 * SDRAM_BENCH_WORDS * SDRAM_BENCH_PASSES)
+
+static struct sdram_arena scratch;
+
+static uint32_t sdram_bench_us(void)
+{
+	volatile uint32_t *src, *dst;
+	uint32_t start = dwt_read_cycle_counter();
+	int pass, i;
+
+	sdram_arena_reset(&scratch);
+	src = sdram_arena_alloc(&scratch, 4 * SDRAM_BENCH_WORDS);
+	dst = sdram_arena_alloc(&scratch, 4 * SDRAM_BENCH_WORDS);
+	for (pass = 0; pass < SDRAM_BENCH_PASSES; pass++) {
+		for (i = 0; i < SDRAM_BENCH_WORDS; i++) {
+			dst[i] = src[i];
+		}
+	}
+	return (dwt_read_cycle_counter() - start) /
+	       (rcc_ahb_frequency / 1000000);
+}
+
+/*
+ * Show layer 1 in each format for a moment and time the CPU copy,
+ * then once more with layer 1 off, for what scanout of layer 2 alone
+ * leaves.  The SDRAM bandwidth scanout takes is worked out from the
+ * pixel clock.
+ */
+static void layer1_benchmark(void)
+{
+	static const struct ltdc_format *const formats[] = {
+		&ltdc_argb8888, &ltdc_rgb565, &ltdc_al44, &ltdc_l8,
+	};
+	uint32_t us, scanout;
+	unsigned i;
+
+	for (i = 0; i <= sizeof(formats) / sizeof(formats[0]); i++) {
+		if (i < sizeof(formats) / sizeof(formats[0])) {
+			layer1_load(formats[i]);
+			ltdc_layer1_format(formats[i]);
+			scanout = (uint64_t)LCD_LAYER1_PIXELS *
+				  formats[i]->pixel_size * LCD_PIXEL_CLOCK /
+				  LCD_FRAME_CLOCKS / 1000;
+			printf("layer 1 %-8s scanout %5" PRIu32 " KB/s, ",
+			       formats[i]->name, scanout);
+		} else {
+			LTDC_L1CR = 0;
+			LTDC_SRCR |= LTDC_SRCR_VBR;
+			printf("layer 1 off      scanout     0 KB/s, ");
+		}
+
+		/* Let the reload happen first. */
+		uint32_t vblank = ltdc_vblanks;
+		while (ltdc_vblanks == vblank) {
+			continue;
+		}
+
+		us = sdram_bench_us();
+		printf("CPU copy %5" PRIu32 " KB/s\n",
+		       (uint32_t)((uint64_t)SDRAM_BENCH_BYTES * 1000 / us));
+	}
+}
+
+/* Place the frame buffers, see above. */
+static void layer_alloc(struct ltdc_layer *l, uint32_t bytes, int bank)
+{
+	int i;
+
+	for (i = 0; i < l->n_buffers; i++) {
+		l->buffer[i] = sdram_alloc(bytes, bank + i);
+	}
+}
+
 int main(void)
 {
 	/* init timers. */
@@ -476,20 +893,53 @@ int main(void)
 
 	/* set up SDRAM. */
 	sdram_init();
+	layer_alloc(&layer1, LCD_LAYER1_BYTES, LCD_LAYER1_BANK);
+	layer_alloc(&layer2, LCD_LAYER2_BYTES, LCD_LAYER2_BANK);
+	sdram_arena_init(&scratch, 2 * 4 * SDRAM_BENCH_WORDS, SDRAM_ANY_BANK);
+
+	sprite_dark = sdram_alloc(LCD_LAYER2_BYTES, SDRAM_ANY_BANK);
+	sprite_blue = sdram_alloc(LCD_LAYER2_BYTES, SDRAM_ANY_BANK);
 
 	printf("Preloading frame buffers\n");
 
-	draw_layer_1();
-	draw_layer_2();
+	draw_layer_2(sprite_dark, 0);
+	draw_layer_2(sprite_blue, 0xF);
+
+	/* The buffers start out as copies, so a flip never shows junk. */
+	dma2d_init();
+	layer1_load(layer1_format);
+	for (int i = 0; i < LCD_LAYER2_BUFFERS; i++) {
+		dma2d_copy(layer2.buffer[i], LCD_LAYER2_WIDTH,
+			   sprite_blue, LCD_LAYER2_WIDTH,
+			   LCD_LAYER2_WIDTH, LCD_LAYER2_HEIGHT, DMA2D_ARGB4444);
+	}
+	dma2d_wait();
 
 	printf("Initializing LCD\n");
 
+	dwt_enable_cycle_counter();
 	lcd_dma_init();
 	lcd_spi_init();
 
 	printf("Initialized.\n");
 
+	layer1_benchmark();
+	layer1_load(&LCD_LAYER1_FORMAT);
+	ltdc_layer1_format(&LCD_LAYER1_FORMAT);
+	printf("Layer 1 is %s\n", layer1_format->name);
+
+	layer2_pixel *fb = layer2.buffer[layer2.back];
+	uint32_t phase = 0;
 	while (1) {
-		continue;
+		compose_layer_2(fb, phase++ >> 2);
+		dma2d_wait();
+		fb = ltdc_swap_buffers(&layer2);
+
+		if ((phase & 0x3FF) == 0) {
+			printf("%" PRIu32 " vblanks, %" PRIu32 " frames shown, "
+			       "%" PRIu32 " dropped, %" PRIu32 " us a frame\n",
+			       ltdc_vblanks, layer2.stats.flips,
+			       layer2.stats.dropped, layer2.stats.frame_us);
+		}
 	}
 }
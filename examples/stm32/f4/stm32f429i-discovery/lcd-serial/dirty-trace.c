@@ -0,0 +1,205 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host replay of two drawing traces through lcd-spi.c, counting the
+ * bytes that go out on the SPI port when each frame is sent whole
+ * with lcd_show_frame() and when only what changed is sent with
+ * lcd_show_dirty().
+ *
+ *  gauge   - the first screen of lcd-serial.c, then FRAMES frames of
+ *            its gauge needle sweeping, a counter and a progress bar.
+ *  planets - FRAMES frames of the planets animation, which redraws
+ *            the whole screen every time.
+ *
+ * A trace frame only draws what changed since the one before. Sent
+ * whole, the frame drawn into is two frames old (see lcd_show_frame),
+ * so the frame before is drawn again first to bring it up to date.
+ * Both ways the panel has to show the same after every frame, the
+ * program exits non-zero if it doesn't.
+ *
+ *     make HOST=1 && ./dirty-trace.host
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <libopencm3/stm32/spi.h>
+#include "host.h"
+#include "sdram.h"
+#include "lcd-spi.h"
+#include "gfx.h"
+
+#define FRAMES	60
+
+/* Convert degrees to radians */
+#define d2r(d) ((d) * 6.2831853 / 360.0)
+
+static void gauge(int k)
+{
+	char	text[16];
+	int	a;
+
+	if (k == 0) {
+		/* the first screen of lcd-serial.c */
+		gfx_fillScreen(LCD_GREY);
+		gfx_fillRoundRect(10, 10, 220, 220, 5, LCD_WHITE);
+		gfx_drawRoundRect(10, 10, 220, 220, 5, LCD_RED);
+		gfx_fillCircle(20, 250, 10, LCD_RED);
+		gfx_fillCircle(120, 250, 10, LCD_GREEN);
+		gfx_fillCircle(220, 250, 10, LCD_BLUE);
+		gfx_setTextColor(LCD_BLACK, LCD_WHITE);
+		gfx_setTextSize(2);
+		gfx_setCursor(15, 25);
+		gfx_puts("STM32F4-DISCO");
+		gfx_setTextSize(1);
+		gfx_setCursor(15, 49);
+		gfx_puts("Simple example to put some");
+		gfx_setCursor(15, 60);
+		gfx_puts("stuff on the LCD screen.");
+		gfx_drawArc(120, 150, 60, 10, 240, 120, LCD_BLUE);
+		gfx_drawArc(120, 150, 60, 10, 60, 120, LCD_RED);
+	}
+
+	/* the needle, from 240 degrees round to 120 */
+	a = 240 + k * 240 / FRAMES;
+	gfx_fillCircle(120, 150, 48, LCD_WHITE);
+	gfx_drawThickLine(120, 150, 120 + sin(d2r(a)) * 45,
+			  150 - cos(d2r(a)) * 45, 4, LCD_BLACK);
+	gfx_fillCircle(120, 150, 6, LCD_BLACK);
+
+	gfx_setTextColor(LCD_BLACK, LCD_WHITE);
+	gfx_setTextSize(1);
+	gfx_setCursor(15, 210);
+	sprintf(text, "frame %3d", k);
+	gfx_puts(text);
+
+	gfx_fillRect(20, 270, k * 200 / FRAMES, 6, LCD_GREEN);
+}
+
+static void planets(int k)
+{
+	int	p1 = (3 * k) % 360;
+	int	p2 = (45 + 2 * k) % 360;
+	int	p3 = (90 + k) % 360;
+
+	gfx_fillScreen(LCD_BLACK);
+	gfx_setTextColor(LCD_YELLOW, LCD_BLACK);
+	gfx_setTextSize(3);
+	gfx_setCursor(15, 36);
+	gfx_puts("PLANETS!");
+	gfx_fillCircle(120, 160, 40, LCD_YELLOW);
+	gfx_drawCircle(120, 160, 55, LCD_GREY);
+	gfx_drawCircle(120, 160, 75, LCD_GREY);
+	gfx_drawCircle(120, 160, 100, LCD_GREY);
+	gfx_fillCircle(120 + (sin(d2r(p1)) * 55),
+		       160 + (cos(d2r(p1)) * 55), 5, LCD_RED);
+	gfx_fillCircle(120 + (sin(d2r(p2)) * 75),
+		       160 + (cos(d2r(p2)) * 75), 10, LCD_WHITE);
+	gfx_fillCircle(120 + (sin(d2r(p3)) * 100),
+		       160 + (cos(d2r(p3)) * 100), 8, LCD_BLUE);
+}
+
+/* what the panel showed after each frame sent whole */
+static uint32_t shown[FRAMES + 1];
+
+static uint32_t panel_hash(void)
+{
+	const uint16_t	*p = host_panel_frame();
+	uint32_t	h = 2166136261u;
+	int		i;
+
+	for (i = 0; i < LCD_WIDTH * LCD_HEIGHT; i++) {
+		h = (h ^ p[i]) * 16777619u;
+	}
+	return h;
+}
+
+/*
+ * Bytes sent on the LCD's SPI port replaying 'trace' one way, and in
+ * 'differ' the number of frames the panel didn't show what it did
+ * with the frames sent whole.
+ */
+static uint64_t replay(void (*trace)(int), int dirty, int *differ)
+{
+	uint64_t	start;
+	int		k;
+
+	/* start from a blank screen, it doesn't count */
+	gfx_fillScreen(LCD_BLACK);
+	lcd_show_frame();
+	gfx_fillScreen(LCD_BLACK);
+	lcd_show_frame();
+
+	start = host_stats.spi[LCD_SPI].bytes;
+	for (k = 0; k <= FRAMES; k++) {
+		if (dirty) {
+			trace(k);
+			lcd_show_dirty();
+			while (lcd_frame_busy());
+		} else {
+			if (k) {
+				trace(k - 1);
+			}
+			trace(k);
+			lcd_show_frame();
+		}
+		if (!dirty) {
+			shown[k] = panel_hash();
+		} else if (panel_hash() != shown[k]) {
+			(*differ)++;
+		}
+	}
+	return host_stats.spi[LCD_SPI].bytes - start;
+}
+
+static const struct {
+	const char	*name;
+	void		(*trace)(int);
+} traces[] = {
+	{ "gauge",	gauge },
+	{ "planets",	planets },
+};
+
+int main(void)
+{
+	uint64_t	full, dirty;
+	unsigned	i;
+	int		differ = 0;
+
+	host_no_limits();
+	sdram_init();
+	lcd_spi_init();
+	gfx_init(lcd_draw_pixel, lcd_draw_span, lcd_draw_bitmap, 240, 320);
+	gfx_setBlend(lcd_blend_pixel);
+	gfx_setFill(lcd_fill_rect);
+	gfx_setRotate(lcd_set_rotation);
+
+	printf("%-8s %6s %12s %12s %8s\n", "", "frames", "full", "dirty",
+	       "");
+	for (i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) {
+		full = replay(traces[i].trace, 0, &differ);
+		dirty = replay(traces[i].trace, 1, &differ);
+		printf("%-8s %6d %12llu %12llu %7.1f%%\n", traces[i].name,
+		       FRAMES + 1, (unsigned long long)full,
+		       (unsigned long long)dirty, 100.0 * dirty / full);
+	}
+	if (differ) {
+		printf("%d frames sent dirty don't match\n", differ);
+	}
+	return differ != 0;
+}
@@ -0,0 +1,472 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host benchmark of the filled primitives in gfx.c, and of lines,
+ * which are drawn as runs.  Each one is run
+ * CALLS times with random arguments, some of them partly off screen,
+ * on the per-pixel path gfx.c used to take (the ref_ functions, the
+ * old code as it was) and on the span path it takes now, both drawing
+ * into a frame in memory.  Prints pixels per second for each, and
+ * exits non-zero if any call leaves a frame that isn't bit-identical
+ * to the old one.  The backend has no fill function here, so
+ * rectangles go a span at a time as they do without the DMA2D.
+ *
+ *     make HOST=1 && ./gfx-bench.host
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gfx.h"
+
+#define WIDTH	240
+#define HEIGHT	320
+#define CALLS	200
+#define REPEAT	5	/* each primitive is timed best of this many */
+
+static uint16_t frame[HEIGHT][WIDTH];
+static uint16_t ref_frame[HEIGHT][WIDTH];
+static uint16_t (*fb)[WIDTH] = frame;	/* where the backend draws */
+static uint64_t drawn;
+
+static void pixel(int x, int y, uint16_t color)
+{
+	fb[y][x] = color;
+	drawn++;
+}
+
+static void span(int x, int y, int w, uint16_t color)
+{
+	uint16_t *p = &fb[y][x];
+
+	drawn += w;
+	while (w--) {
+		*p++ = color;
+	}
+}
+
+/*
+ * The old per-pixel path: every primitive came down to gfx_drawLine()
+ * and every pixel was clipped on its own in gfx_drawPixel().
+ */
+static void ref_drawPixel(int x, int y, uint16_t color)
+{
+	if ((x < 0) || (x >= __gfx_state._width) ||
+	    (y < 0) || (y >= __gfx_state._height)) {
+		return;
+	}
+	(__gfx_state.drawpixel)(x, y, color);
+}
+
+static void ref_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+			 uint16_t color)
+{
+	int16_t steep = abs(y1 - y0) > abs(x1 - x0);
+	int16_t dx, dy, err, ystep;
+
+	if (steep) {
+		swap(x0, y0);
+		swap(x1, y1);
+	}
+	if (x0 > x1) {
+		swap(x0, x1);
+		swap(y0, y1);
+	}
+	dx = x1 - x0;
+	dy = abs(y1 - y0);
+	err = dx / 2;
+	ystep = (y0 < y1) ? 1 : -1;
+
+	for (; x0 <= x1; x0++) {
+		if (steep) {
+			ref_drawPixel(y0, x0, color);
+		} else {
+			ref_drawPixel(x0, y0, color);
+		}
+		err -= dy;
+		if (err < 0) {
+			y0 += ystep;
+			err += dx;
+		}
+	}
+}
+
+static void ref_drawFastVLine(int16_t x, int16_t y, int16_t h,
+			      uint16_t color)
+{
+	ref_drawLine(x, y, x, y + h - 1, color);
+}
+
+static void ref_drawFastHLine(int16_t x, int16_t y, int16_t w,
+			      uint16_t color)
+{
+	ref_drawLine(x, y, x + w - 1, y, color);
+}
+
+static void ref_fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+			 uint16_t color)
+{
+	int16_t i;
+
+	for (i = x; i < x + w; i++) {
+		ref_drawFastVLine(i, y, h, color);
+	}
+}
+
+static void ref_fillCircleHelper(int16_t x0, int16_t y0, int16_t r,
+				 uint8_t cornername, int16_t delta,
+				 uint16_t color)
+{
+	int16_t f     = 1 - r;
+	int16_t ddF_x = 1;
+	int16_t ddF_y = -2 * r;
+	int16_t x     = 0;
+	int16_t y     = r;
+
+	while (x < y) {
+		if (f >= 0) {
+			y--;
+			ddF_y += 2;
+			f     += ddF_y;
+		}
+		x++;
+		ddF_x += 2;
+		f     += ddF_x;
+
+		if (cornername & 0x1) {
+			ref_drawFastVLine(x0+x, y0-y, 2*y+1+delta, color);
+			ref_drawFastVLine(x0+y, y0-x, 2*x+1+delta, color);
+		}
+		if (cornername & 0x2) {
+			ref_drawFastVLine(x0-x, y0-y, 2*y+1+delta, color);
+			ref_drawFastVLine(x0-y, y0-x, 2*x+1+delta, color);
+		}
+	}
+}
+
+static void ref_fillCircle(int16_t x0, int16_t y0, int16_t r,
+			   uint16_t color)
+{
+	ref_drawFastVLine(x0, y0 - r, 2*r+1, color);
+	ref_fillCircleHelper(x0, y0, r, 3, 0, color);
+}
+
+static void ref_fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h,
+			      int16_t r, uint16_t color)
+{
+	ref_fillRect(x + r, y, w - 2 * r, h, color);
+	ref_fillCircleHelper(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
+	ref_fillCircleHelper(x + r        , y + r, r, 2, h - 2 * r - 1, color);
+}
+
+static void ref_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+			     int16_t x2, int16_t y2, uint16_t color)
+{
+	int16_t a, b, y, last;
+	int16_t dx01, dy01, dx02, dy02, dx12, dy12, sa = 0, sb = 0;
+
+	if (y0 > y1) {
+		swap(y0, y1); swap(x0, x1);
+	}
+	if (y1 > y2) {
+		swap(y2, y1); swap(x2, x1);
+	}
+	if (y0 > y1) {
+		swap(y0, y1); swap(x0, x1);
+	}
+
+	if (y0 == y2) {
+		a = b = x0;
+		if (x1 < a) {
+			a = x1;
+		} else if (x1 > b) {
+			b = x1;
+		}
+		if (x2 < a) {
+			a = x2;
+		} else if (x2 > b) {
+			b = x2;
+		}
+		ref_drawFastHLine(a, y0, b - a + 1, color);
+		return;
+	}
+
+	dx01 = x1 - x0;
+	dy01 = y1 - y0;
+	dx02 = x2 - x0;
+	dy02 = y2 - y0;
+	dx12 = x2 - x1;
+	dy12 = y2 - y1;
+	last = (y1 == y2) ? y1 : y1 - 1;
+
+	for (y = y0; y <= last; y++) {
+		a   = x0 + sa / dy01;
+		b   = x0 + sb / dy02;
+		sa += dx01;
+		sb += dx02;
+		if (a > b) {
+			swap(a, b);
+		}
+		ref_drawFastHLine(a, y, b - a + 1, color);
+	}
+	sa = dx12 * (y - y1);
+	sb = dx02 * (y - y0);
+	for (; y <= y2; y++) {
+		a   = x1 + sa / dy12;
+		b   = x0 + sb / dy02;
+		sa += dx12;
+		sb += dx02;
+		if (a > b) {
+			swap(a, b);
+		}
+		ref_drawFastHLine(a, y, b - a + 1, color);
+	}
+}
+
+/* The primitives, old and new, with their arguments in a[]. */
+struct call {
+	int16_t		a[6];
+	uint16_t	color;
+};
+
+static struct call calls[CALLS];
+static uint32_t seed;
+
+static int rnd(int lo, int hi)
+{
+	seed = seed * 1103515245 + 12345;
+	return lo + (int)((seed >> 8) % (uint32_t)(hi - lo + 1));
+}
+
+static void args_rect(int16_t *a)
+{
+	a[0] = rnd(-40, WIDTH - 1);
+	a[1] = rnd(-40, HEIGHT - 1);
+	a[2] = rnd(1, 120);
+	a[3] = rnd(1, 120);
+	/* a rounded one's radius, at most half the shorter side */
+	a[4] = rnd(0, ((a[2] < a[3]) ? a[2] : a[3]) / 2);
+}
+
+static void args_circle(int16_t *a)
+{
+	a[0] = rnd(-20, WIDTH + 20);
+	a[1] = rnd(-20, HEIGHT + 20);
+	a[2] = rnd(0, 60);
+}
+
+static void args_triangle(int16_t *a)
+{
+	int i;
+
+	for (i = 0; i < 6; i += 2) {
+		a[i] = rnd(-40, WIDTH + 40);
+		a[i + 1] = rnd(-40, HEIGHT + 40);
+	}
+}
+
+static void args_line(int16_t *a)
+{
+	a[0] = rnd(-40, WIDTH - 1);
+	a[1] = rnd(-40, HEIGHT - 1);
+	a[2] = rnd(1, 200);
+}
+
+static void args_segment(int16_t *a)
+{
+	int i;
+
+	for (i = 0; i < 4; i += 2) {
+		a[i] = rnd(-WIDTH / 2, WIDTH + WIDTH / 2);
+		a[i + 1] = rnd(-HEIGHT / 2, HEIGHT + HEIGHT / 2);
+	}
+}
+
+static void args_none(int16_t *a)
+{
+	(void)a;
+}
+
+static void ref_screen(const int16_t *a, uint16_t c)
+{
+	(void)a;
+	ref_fillRect(0, 0, WIDTH, HEIGHT, c);
+}
+
+static void ref_rect(const int16_t *a, uint16_t c)
+{
+	ref_fillRect(a[0], a[1], a[2], a[3], c);
+}
+
+static void ref_round(const int16_t *a, uint16_t c)
+{
+	ref_fillRoundRect(a[0], a[1], a[2], a[3], a[4], c);
+}
+
+static void ref_circle(const int16_t *a, uint16_t c)
+{
+	ref_fillCircle(a[0], a[1], a[2], c);
+}
+
+static void ref_triangle(const int16_t *a, uint16_t c)
+{
+	ref_fillTriangle(a[0], a[1], a[2], a[3], a[4], a[5], c);
+}
+
+static void ref_hline(const int16_t *a, uint16_t c)
+{
+	ref_drawFastHLine(a[0], a[1], a[2], c);
+}
+
+static void ref_vline(const int16_t *a, uint16_t c)
+{
+	ref_drawFastVLine(a[0], a[1], a[2], c);
+}
+
+static void ref_line(const int16_t *a, uint16_t c)
+{
+	ref_drawLine(a[0], a[1], a[2], a[3], c);
+}
+
+static void gfx_screen(const int16_t *a, uint16_t c)
+{
+	(void)a;
+	gfx_fillScreen(c);
+}
+
+static void gfx_rect(const int16_t *a, uint16_t c)
+{
+	gfx_fillRect(a[0], a[1], a[2], a[3], c);
+}
+
+static void gfx_round(const int16_t *a, uint16_t c)
+{
+	gfx_fillRoundRect(a[0], a[1], a[2], a[3], a[4], c);
+}
+
+static void gfx_circle(const int16_t *a, uint16_t c)
+{
+	gfx_fillCircle(a[0], a[1], a[2], c);
+}
+
+static void gfx_triangle(const int16_t *a, uint16_t c)
+{
+	gfx_fillTriangle(a[0], a[1], a[2], a[3], a[4], a[5], c);
+}
+
+static void gfx_hline(const int16_t *a, uint16_t c)
+{
+	gfx_drawFastHLine(a[0], a[1], a[2], c);
+}
+
+static void gfx_vline(const int16_t *a, uint16_t c)
+{
+	gfx_drawFastVLine(a[0], a[1], a[2], c);
+}
+
+static void gfx_line(const int16_t *a, uint16_t c)
+{
+	gfx_drawLine(a[0], a[1], a[2], a[3], c);
+}
+
+static const struct prim {
+	const char	*name;
+	void		(*args)(int16_t *);
+	void		(*ref)(const int16_t *, uint16_t);
+	void		(*gfx)(const int16_t *, uint16_t);
+} prims[] = {
+	{ "fillScreen",		args_none,	ref_screen,	gfx_screen },
+	{ "fillRect",		args_rect,	ref_rect,	gfx_rect },
+	{ "fillRoundRect",	args_rect,	ref_round,	gfx_round },
+	{ "fillCircle",		args_circle,	ref_circle,	gfx_circle },
+	{ "fillTriangle",	args_triangle,	ref_triangle,	gfx_triangle },
+	{ "drawFastHLine",	args_line,	ref_hline,	gfx_hline },
+	{ "drawFastVLine",	args_line,	ref_vline,	gfx_vline },
+	{ "drawLine",		args_segment,	ref_line,	gfx_line },
+};
+
+/* Best of REPEAT runs through calls[], in clock ticks. */
+static clock_t run(void (*draw)(const int16_t *, uint16_t))
+{
+	clock_t start, t, best = 0;
+	int r, i;
+
+	for (r = 0; r < REPEAT; r++) {
+		gfx_dirty_clear();
+		start = clock();
+		for (i = 0; i < CALLS; i++) {
+			draw(calls[i].a, calls[i].color);
+		}
+		t = clock() - start;
+		best = (r == 0 || t < best) ? t : best;
+	}
+	return best ? best : 1;
+}
+
+int main(void)
+{
+	const struct prim *p;
+	uint64_t pixels;
+	clock_t ref_ticks, gfx_ticks;
+	int i, diff, failed = 0;
+
+	gfx_init(pixel, span, NULL, WIDTH, HEIGHT);
+	printf("%-14s %10s %14s %14s\n", "", "pixels", "per pixel/s",
+	       "spans/s");
+	for (p = prims; p < prims + sizeof(prims) / sizeof(prims[0]); p++) {
+		seed = 1;
+		for (i = 0; i < CALLS; i++) {
+			p->args(calls[i].a);
+			calls[i].color = rnd(0, 0xffff);
+		}
+
+		/* call by call, the frames have to stay the same */
+		memset(frame, 0, sizeof(frame));
+		memset(ref_frame, 0, sizeof(ref_frame));
+		diff = 0;
+		pixels = 0;
+		for (i = 0; i < CALLS; i++) {
+			fb = ref_frame;
+			p->ref(calls[i].a, calls[i].color);
+			fb = frame;
+			drawn = 0;
+			p->gfx(calls[i].a, calls[i].color);
+			/* the old path draws some pixels twice, count these */
+			pixels += drawn;
+			if (memcmp(frame, ref_frame, sizeof(frame))) {
+				diff++;
+				memcpy(frame, ref_frame, sizeof(frame));
+			}
+		}
+
+		ref_ticks = run(p->ref);
+		gfx_ticks = run(p->gfx);
+		printf("%-14s %10llu %14.0f %14.0f %5.1fx", p->name,
+		       (unsigned long long)pixels,
+		       (double)pixels * CLOCKS_PER_SEC / ref_ticks,
+		       (double)pixels * CLOCKS_PER_SEC / gfx_ticks,
+		       (double)ref_ticks / gfx_ticks);
+		if (diff) {
+			printf(", %d of %d calls differ", diff, CALLS);
+			failed = 1;
+		}
+		printf("\n");
+	}
+	return failed;
+}
@@ -0,0 +1,205 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Drawing images kept in flash (see gfx.h for the formats, and
+ * png2gfx.py for making them).
+ *
+ * Images are decoded a row at a time, and only the columns that are
+ * on the screen, into a row of pixels which is handed to the
+ * backend's bitmap function, so the frame gets whole rows copied in
+ * rather than a pixel at a time. Transparent pixels split the row
+ * into runs and each opaque run goes out on its own. Rows above the
+ * screen are skipped without decoding them, which for the run length
+ * format means stepping over their packets.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "gfx.h"
+
+#define RLE_RUN		0x8000
+
+static uint16_t		img_row[GFX_WIDTH];
+
+/*
+ * Send 'n' decoded pixels, starting at img_row[i], to x, y.
+ */
+static void
+put_run(int x, int y, int i, int n)
+{
+	uint16_t	*p = img_row + i;
+
+	if (n <= 0) {
+		return;
+	}
+	if (__gfx_state.drawbitmap) {
+		(__gfx_state.drawbitmap)(x, y, n, 1, p);
+		return;
+	}
+	while (n--) {
+		(__gfx_state.drawpixel)(x++, y, *p++);
+	}
+}
+
+/*
+ * Step over one row of run length packets, returns where the next
+ * row starts.
+ */
+static const uint16_t *
+rle_skip_row(const uint16_t *src, int w)
+{
+	int	n;
+
+	while (w > 0) {
+		n = *src & ~RLE_RUN;
+		src += (*src & RLE_RUN) ? 2 : n + 1;
+		w -= n;
+	}
+	return src;
+}
+
+/*
+ * Decode columns c0 - c1 (exclusive) of one row of run length
+ * packets and draw them, x is where the left edge of the image is.
+ * Returns the start of the next row.
+ */
+static const uint16_t *
+rle_row(const uint16_t *src, const struct gfx_image *img,
+	int x, int y, int c0, int c1)
+{
+	int		i, n, a, b, start;
+	uint16_t	pixel;
+	int		keyed = img->flags & GFX_IMAGE_KEYED;
+
+	start = c0;
+	for (i = 0; i < img->w; i += n) {
+		n = *src & ~RLE_RUN;
+		a = (i > c0) ? i : c0;
+		b = (i + n < c1) ? i + n : c1;
+		if (*src++ & RLE_RUN) {
+			pixel = *src++;
+			if (keyed && (pixel == img->key)) {
+				if (a < b) {
+					put_run(x + start, y, start - c0,
+						a - start);
+					start = b;
+				}
+				continue;
+			}
+			for (; a < b; a++) {
+				img_row[a - c0] = pixel;
+			}
+		} else {
+			for (; a < b; a++) {
+				pixel = src[a - i];
+				if (keyed && (pixel == img->key)) {
+					put_run(x + start, y, start - c0,
+						a - start);
+					start = a + 1;
+					continue;
+				}
+				img_row[a - c0] = pixel;
+			}
+			src += n;
+		}
+	}
+	put_run(x + start, y, start - c0, c1 - start);
+	return src;
+}
+
+/*
+ * Same for row 'row' of one of the formats where every row is the
+ * same size.
+ */
+static void
+plain_row(const struct gfx_image *img, int row,
+	  int x, int y, int c0, int c1)
+{
+	const uint8_t	*src;
+	int		i, start, stride;
+	uint16_t	v;
+	int		keyed = img->flags & GFX_IMAGE_KEYED;
+
+	switch (img->format) {
+	case GFX_IMAGE_RGB565:
+		stride = img->w * 2;
+		break;
+	case GFX_IMAGE_PAL8:
+		stride = img->w;
+		break;
+	default:	/* GFX_IMAGE_PAL4 */
+		stride = (img->w + 1) / 2;
+		break;
+	}
+	src = (const uint8_t *) img->data + row * stride;
+
+	start = c0;
+	for (i = c0; i < c1; i++) {
+		switch (img->format) {
+		case GFX_IMAGE_RGB565:
+			v = ((const uint16_t *) src)[i];
+			break;
+		case GFX_IMAGE_PAL8:
+			v = src[i];
+			break;
+		default:
+			v = (i & 1) ? (src[i / 2] & 0xf) : (src[i / 2] >> 4);
+			break;
+		}
+		if (keyed && (v == img->key)) {
+			put_run(x + start, y, start - c0, i - start);
+			start = i + 1;
+			continue;
+		}
+		img_row[i - c0] = (img->format == GFX_IMAGE_RGB565) ?
+							v : img->palette[v];
+	}
+	put_run(x + start, y, start - c0, c1 - start);
+}
+
+void
+gfx_drawImage(int16_t x, int16_t y, const struct gfx_image *img)
+{
+	const uint16_t	*src = img->data;
+	int		c0, c1, row, r0, r1;
+
+	/* the part of the image that is on the screen */
+	c0 = (x < 0) ? -x : 0;
+	c1 = (x + img->w > __gfx_state._width) ?
+				__gfx_state._width - x : img->w;
+	r0 = (y < 0) ? -y : 0;
+	r1 = (y + img->h > __gfx_state._height) ?
+				__gfx_state._height - y : img->h;
+	if ((c0 >= c1) || (r0 >= r1)) {
+		return;
+	}
+	gfx_mark_dirty(x + c0, y + r0, c1 - c0, r1 - r0);
+
+	if (img->format == GFX_IMAGE_RLE565) {
+		for (row = 0; row < r0; row++) {
+			src = rle_skip_row(src, img->w);
+		}
+		for (; row < r1; row++) {
+			src = rle_row(src, img, x, y + row, c0, c1);
+		}
+		return;
+	}
+	for (row = r0; row < r1; row++) {
+		plain_row(img, row, x, y + row, c0, c1);
+	}
+}
@@ -0,0 +1,387 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Filled polygons, thick lines and arcs for the gfx code.
+ *
+ * Polygons are scan converted with an active edge table. The edges
+ * are sorted on the first line they cross, and as we walk down the
+ * screen edges are added to the active list when we reach them and
+ * dropped when we pass them. On each line the active edges are put
+ * in order of x and the runs between them that are inside (non-zero
+ * winding) are sent to the backend as spans.
+ *
+ * For anti-aliasing everything is done in quarter pixels, four lines
+ * per pixel row and four samples across each pixel, and the number
+ * of samples that land inside a pixel is its coverage. Pixels that
+ * are fully covered still go out as spans, only the edges get
+ * blended.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include "gfx.h"
+
+#define SUB_SHIFT	2
+#define SUB		(1 << SUB_SHIFT)
+#define FULL		(SUB * SUB)
+
+#define d2r(d) ((d) * 6.2831853f / 360.0f)
+
+struct gfx_edge {
+	int64_t	x;		/* 16.16 x where it crosses this line */
+	int64_t	dx;		/* how much x changes per line */
+	int32_t	y0, y1;		/* first line it crosses, one past the last */
+	int	dir;		/* 1 going down, -1 going up */
+};
+
+static struct gfx_edge	edges[GFX_POLY_MAX_POINTS];
+static struct gfx_edge	*active[GFX_POLY_MAX_POINTS];
+
+/* coverage (in 16ths) of each pixel in the row being built */
+static uint8_t		coverage[GFX_WIDTH];
+static int		cov_lo, cov_hi;
+
+/*
+ * Send the row we have been building, fully covered runs as spans
+ * and partly covered pixels blended. Clears it for the next row.
+ */
+static void
+flush_row(int y, uint16_t color)
+{
+	int	x, run;
+
+	for (x = cov_lo; x <= cov_hi; x++) {
+		if (coverage[x] >= FULL) {
+			for (run = x; (run <= cov_hi) &&
+					(coverage[run] >= FULL); run++) {
+				coverage[run] = 0;
+			}
+			gfx_drawFastHLine(x, y, run - x, color);
+			x = run - 1;
+		} else if (coverage[x]) {
+			gfx_blendPixel(x, y, color, coverage[x]);
+			coverage[x] = 0;
+		}
+	}
+	cov_lo = GFX_WIDTH;
+	cov_hi = -1;
+}
+
+/*
+ * Add the samples xa up to (not including) xb, in quarter pixels, on
+ * one line to the coverage of the row.
+ */
+static void
+cover(int xa, int xb)
+{
+	int	pa = xa >> SUB_SHIFT;
+	int	pb = xb >> SUB_SHIFT;
+	int	p;
+
+	if (pa < cov_lo) {
+		cov_lo = pa;
+	}
+	if (pa == pb) {
+		coverage[pa] += xb - xa;
+		if (pa > cov_hi) {
+			cov_hi = pa;
+		}
+		return;
+	}
+	coverage[pa] += SUB - (xa & (SUB - 1));
+	for (p = pa + 1; p < pb; p++) {
+		coverage[p] += SUB;
+	}
+	if (xb & (SUB - 1)) {
+		coverage[pb] += xb & (SUB - 1);
+		p = pb;
+	} else {
+		p = pb - 1;
+	}
+	if (p > cov_hi) {
+		cov_hi = p;
+	}
+}
+
+/*
+ * Scan convert the polygon vx[], vy[]. When 'aa' is set the points
+ * are in quarter pixels (with a pixel's centre at 4 * x + 2) and the
+ * result is blended, otherwise they are whole pixels.
+ */
+static void
+poly_scan(const int32_t *vx, const int32_t *vy, int n, uint16_t color,
+	  int aa)
+{
+	struct gfx_edge	e, *t;
+	int32_t	x0, y0, x1, y1;
+	int	i, j, ne, na, next, wind;
+	int	sub = aa ? SUB : 1;
+	int32_t	y, ymax, ylimit, xlimit;
+	int64_t	xa, xb;
+
+	/* edge table, in order of the first line each edge crosses */
+	ne = 0;
+	ymax = INT32_MIN;
+	for (i = 0; i < n; i++) {
+		j = (i + 1 == n) ? 0 : i + 1;
+		x0 = vx[i];
+		y0 = vy[i];
+		x1 = vx[j];
+		y1 = vy[j];
+		if (y0 == y1) {
+			continue; /* never crosses a line, doesn't matter */
+		}
+		e.dir = 1;
+		if (y0 > y1) {
+			e.dir = -1;
+			x0 = vx[j];
+			y0 = vy[j];
+			x1 = vx[i];
+			y1 = vy[i];
+		}
+		e.y0 = y0;
+		e.y1 = y1;
+		e.dx = ((int64_t)(x1 - x0) << 16) / (y1 - y0);
+		e.x = (int64_t) x0 << 16;
+		for (j = ne; (j > 0) && (edges[j - 1].y0 > y0); j--) {
+			edges[j] = edges[j - 1];
+		}
+		edges[j] = e;
+		ne++;
+		if (y1 > ymax) {
+			ymax = y1;
+		}
+	}
+	if (ne == 0) {
+		return;
+	}
+
+	ylimit = __gfx_state._height * sub;
+	xlimit = __gfx_state._width * sub;
+	if (ymax > ylimit) {
+		ymax = ylimit;
+	}
+	y = (edges[0].y0 < 0) ? 0 : edges[0].y0;
+
+	cov_lo = GFX_WIDTH;
+	cov_hi = -1;
+	na = 0;
+	next = 0;
+	for (; y < ymax; y++) {
+		/* pick up edges that start on (or, clipped, above) this line */
+		while ((next < ne) && (edges[next].y0 <= y)) {
+			t = &edges[next++];
+			if (t->y1 <= y) {
+				continue;
+			}
+			t->x += (y - t->y0) * t->dx;
+			active[na++] = t;
+		}
+		/* drop the ones we are past */
+		for (i = 0; i < na; ) {
+			if (active[i]->y1 <= y) {
+				active[i] = active[--na];
+			} else {
+				i++;
+			}
+		}
+		/* order on x, they were mostly in order last line anyway */
+		for (i = 1; i < na; i++) {
+			t = active[i];
+			for (j = i; (j > 0) && (active[j - 1]->x > t->x); j--) {
+				active[j] = active[j - 1];
+			}
+			active[j] = t;
+		}
+
+		wind = 0;
+		xa = 0;
+		for (i = 0; i < na; i++) {
+			t = active[i];
+			if (wind == 0) {
+				xa = (t->x + 0xffff) >> 16;
+			}
+			wind += t->dir;
+			if (wind == 0) {
+				xb = (t->x + 0xffff) >> 16;
+				xa = (xa < 0) ? 0 : xa;
+				xb = (xb > xlimit) ? xlimit : xb;
+				if (xb > xa) {
+					if (aa) {
+						cover((int) xa, (int) xb);
+					} else {
+						gfx_drawFastHLine(xa, y,
+							xb - xa, color);
+					}
+				}
+			}
+			t->x += t->dx;
+		}
+
+		if (aa && (((y & (SUB - 1)) == SUB - 1) || (y + 1 == ymax))) {
+			flush_row(y >> SUB_SHIFT, color);
+		}
+	}
+}
+
+void
+gfx_fillPolygon(const struct gfx_point *pts, int n, uint16_t color)
+{
+	int32_t	vx[GFX_POLY_MAX_POINTS], vy[GFX_POLY_MAX_POINTS];
+	int	i, aa = (__gfx_state.blendpixel != NULL);
+
+	if ((n < 3) || (n > GFX_POLY_MAX_POINTS)) {
+		return;
+	}
+	for (i = 0; i < n; i++) {
+		vx[i] = aa ? pts[i].x * SUB + SUB / 2 : pts[i].x;
+		vy[i] = aa ? pts[i].y * SUB + SUB / 2 : pts[i].y;
+	}
+	poly_scan(vx, vy, n, color, aa);
+}
+
+/*
+ * A line 'width' pixels wide with square ends, drawn as the four
+ * point polygon around it.
+ */
+void
+gfx_drawThickLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+		  int16_t width, uint16_t color)
+{
+	int32_t	vx[4], vy[4];
+	float	dx = x1 - x0, dy = y1 - y0;
+	float	len = sqrtf(dx * dx + dy * dy);
+	float	nx, ny, scale;
+	int	aa = (__gfx_state.blendpixel != NULL);
+	int	offset;
+
+	if ((width <= 1) || (len == 0)) {
+		gfx_drawLine(x0, y0, x1, y1, color);
+		return;
+	}
+	/* half the width, at right angles to the line */
+	nx = -dy * width / (2 * len);
+	ny =  dx * width / (2 * len);
+	scale = aa ? SUB : 1;
+	offset = aa ? SUB / 2 : 0;
+	vx[0] = lroundf((x0 + nx) * scale) + offset;
+	vy[0] = lroundf((y0 + ny) * scale) + offset;
+	vx[1] = lroundf((x1 + nx) * scale) + offset;
+	vy[1] = lroundf((y1 + ny) * scale) + offset;
+	vx[2] = lroundf((x1 - nx) * scale) + offset;
+	vy[2] = lroundf((y1 - ny) * scale) + offset;
+	vx[3] = lroundf((x0 - nx) * scale) + offset;
+	vy[3] = lroundf((y0 - ny) * scale) + offset;
+	poly_scan(vx, vy, 4, color, aa);
+}
+
+/* how much of a pixel 'd' from an edge (inside is positive) is in */
+static float
+edge_cover(float d)
+{
+	d += 0.5f;
+	return (d < 0) ? 0 : (d > 1) ? 1 : d;
+}
+
+/*
+ * An arc of a ring 'thickness' pixels wide whose outside edge is r
+ * pixels from x0, y0, going clockwise from 'start' to 'end' degrees
+ * (0 is straight up). For each pixel the coverage is the smaller of
+ * how far in it is from the inside and outside circles and from the
+ * two straight edges at the ends.
+ */
+void
+gfx_drawArc(int16_t x0, int16_t y0, int16_t r, int16_t thickness,
+	    int16_t start, int16_t end, uint16_t color)
+{
+	float	ro = r + 0.5f;
+	float	ri = r - thickness + 0.5f;
+	float	sx, sy, ex, ey, a, d, c, cs, ce;
+	int	sweep, x, y, dx, dy, xo, xi;
+	int	aa = (__gfx_state.blendpixel != NULL);
+
+	if ((r <= 0) || (thickness <= 0)) {
+		return;
+	}
+	sweep = end - start;
+	while (sweep <= 0) {
+		sweep += 360;
+	}
+	a = d2r(start);
+	sx = sinf(a);
+	sy = -cosf(a);
+	a = d2r(end);
+	ex = sinf(a);
+	ey = -cosf(a);
+
+	for (dy = -r - 1; dy <= r + 1; dy++) {
+		y = y0 + dy;
+		if ((y < 0) || (y >= __gfx_state._height)) {
+			continue;
+		}
+		/* pixels on this row that could touch the ring */
+		d = (ro + 0.5f) * (ro + 0.5f) - dy * dy;
+		if (d < 0) {
+			continue;
+		}
+		xo = (int) sqrtf(d);
+		d = (ri - 0.5f) * (ri - 0.5f) - dy * dy;
+		xi = ((ri > 0.5f) && (d > 0)) ? (int) sqrtf(d) : -1;
+
+		cov_lo = GFX_WIDTH;
+		cov_hi = -1;
+		for (dx = -xo; dx <= xo; dx++) {
+			if ((dx > -xi) && (dx < xi)) {
+				dx = xi - 1;	/* skip the hole */
+				continue;
+			}
+			x = x0 + dx;
+			if ((x < 0) || (x >= __gfx_state._width)) {
+				continue;
+			}
+			d = sqrtf(dx * dx + dy * dy);
+			c = edge_cover(ro - d);
+			a = edge_cover(d - ri);
+			c = (a < c) ? a : c;
+			if (sweep < 360) {
+				cs = sx * dy - sy * dx;
+				ce = dx * ey - dy * ex;
+				if (sweep <= 180) {
+					a = edge_cover((cs < ce) ? cs : ce);
+				} else {
+					a = edge_cover((cs > ce) ? cs : ce);
+				}
+				c = (a < c) ? a : c;
+			}
+			if (!aa) {
+				c = (c >= 0.5f) ? 1 : 0;
+			}
+			coverage[x] = (uint8_t)(c * FULL + 0.5f);
+			if (coverage[x]) {
+				if (x < cov_lo) {
+					cov_lo = x;
+				}
+				if (x > cov_hi) {
+					cov_hi = x;
+				}
+			}
+		}
+		flush_row(y, color);
+	}
+}
@@ -38,6 +38,7 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include <math.h>
 #include <stdlib.h>
 #include "gfx.h"
@@ -47,6 +48,170 @@
 
 struct gfx_state __gfx_state;
 
+#define GFX_GLYPH_PIXELS	(8 * 12 * GFX_GLYPH_MAX_SIZE * GFX_GLYPH_MAX_SIZE)
+
+struct gfx_glyph {
+	uint16_t	color, bg;
+	uint8_t		c, size;	/* size 0 is an empty slot */
+	uint32_t	used;		/* glyph_clock when last used */
+	uint16_t	pixels[GFX_GLYPH_PIXELS];
+};
+
+static struct gfx_glyph glyph_cache[GFX_GLYPH_CACHE];
+static uint32_t glyph_clock;
+
+/* one row of pixels for gfx_puts */
+static uint16_t gfx_row[GFX_WIDTH];
+
+static int32_t gfx_rect_area(int x0, int y0, int x1, int y1)
+{
+	return (int32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+}
+
+static void gfx_rect_union(struct gfx_rect *r, int x0, int y0,
+			   int x1, int y1)
+{
+	if (x0 < r->x0) {
+		r->x0 = x0;
+	}
+	if (y0 < r->y0) {
+		r->y0 = y0;
+	}
+	if (x1 > r->x1) {
+		r->x1 = x1;
+	}
+	if (y1 > r->y1) {
+		r->y1 = y1;
+	}
+}
+
+/*
+ * Add the (already clipped) box x0, y0 - x1, y1 to the dirty list.
+ * This gets called for every span and pixel so the common case, the
+ * box is inside the last one we touched, is checked first.
+ */
+static void gfx_dirty_add(int x0, int y0, int x1, int y1)
+{
+	struct gfx_rect *r;
+	int32_t	cost, best_cost;
+	int	i, best;
+
+	r = &__gfx_state.dirty[__gfx_state.last_dirty];
+	if ((__gfx_state.n_dirty) && (x0 >= r->x0) && (x1 <= r->x1) &&
+	    (y0 >= r->y0) && (y1 <= r->y1)) {
+		return;
+	}
+
+	/* merge with anything it overlaps or touches */
+	for (i = 0; i < __gfx_state.n_dirty; i++) {
+		r = &__gfx_state.dirty[i];
+		if ((x0 <= r->x1 + 1) && (x1 >= r->x0 - 1) &&
+		    (y0 <= r->y1 + 1) && (y1 >= r->y0 - 1)) {
+			gfx_rect_union(r, x0, y0, x1, y1);
+			__gfx_state.last_dirty = i;
+			return;
+		}
+	}
+
+	if (__gfx_state.n_dirty < GFX_MAX_DIRTY) {
+		i = __gfx_state.n_dirty++;
+		r = &__gfx_state.dirty[i];
+		r->x0 = x0;
+		r->y0 = y0;
+		r->x1 = x1;
+		r->y1 = y1;
+		__gfx_state.last_dirty = i;
+		return;
+	}
+
+	/* list is full, grow the box that grows the least */
+	best = 0;
+	best_cost = INT32_MAX;
+	for (i = 0; i < GFX_MAX_DIRTY; i++) {
+		r = &__gfx_state.dirty[i];
+		cost = gfx_rect_area((x0 < r->x0) ? x0 : r->x0,
+				     (y0 < r->y0) ? y0 : r->y0,
+				     (x1 > r->x1) ? x1 : r->x1,
+				     (y1 > r->y1) ? y1 : r->y1) -
+		       gfx_rect_area(r->x0, r->y0, r->x1, r->y1);
+		if (cost < best_cost) {
+			best_cost = cost;
+			best = i;
+		}
+	}
+	gfx_rect_union(&__gfx_state.dirty[best], x0, y0, x1, y1);
+	__gfx_state.last_dirty = best;
+}
+
+/*
+ * Mark an area as changed, for when something other than the gfx
+ * code has been drawing in the frame.
+ */
+void
+gfx_mark_dirty(int x, int y, int w, int h)
+{
+	int	x1 = x + w - 1;
+	int	y1 = y + h - 1;
+
+	if (x < 0) {
+		x = 0;
+	}
+	if (y < 0) {
+		y = 0;
+	}
+	if (x1 >= __gfx_state._width) {
+		x1 = __gfx_state._width - 1;
+	}
+	if (y1 >= __gfx_state._height) {
+		y1 = __gfx_state._height - 1;
+	}
+	if ((x1 < x) || (y1 < y)) {
+		return;
+	}
+	gfx_dirty_add(x, y, x1, y1);
+}
+
+/*
+ * Returns the number of dirty regions and points 'regions' at them.
+ * Merging can leave boxes overlapping each other, so they are folded
+ * together first which means no part of the frame is listed twice.
+ */
+int
+gfx_dirty_regions(const struct gfx_rect **regions)
+{
+	struct gfx_rect *a, *b;
+	int	i, j, merged;
+
+	do {
+		merged = 0;
+		for (i = 0; i < __gfx_state.n_dirty; i++) {
+			a = &__gfx_state.dirty[i];
+			for (j = i + 1; j < __gfx_state.n_dirty; j++) {
+				b = &__gfx_state.dirty[j];
+				if ((a->x0 <= b->x1) && (a->x1 >= b->x0) &&
+				    (a->y0 <= b->y1) && (a->y1 >= b->y0)) {
+					gfx_rect_union(a, b->x0, b->y0,
+						       b->x1, b->y1);
+					*b = __gfx_state.dirty[
+						--__gfx_state.n_dirty];
+					merged = 1;
+					j--;
+				}
+			}
+		}
+	} while (merged);
+	__gfx_state.last_dirty = 0;
+	*regions = __gfx_state.dirty;
+	return __gfx_state.n_dirty;
+}
+
+void
+gfx_dirty_clear(void)
+{
+	__gfx_state.n_dirty = 0;
+	__gfx_state.last_dirty = 0;
+}
+
 void
 gfx_drawPixel(int x, int y, uint16_t color)
 {
@@ -54,12 +219,89 @@ gfx_drawPixel(int x, int y, uint16_t color)
 	    (y < 0) || (y >= __gfx_state._height)) {
 		return; /* off screen so don't draw it */
 	}
+	gfx_dirty_add(x, y, x, y);
 	(__gfx_state.drawpixel)(x, y, color);
 }
+
+/*
+ * Draw a pixel that is only partly covered, 'alpha' is how much of
+ * it in 16ths. Without a blend function it is drawn solid if it is
+ * at least half covered.
+ */
+void
+gfx_blendPixel(int x, int y, uint16_t color, uint8_t alpha)
+{
+	if ((x < 0) || (x >= __gfx_state._width) ||
+	    (y < 0) || (y >= __gfx_state._height) || (alpha == 0)) {
+		return;
+	}
+	if ((alpha >= 16) || (__gfx_state.blendpixel == NULL)) {
+		if (alpha >= 8) {
+			gfx_dirty_add(x, y, x, y);
+			(__gfx_state.drawpixel)(x, y, color);
+		}
+		return;
+	}
+	gfx_dirty_add(x, y, x, y);
+	(__gfx_state.blendpixel)(x, y, color, alpha);
+}
+
+void
+gfx_setBlend(void (*blend)(int, int, uint16_t, uint8_t))
+{
+	__gfx_state.blendpixel = blend;
+}
+
+void
+gfx_setRotate(void (*rotate)(uint8_t))
+{
+	__gfx_state.rotate = rotate;
+}
+
+void
+gfx_setFill(void (*fill)(int, int, int, int, uint16_t))
+{
+	__gfx_state.fillrect = fill;
+}
+
+/*
+ * Draw a horizontal run of 'w' pixels. All of the filled primitives
+ * end up here, so the clipping is done once for the whole run and
+ * then the backend gets to write it any way it likes. If it didn't
+ * give us a span function we walk the run with the pixel function.
+ */
+static void
+gfx_drawSpan(int x, int y, int w, uint16_t color)
+{
+	if ((y < 0) || (y >= __gfx_state._height)) {
+		return;
+	}
+	if (x < 0) {
+		w += x;
+		x = 0;
+	}
+	if ((x + w) > __gfx_state._width) {
+		w = __gfx_state._width - x;
+	}
+	if (w <= 0) {
+		return;
+	}
+	gfx_dirty_add(x, y, x + w - 1, y);
+	if (__gfx_state.drawspan) {
+		(__gfx_state.drawspan)(x, y, w, color);
+		return;
+	}
+	while (w--) {
+		(__gfx_state.drawpixel)(x++, y, color);
+	}
+}
 #define true 1
 
 void
-gfx_init(void (*pixel_func)(int, int, uint16_t), int width, int height)
+gfx_init(void (*pixel_func)(int, int, uint16_t),
+	 void (*span_func)(int, int, int, uint16_t),
+	 void (*bitmap_func)(int, int, int, int, const uint16_t *),
+	 int width, int height)
 {
 	__gfx_state._width    = width;
 	__gfx_state._height   = height;
@@ -70,6 +312,12 @@ gfx_init(void (*pixel_func)(int, int, uint16_t), int width, int height)
 	__gfx_state.textbgcolor = 0xFFFF;
 	__gfx_state.wrap      = true;
 	__gfx_state.drawpixel = pixel_func;
+	__gfx_state.drawspan  = span_func;
+	__gfx_state.drawbitmap = bitmap_func;
+	__gfx_state.blendpixel = NULL;
+	__gfx_state.rotate = NULL;
+	__gfx_state.fillrect = NULL;
+	gfx_dirty_clear();
 }
 
 /* Draw a circle outline */
@@ -145,11 +393,59 @@ void gfx_drawCircleHelper(int16_t x0, int16_t y0,
 	}
 }
 
+/*
+ * Same as gfx_fillCircleHelper but on its side, it fills the top (0x2)
+ * and/or bottom (0x1) halves with horizontal spans and stretches them
+ * 'delta' pixels to the right. Each row is only drawn once.
+ */
+static void gfx_fillCircleSpans(int16_t x0, int16_t y0, int16_t r,
+				uint8_t halves, int16_t delta, uint16_t color)
+{
+	int16_t f     = 1 - r;
+	int16_t ddF_x = 1;
+	int16_t ddF_y = -2 * r;
+	int16_t x     = 0;
+	int16_t y     = r;
+	int16_t px    = x;
+	int16_t py    = y;
+
+	delta++;
+	while (x < y) {
+		if (f >= 0) {
+			y--;
+			ddF_y += 2;
+			f     += ddF_y;
+		}
+		x++;
+		ddF_x += 2;
+		f     += ddF_x;
+
+		if (x < (y + 1)) {
+			if (halves & 0x1) {
+				gfx_drawSpan(x0-y, y0+x, 2*y+delta, color);
+			}
+			if (halves & 0x2) {
+				gfx_drawSpan(x0-y, y0-x, 2*y+delta, color);
+			}
+		}
+		if (y != py) {
+			if (halves & 0x1) {
+				gfx_drawSpan(x0-px, y0+py, 2*px+delta, color);
+			}
+			if (halves & 0x2) {
+				gfx_drawSpan(x0-px, y0-py, 2*px+delta, color);
+			}
+			py = y;
+		}
+		px = x;
+	}
+}
+
 void gfx_fillCircle(int16_t x0, int16_t y0, int16_t r,
 		    uint16_t color)
 {
-	gfx_drawFastVLine(x0, y0 - r, 2*r+1, color);
-	gfx_fillCircleHelper(x0, y0, r, 3, 0, color);
+	gfx_drawSpan(x0 - r, y0, 2*r+1, color);
+	gfx_fillCircleSpans(x0, y0, r, 3, 0, color);
 }
 
 /* Used to do circles and roundrects */
@@ -183,12 +479,72 @@ void gfx_fillCircleHelper(int16_t x0, int16_t y0, int16_t r,
 	}
 }
 
-/* Bresenham's algorithm - thx wikpedia */
+/* Cohen-Sutherland outcodes, which side(s) of the screen a point is off */
+#define GFX_OUT_LEFT	1
+#define GFX_OUT_RIGHT	2
+#define GFX_OUT_TOP	4
+#define GFX_OUT_BOTTOM	8
+
+static int gfx_outcode(int x, int y)
+{
+	int	code = 0;
+
+	if (x < 0) {
+		code |= GFX_OUT_LEFT;
+	} else if (x >= __gfx_state._width) {
+		code |= GFX_OUT_RIGHT;
+	}
+	if (y < 0) {
+		code |= GFX_OUT_TOP;
+	} else if (y >= __gfx_state._height) {
+		code |= GFX_OUT_BOTTOM;
+	}
+	return code;
+}
+
+/*
+ * Draw a line as a series of horizontal (or for steep lines vertical)
+ * runs, one span per run rather than one call per pixel. This is the
+ * same Bresenham line as before, pixel for pixel, but the length of
+ * each run is worked out with a divide instead of stepping along it.
+ *
+ * A line with both ends off the same side of the screen is thrown
+ * away up front. For one that is partly off screen we work out which
+ * steps of the line land on the screen and start the walk at the
+ * first of them, so long lines that are mostly off screen are cheap.
+ */
 void gfx_drawLine(int16_t x0, int16_t y0,
 			    int16_t x1, int16_t y1,
 			    uint16_t color)
 {
-	int16_t steep = abs(y1 - y0) > abs(x1 - x0);
+	int	steep, dx, dy, ystep, err, e0, k;
+	int	major, minor, x, y, xend;
+	int32_t	nlo, nhi, mlo, mhi, m;
+
+	if (gfx_outcode(x0, y0) & gfx_outcode(x1, y1)) {
+		return;
+	}
+	/* clamp the ends of these so the length fits in an int16_t */
+	if (y0 == y1) {
+		if (x0 > x1) {
+			swap(x0, x1);
+		}
+		x0 = (x0 < 0) ? 0 : x0;
+		x1 = (x1 >= __gfx_state._width) ? __gfx_state._width - 1 : x1;
+		gfx_drawFastHLine(x0, y0, x1 - x0 + 1, color);
+		return;
+	}
+	if (x0 == x1) {
+		if (y0 > y1) {
+			swap(y0, y1);
+		}
+		y0 = (y0 < 0) ? 0 : y0;
+		y1 = (y1 >= __gfx_state._height) ? __gfx_state._height - 1 : y1;
+		gfx_drawFastVLine(x0, y0, y1 - y0 + 1, color);
+		return;
+	}
+
+	steep = abs(y1 - y0) > abs(x1 - x0);
 	if (steep) {
 		swap(x0, y0);
 		swap(x1, y1);
@@ -199,30 +555,66 @@ void gfx_drawLine(int16_t x0, int16_t y0,
 		swap(y0, y1);
 	}
 
-	int16_t dx, dy;
 	dx = x1 - x0;
 	dy = abs(y1 - y0);
+	ystep = (y0 < y1) ? 1 : -1;
+	e0 = dx / 2;
 
-	int16_t err = dx / 2;
-	int16_t ystep;
-
-	if (y0 < y1) {
-		ystep = 1;
+	/*
+	 * Step n of the line is at x0 + n, and has moved m(n) rows where
+	 * m(n) is the smallest m with e0 - n * dy + m * dx >= 0. Clip n
+	 * to the screen along the major axis and then, using that, to
+	 * the rows that are on the screen along the minor one.
+	 */
+	major = steep ? __gfx_state._height : __gfx_state._width;
+	minor = steep ? __gfx_state._width : __gfx_state._height;
+	nlo = (x0 < 0) ? -x0 : 0;
+	nhi = (x1 >= major) ? major - 1 - x0 : dx;
+	if (ystep > 0) {
+		mlo = -y0;
+		mhi = minor - 1 - y0;
 	} else {
-		ystep = -1;
+		mlo = y0 - (minor - 1);
+		mhi = y0;
+	}
+	if ((mhi < 0) || (mlo > dy)) {
+		return;
+	}
+	if (mlo > 0) {
+		m = ((int64_t) e0 + (int64_t) (mlo - 1) * dx) / dy + 1;
+		if (m > nlo) {
+			nlo = m;
+		}
+	}
+	if (mhi < dy) {
+		m = ((int64_t) e0 + (int64_t) mhi * dx) / dy;
+		if (m < nhi) {
+			nhi = m;
+		}
+	}
+	if (nlo > nhi) {
+		return;
 	}
 
-	for (; x0 <= x1; x0++) {
+	m = ((int64_t) nlo * dy - e0 + dx - 1) / dx;
+	err = e0 - (int64_t) nlo * dy + (int64_t) m * dx;
+	x = x0 + nlo;
+	y = y0 + m * ystep;
+	xend = x0 + nhi;
+
+	while (x <= xend) {
+		k = err / dy + 1;
+		if (x + k - 1 > xend) {
+			k = xend - x + 1;
+		}
 		if (steep) {
-			gfx_drawPixel(y0, x0, color);
+			gfx_drawFastVLine(y, x, k, color);
 		} else {
-			gfx_drawPixel(x0, y0, color);
-		}
-		err -= dy;
-		if (err < 0) {
-			y0 += ystep;
-			err += dx;
+			gfx_drawFastHLine(x, y, k, color);
 		}
+		x += k;
+		err += dx - k * dy;
+		y += ystep;
 	}
 }
 
@@ -240,24 +632,61 @@ void gfx_drawRect(int16_t x, int16_t y,
 void gfx_drawFastVLine(int16_t x, int16_t y,
 		       int16_t h, uint16_t color)
 {
-	/* Update in subclasses if desired! */
-	gfx_drawLine(x, y, x, y + h - 1, color);
+	int	y1 = y + h;
+
+	if ((x < 0) || (x >= __gfx_state._width)) {
+		return;
+	}
+	if (y < 0) {
+		y = 0;
+	}
+	if (y1 > __gfx_state._height) {
+		y1 = __gfx_state._height;
+	}
+	if (y >= y1) {
+		return;
+	}
+	gfx_dirty_add(x, y, x, y1 - 1);
+	while (y < y1) {
+		(__gfx_state.drawpixel)(x, y++, color);
+	}
 }
 
 void gfx_drawFastHLine(int16_t x, int16_t y,
 		       int16_t w, uint16_t color)
 {
-	/* Update in subclasses if desired! */
-	gfx_drawLine(x, y, x + w - 1, y, color);
+	gfx_drawSpan(x, y, w, color);
 }
 
 void gfx_fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
 		  uint16_t color)
 {
-	/* Update in subclasses if desired! */
-	int16_t i;
-	for (i = x; i < x + w; i++) {
-		gfx_drawFastVLine(i, y, h, color);
+	int	y1 = y + h;
+	int	x0 = x, x1 = x + w;
+
+	/* clip the rows here, gfx_drawSpan does the columns */
+	if (y < 0) {
+		y = 0;
+	}
+	if (y1 > __gfx_state._height) {
+		y1 = __gfx_state._height;
+	}
+	if (__gfx_state.fillrect) {
+		/* the backend does it in one go, clip the columns too */
+		if (x0 < 0) {
+			x0 = 0;
+		}
+		if (x1 > __gfx_state._width) {
+			x1 = __gfx_state._width;
+		}
+		if ((x1 > x0) && (y1 > y)) {
+			gfx_dirty_add(x0, y, x1 - 1, y1 - 1);
+			(__gfx_state.fillrect)(x0, y, x1 - x0, y1 - y, color);
+		}
+		return;
+	}
+	while (y < y1) {
+		gfx_drawSpan(x, y++, w, color);
 	}
 }
 
@@ -285,12 +714,19 @@ void gfx_drawRoundRect(int16_t x, int16_t y, int16_t w,
 /* Fill a rounded rectangle */
 void gfx_fillRoundRect(int16_t x, int16_t y, int16_t w,
 		       int16_t h, int16_t r, uint16_t color) {
-	/* smarter version */
-	gfx_fillRect(x + r, y, w - 2 * r, h, color);
+	/* smarter version, the middle band and then the rounded top
+	 * and bottom, all of it drawn as rows.
+	 */
+	if ((r == 1) && ((w == 2) || (h == 2))) {
+		/* no room to cut the corners, it used to come out solid */
+		gfx_fillRect(x, y, w, h, color);
+		return;
+	}
+	gfx_fillRect(x, y + r, w, h - 2 * r, color);
 
 	/* draw four corners */
-	gfx_fillCircleHelper(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
-	gfx_fillCircleHelper(x + r        , y + r, r, 2, h - 2 * r - 1, color);
+	gfx_fillCircleSpans(x + r, y + r        , r, 2, w - 2 * r - 1, color);
+	gfx_fillCircleSpans(x + r, y + h - r - 1, r, 1, w - 2 * r - 1, color);
 }
 
 /* Draw a triangle */
@@ -413,6 +849,95 @@ void gfx_drawBitmap(int16_t x, int16_t y,
 	}
 }
 
+/*
+ * Returns row 'i' (0 - 11) of the glyph for 'c' with the leftmost
+ * pixel in bit 7. Glyphs with a descender start three rows down.
+ */
+static uint8_t gfx_glyph_line(unsigned char c, int i)
+{
+	const unsigned char *glyph = &mcm_font[(c & 0x7f) * 9];
+
+	if (*glyph & 0x80) {
+		i -= 3;
+	}
+	if ((i < 0) || (i > 8)) {
+		return 0;
+	}
+	return *(glyph + i) & 0x7f;
+}
+
+/*
+ * Expand one glyph row into 8 * size pixels at p, returns where
+ * the next pixel goes.
+ */
+static uint16_t *gfx_glyph_row(uint16_t *p, uint8_t line, uint8_t size,
+			       uint16_t color, uint16_t bg)
+{
+	int	j, k;
+
+	for (j = 0; j < 8; j++, line <<= 1) {
+		for (k = 0; k < size; k++) {
+			*p++ = (line & 0x80) ? color : bg;
+		}
+	}
+	return p;
+}
+
+/*
+ * Find the expanded glyph in the cache, or build it in the slot
+ * that was used longest ago.
+ */
+static const uint16_t *gfx_glyph_lookup(unsigned char c, uint16_t color,
+					uint16_t bg, uint8_t size)
+{
+	struct gfx_glyph *g, *lru;
+	uint16_t	*p;
+	int	i, k, w;
+
+	c &= 0x7f;
+	glyph_clock++;
+	lru = &glyph_cache[0];
+	for (i = 0; i < GFX_GLYPH_CACHE; i++) {
+		g = &glyph_cache[i];
+		if ((g->size == size) && (g->c == c) &&
+		    (g->color == color) && (g->bg == bg)) {
+			g->used = glyph_clock;
+			return g->pixels;
+		}
+		if (g->used < lru->used) {
+			lru = g;
+		}
+	}
+
+	g = lru;
+	g->c = c;
+	g->color = color;
+	g->bg = bg;
+	g->size = size;
+	g->used = glyph_clock;
+	w = 8 * size;
+	p = g->pixels;
+	for (i = 0; i < 12; i++) {
+		p = gfx_glyph_row(p, gfx_glyph_line(c, i), size, color, bg);
+		for (k = 1; k < size; k++) {
+			memcpy(p, p - w, w * sizeof(uint16_t));
+			p += w;
+		}
+	}
+	return g->pixels;
+}
+
+static void gfx_advance(int n)
+{
+	__gfx_state.cursor_x += n * __gfx_state.textsize * 8;
+	if (__gfx_state.wrap &&
+	    (__gfx_state.cursor_x > (__gfx_state._width -
+				     __gfx_state.textsize*8))) {
+		__gfx_state.cursor_y += __gfx_state.textsize * 12;
+		__gfx_state.cursor_x = 0;
+	}
+}
+
 void gfx_write(uint8_t c)
 {
 	if (c == '\n') {
@@ -424,65 +949,114 @@ void gfx_write(uint8_t c)
 		gfx_drawChar(__gfx_state.cursor_x, __gfx_state.cursor_y,
 			     c, __gfx_state.textcolor, __gfx_state.textbgcolor,
 			     __gfx_state.textsize);
-		__gfx_state.cursor_x += __gfx_state.textsize * 8;
-		if (__gfx_state.wrap &&
-		    (__gfx_state.cursor_x > (__gfx_state._width -
-					     __gfx_state.textsize*8))) {
-			__gfx_state.cursor_y += __gfx_state.textsize * 12;
-			__gfx_state.cursor_x = 0;
-		}
+		gfx_advance(1);
 	}
 }
 
+/*
+ * Returns how many characters from s can be drawn at the cursor as
+ * a single block, that is, opaque text that is entirely on screen
+ * and stops at the end of the line.
+ */
+static int gfx_line_run(const char *s)
+{
+	int	size = __gfx_state.textsize;
+	int	x = __gfx_state.cursor_x;
+	int	y = __gfx_state.cursor_y;
+	int	n = 0;
+
+	if ((__gfx_state.drawbitmap == NULL) ||
+	    (__gfx_state.textcolor == __gfx_state.textbgcolor) ||
+	    (x < 0) || (y < 0) || (y + 12 * size > __gfx_state._height)) {
+		return 0;
+	}
+	while ((s[n] != '\0') && (s[n] != '\n') && (s[n] != '\r') &&
+	       (x + (n + 1) * 8 * size <= __gfx_state._width)) {
+		n++;
+	}
+	return n;
+}
+
+/*
+ * Puts the string at the cursor. Opaque text is drawn a line at a
+ * time, each row of pixels across all of the characters is built
+ * once and handed to the backend as one block.
+ */
 void gfx_puts(char *s)
 {
+	int	n, i, k, r, w;
+	int	size = __gfx_state.textsize;
+	uint16_t *p;
+
 	while (*s) {
-		gfx_write(*s);
-		s++;
+		n = gfx_line_run(s);
+		if (n < 2) {
+			gfx_write(*s);
+			s++;
+			continue;
+		}
+		w = n * 8 * size;
+		for (i = 0; i < 12; i++) {
+			p = gfx_row;
+			for (k = 0; k < n; k++) {
+				p = gfx_glyph_row(p, gfx_glyph_line(s[k], i),
+						  size,
+						  __gfx_state.textcolor,
+						  __gfx_state.textbgcolor);
+			}
+			for (r = 0; r < size; r++) {
+				(__gfx_state.drawbitmap)(
+					__gfx_state.cursor_x,
+					__gfx_state.cursor_y + i * size + r,
+					w, 1, gfx_row);
+			}
+		}
+		gfx_dirty_add(__gfx_state.cursor_x, __gfx_state.cursor_y,
+			      __gfx_state.cursor_x + w - 1,
+			      __gfx_state.cursor_y + 12 * size - 1);
+		gfx_advance(n);
+		s += n;
 	}
 }
 
-/* Draw a character */
+/*
+ * Draw a character. Opaque characters that are on screen are copied
+ * from the glyph cache in one go, anything else is drawn as runs of
+ * pixels that are the same colour.
+ */
 void gfx_drawChar(int16_t x, int16_t y, unsigned char c,
 		  uint16_t color, uint16_t bg, uint8_t size)
 {
-	int8_t i, j, line;
-	int8_t descender;
-	unsigned const char *glyph;
+	int	i, j, k;
+	int	w = 8 * size;
+	int	h = 12 * size;
+	uint8_t	line, set;
 
-	glyph = &mcm_font[(c & 0x7f) * 9];
-
-	descender = (*glyph & 0x80) != 0;
+	if ((bg != color) && (__gfx_state.drawbitmap != NULL) &&
+	    (size <= GFX_GLYPH_MAX_SIZE) && (x >= 0) && (y >= 0) &&
+	    (x + w <= __gfx_state._width) && (y + h <= __gfx_state._height)) {
+		gfx_dirty_add(x, y, x + w - 1, y + h - 1);
+		(__gfx_state.drawbitmap)(x, y, w, h,
+					 gfx_glyph_lookup(c, color, bg, size));
+		return;
+	}
 
 	for (i = 0; i < 12; i++) {
-		line = 0x00;
-		if (descender) {
-			if (i > 2) {
-				line = *(glyph + (i - 3));
-			}
-		} else {
-			if (i < 9) {
-				line = *(glyph + i);
-			}
-		}
-		line &= 0x7f;
-		for (j = 0; j < 8; j++) {
-			if (line & 0x80) {
-				if (size == 1) /* default size */
-					gfx_drawPixel(x+j, y+i, color);
-				else {  /* big size */
-					gfx_fillRect(x+(j*size), y+(i*size),
-						     size, size, color);
+		line = gfx_glyph_line(c, i);
+		for (j = 0; j < 8; j = k) {
+			set = (line << j) & 0x80;
+			for (k = j + 1; k < 8; k++) {
+				if (((line << k) & 0x80) != set) {
+					break;
 				}
+			}
+			if (set) {
+				gfx_fillRect(x + j * size, y + i * size,
+					     (k - j) * size, size, color);
 			} else if (bg != color) {
-				if (size == 1) /* default size */
-					gfx_drawPixel(x+j, y+i, bg);
-				else {  /* big size */
-					gfx_fillRect(x+j*size, y+i*size,
-						     size, size, bg);
-				}
+				gfx_fillRect(x + j * size, y + i * size,
+					     (k - j) * size, size, bg);
 			}
-			line <<= 1;
 		}
 	}
 }
@@ -514,20 +1088,28 @@ uint8_t gfx_getRotation(void)
 	return __gfx_state.rotation;
 }
 
+/*
+ * Rotating doesn't change how anything is drawn, the primitives keep
+ * working in coordinates on the rotated screen so a span is still a
+ * span. Turning those into display coordinates is up to the backend,
+ * which is told about it here. Anything already on the dirty list is
+ * in the old coordinates, so it is dropped and the backend is
+ * expected to send the next frame whole.
+ */
 void gfx_setRotation(uint8_t x)
 {
-	__gfx_state.rotation = (x & 3);
-	switch (__gfx_state.rotation) {
-	case 0:
-	case 2:
-		__gfx_state._width  = GFX_WIDTH;
-		__gfx_state._height = GFX_HEIGHT;
-		break;
-	case 1:
-	case 3:
-		__gfx_state._width  = GFX_HEIGHT;
-		__gfx_state._height = GFX_WIDTH;
-		break;
+	int16_t	t;
+
+	x &= 3;
+	if ((x ^ __gfx_state.rotation) & 1) {
+		t = __gfx_state._width;
+		__gfx_state._width = __gfx_state._height;
+		__gfx_state._height = t;
+	}
+	__gfx_state.rotation = x;
+	gfx_dirty_clear();
+	if (__gfx_state.rotate) {
+		(__gfx_state.rotate)(x);
 	}
 }
 
@@ -21,7 +21,9 @@ void gfx_drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
 void gfx_drawCircleHelper(int16_t x0, int16_t y0, int16_t r,
 			  uint8_t cornername, uint16_t color);
 void gfx_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
-void gfx_init(void (*draw)(int, int, uint16_t), int, int);
+void gfx_init(void (*draw)(int, int, uint16_t),
+	      void (*span)(int, int, int, uint16_t),
+	      void (*bitmap)(int, int, int, int, const uint16_t *), int, int);
 
 void gfx_fillCircleHelper(int16_t x0, int16_t y0, int16_t r,
 			  uint8_t cornername, int16_t delta, uint16_t color);
@@ -48,8 +50,123 @@ void gfx_write(uint8_t);
 uint16_t gfx_height(void);
 uint16_t gfx_width(void);
 
+void gfx_blendPixel(int x, int y, uint16_t color, uint8_t alpha);
+void gfx_setBlend(void (*blend)(int, int, uint16_t, uint8_t));
+void gfx_setRotate(void (*rotate)(uint8_t));
+void gfx_setFill(void (*fill)(int, int, int, int, uint16_t));
+
+/*
+ * Polygons, thick lines and arcs (gfx-poly.c). These are scan
+ * converted into spans, if a blend function has been set with
+ * gfx_setBlend() their edges are anti-aliased by sampling each pixel
+ * 4 x 4 times (4 bit coverage), otherwise a pixel is drawn if it is
+ * at least half covered.
+ *
+ * Polygons may be concave or cross themselves (non-zero winding) and
+ * are limited to GFX_POLY_MAX_POINTS points, more than that and
+ * nothing is drawn. Arc angles are in degrees, clockwise from 12
+ * o'clock, and a thickness of more than r draws a pie slice.
+ *
+ * Cost, so a frame can be budgeted:
+ *  gfx_fillPolygon  - for each line covered, one pass over the edges
+ *                     crossing it plus one span per inside run. With
+ *                     blending it is four passes per line plus one
+ *                     pass over the width covered.
+ *  gfx_drawThickLine - same as a four point polygon.
+ *  gfx_drawArc      - a square root for each pixel in the ring plus a
+ *                     span per solid run.
+ *
+ * Measured with poly-bench.c on a Xeon host, drawing into the lcd-spi.c
+ * frame, in us per call (best of 5 runs of 1000 calls, and the runs
+ * still vary by about a third):
+ *
+ *                                          aliased  blended
+ *  ten point star, r = 100                    10       65
+ *  thick line, 5 wide and 370 long             8       35
+ *  arc, 240 degrees of r = 100, 12 wide      110      150
+ *  the gauge on the first screen             100      110
+ *
+ * Only the ratios carry over to the board, time the calls there with
+ * the DWT cycle counter for real figures.
+ */
+#define GFX_POLY_MAX_POINTS	16
+
+struct gfx_point {
+	int16_t x, y;
+};
+
+void gfx_fillPolygon(const struct gfx_point *pts, int n, uint16_t color);
+void gfx_drawThickLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+		       int16_t width, uint16_t color);
+void gfx_drawArc(int16_t x0, int16_t y0, int16_t r, int16_t thickness,
+		 int16_t start, int16_t end, uint16_t color);
+
+/*
+ * Images kept in flash (gfx-image.c), made from PNG files with
+ * png2gfx.py. Pixels and palette entries are stored the way the
+ * backend keeps them in the frame (byte swapped for lcd-spi.c).
+ *
+ *  GFX_IMAGE_RGB565 - w * h pixels, row after row.
+ *  GFX_IMAGE_RLE565 - each row is a list of packets. A count with
+ *                     bit 15 set is a run of (count & 0x7fff) copies
+ *                     of the pixel after it, otherwise that many
+ *                     pixels follow to be copied as is. Packets don't
+ *                     go past the end of a row.
+ *  GFX_IMAGE_PAL8   - one byte per pixel, an index into 'palette'.
+ *  GFX_IMAGE_PAL4   - two pixels per byte, the left one in the top
+ *                     4 bits, each row starts on a new byte.
+ *
+ * With GFX_IMAGE_KEYED set pixels matching 'key' (the pixel value,
+ * or for the palette formats the index) are transparent. Drawing
+ * costs a pass over the visible part of each row plus one bitmap
+ * call for each run of opaque pixels.
+ */
+#define GFX_IMAGE_RGB565	0
+#define GFX_IMAGE_RLE565	1
+#define GFX_IMAGE_PAL8		2
+#define GFX_IMAGE_PAL4		3
+
+#define GFX_IMAGE_KEYED		0x01
+
+struct gfx_image {
+	uint16_t	w, h;
+	uint8_t		format, flags;
+	uint16_t	key;
+	const uint16_t	*palette;
+	const void	*data;
+};
+
+void gfx_drawImage(int16_t x, int16_t y, const struct gfx_image *img);
+
 uint8_t gfx_getRotation(void);
 
+/*
+ * Dirty region tracking. Everything drawn through the gfx code is
+ * recorded as a short list of bounding boxes (inclusive corners) so
+ * the display code can send just the parts of the frame that changed.
+ * Boxes that touch are merged, and once the list is full new boxes
+ * are merged into whichever box grows the least.
+ */
+#define GFX_MAX_DIRTY	8
+
+struct gfx_rect {
+	int16_t x0, y0, x1, y1;
+};
+
+void gfx_mark_dirty(int x, int y, int w, int h);
+int gfx_dirty_regions(const struct gfx_rect **regions);
+void gfx_dirty_clear(void);
+
+/*
+ * Opaque text is drawn from a small cache of glyphs already expanded
+ * to 16 bit pixels for a given character, colours and size, and the
+ * least recently used one is thrown out to make room. Bigger text
+ * than GFX_GLYPH_MAX_SIZE is not cached.
+ */
+#define GFX_GLYPH_CACHE		8
+#define GFX_GLYPH_MAX_SIZE	3
+
+/* the longest row the screen has, in any rotation */
 #define GFX_WIDTH   320
 #define GFX_HEIGHT  240
 
@@ -59,6 +176,40 @@ struct gfx_state {
 	uint8_t textsize, rotation;
 	uint8_t wrap;
 	void (*drawpixel)(int, int, uint16_t);
+	/*
+	 * Optional, draws 'w' pixels starting at x, y going right. The
+	 * span is already clipped to the screen when this is called so
+	 * the backend can just store them. If NULL the gfx code falls
+	 * back to calling drawpixel for each pixel.
+	 */
+	void (*drawspan)(int, int, int, uint16_t);
+	/*
+	 * Optional, copies a 'w' by 'h' block of pixels (row after row)
+	 * to x, y. Only called with blocks that are entirely on the
+	 * screen. If NULL text is drawn a span at a time instead.
+	 */
+	void (*drawbitmap)(int, int, int, int, const uint16_t *);
+	/*
+	 * Optional, fills a 'w' by 'h' rectangle at x, y with 'color'.
+	 * Like the bitmap it is only called with rectangles that are
+	 * entirely on the screen. If NULL rectangles are drawn a span
+	 * at a time.
+	 */
+	void (*fillrect)(int, int, int, int, uint16_t);
+	/*
+	 * Optional, mixes 'color' into the pixel at x, y that is already
+	 * in the frame, 'alpha' (1 - 15) is how much of it in 16ths.
+	 */
+	void (*blendpixel)(int, int, uint16_t, uint8_t);
+	/*
+	 * Optional, called by gfx_setRotation() with the new rotation
+	 * (0 - 3). Everything above is always called with coordinates
+	 * on the rotated screen, the backend has to map them on to the
+	 * display. If NULL only the width and height are swapped.
+	 */
+	void (*rotate)(uint8_t);
+	struct gfx_rect dirty[GFX_MAX_DIRTY];
+	uint8_t n_dirty, last_dirty;
 };
 
 extern struct gfx_state __gfx_state;
@@ -0,0 +1,22 @@
+/* made from image-test.png by png2gfx.py, 13 x 7 pal4, 69 bytes */
+#include <stddef.h>
+#include <stdint.h>
+#include "gfx.h"
+
+static const uint16_t test_pal4_palette[] = {
+	0x0000, 0x0000, 0x00f8, 0x00fc, 0x1f00, 0x1ff8, 0xe007, 0xe0ff,
+	0xff07, 0xffff,
+};
+
+static const uint8_t test_pal4_data[] = {
+	0x00, 0x02, 0x22, 0x26, 0x46, 0x40, 0x00, 0x20, 0x60, 0x40, 0x99, 0x99,
+	0x90, 0x70, 0x77, 0x77, 0x77, 0x77, 0x77, 0x77, 0x70, 0x10, 0x00, 0x00,
+	0x00, 0x18, 0x58, 0x50, 0x85, 0x85, 0x85, 0x85, 0x85, 0x85, 0x80, 0x22,
+	0x20, 0x00, 0x66, 0x60, 0x00, 0x30, 0x04, 0x44, 0x44, 0x44, 0x44, 0x44,
+	0x00,
+};
+
+const struct gfx_image test_pal4 = {
+	13, 7, GFX_IMAGE_PAL4, GFX_IMAGE_KEYED, 0x0000,
+	test_pal4_palette, test_pal4_data
+};
@@ -0,0 +1,25 @@
+/* made from image-test.png by png2gfx.py, 13 x 7 pal8, 111 bytes */
+#include <stddef.h>
+#include <stdint.h>
+#include "gfx.h"
+
+static const uint16_t test_pal8_palette[] = {
+	0x0000, 0x0000, 0x00f8, 0x00fc, 0x1f00, 0x1ff8, 0xe007, 0xe0ff,
+	0xff07, 0xffff,
+};
+
+static const uint8_t test_pal8_data[] = {
+	0x00, 0x00, 0x00, 0x02, 0x02, 0x02, 0x02, 0x06, 0x04, 0x06, 0x04, 0x00,
+	0x00, 0x02, 0x00, 0x06, 0x00, 0x04, 0x00, 0x09, 0x09, 0x09, 0x09, 0x09,
+	0x00, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
+	0x07, 0x07, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+	0x08, 0x05, 0x08, 0x05, 0x08, 0x05, 0x08, 0x05, 0x08, 0x05, 0x08, 0x05,
+	0x08, 0x05, 0x08, 0x05, 0x08, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00, 0x06,
+	0x06, 0x06, 0x00, 0x00, 0x00, 0x03, 0x00, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00,
+};
+
+const struct gfx_image test_pal8 = {
+	13, 7, GFX_IMAGE_PAL8, GFX_IMAGE_KEYED, 0x0000,
+	test_pal8_palette, test_pal8_data
+};
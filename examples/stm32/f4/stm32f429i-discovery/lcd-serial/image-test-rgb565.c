@@ -0,0 +1,24 @@
+/* made from image-test.png by png2gfx.py, 13 x 7 rgb565, 182 bytes */
+#include <stddef.h>
+#include <stdint.h>
+#include "gfx.h"
+
+static const uint16_t test_rgb565_data[] = {
+	0x0001, 0x0001, 0x0001, 0x00f8, 0x00f8, 0x00f8, 0x00f8, 0xe007,
+	0x1f00, 0xe007, 0x1f00, 0x0001, 0x0001, 0x00f8, 0x0001, 0xe007,
+	0x0001, 0x1f00, 0x0001, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
+	0x0001, 0xe0ff, 0xe0ff, 0xe0ff, 0xe0ff, 0xe0ff, 0xe0ff, 0xe0ff,
+	0xe0ff, 0xe0ff, 0xe0ff, 0xe0ff, 0xe0ff, 0xe0ff, 0xe0ff, 0x0000,
+	0x0001, 0x0001, 0x0001, 0x0001, 0x0001, 0x0001, 0x0001, 0x0000,
+	0xff07, 0x1ff8, 0xff07, 0x1ff8, 0xff07, 0x1ff8, 0xff07, 0x1ff8,
+	0xff07, 0x1ff8, 0xff07, 0x1ff8, 0xff07, 0x1ff8, 0xff07, 0x1ff8,
+	0xff07, 0x00f8, 0x00f8, 0x00f8, 0x0001, 0x0001, 0x0001, 0xe007,
+	0xe007, 0xe007, 0x0001, 0x0001, 0x0001, 0x00fc, 0x0001, 0x1f00,
+	0x1f00, 0x1f00, 0x1f00, 0x1f00, 0x1f00, 0x1f00, 0x1f00, 0x1f00,
+	0x1f00, 0x1f00, 0x0001,
+};
+
+const struct gfx_image test_rgb565 = {
+	13, 7, GFX_IMAGE_RGB565, GFX_IMAGE_KEYED, 0x0001,
+	NULL, test_rgb565_data
+};
@@ -0,0 +1,21 @@
+/* made from image-test.png by png2gfx.py, 13 x 7 rle565, 130 bytes */
+#include <stddef.h>
+#include <stdint.h>
+#include "gfx.h"
+
+static const uint16_t test_rle565_data[] = {
+	0x8003, 0x0001, 0x8004, 0x00f8, 0x0006, 0xe007, 0x1f00, 0xe007,
+	0x1f00, 0x0001, 0x0001, 0x0006, 0x00f8, 0x0001, 0xe007, 0x0001,
+	0x1f00, 0x0001, 0x8005, 0xffff, 0x0002, 0x0001, 0xe0ff, 0x800d,
+	0xe0ff, 0x0001, 0x0000, 0x8007, 0x0001, 0x0005, 0x0000, 0xff07,
+	0x1ff8, 0xff07, 0x1ff8, 0x000d, 0xff07, 0x1ff8, 0xff07, 0x1ff8,
+	0xff07, 0x1ff8, 0xff07, 0x1ff8, 0xff07, 0x1ff8, 0xff07, 0x1ff8,
+	0xff07, 0x8003, 0x00f8, 0x8003, 0x0001, 0x8003, 0xe007, 0x8003,
+	0x0001, 0x0001, 0x00fc, 0x0001, 0x0001, 0x800b, 0x1f00, 0x0001,
+	0x0001,
+};
+
+const struct gfx_image test_rle565 = {
+	13, 7, GFX_IMAGE_RLE565, GFX_IMAGE_KEYED, 0x0001,
+	NULL, test_rle565_data
+};
@@ -0,0 +1,202 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host check of gfx_drawImage() (gfx-image.c). image-test.png, a
+ * 13 x 7 picture with single transparent pixels, transparent runs and
+ * runs of colour at both ends of its rows, is made into each of the
+ * formats with
+ *
+ *     ./png2gfx.py -f rgb565 -n test_rgb565 image-test.png \
+ *		> image-test-rgb565.c
+ *
+ * and the same for rle565, pal8 and pal4. Each is drawn on a small
+ * screen at every position from just off its top left corner to just
+ * off its bottom right one, so it is clipped on each side and each
+ * pair of sides, and on a screen smaller than the image, clipped on
+ * all four at once. It is drawn keyed and, with the flag cleared, not,
+ * and through a bitmap function and through drawpixel alone.
+ *
+ * What has to come out is worked out a pixel at a time from the
+ * RGB565 image, whose data is just the pixels: a pixel matching its
+ * key is left alone when keyed, and is the format's own key colour
+ * (the pixel, or palette entry 0) when not. The backend also checks
+ * it is only handed pixels on the screen, and the dirty region has to
+ * be the part of the image on the screen. The program exits non-zero
+ * if anything doesn't match.
+ *
+ *     make HOST=1 check
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "gfx.h"
+
+#include "image-test-rgb565.c"
+#include "image-test-rle565.c"
+#include "image-test-pal8.c"
+#include "image-test-pal4.c"
+
+#define BACKGROUND	0x5a5a	/* not in the image */
+
+static const struct gfx_image *const images[] = {
+	&test_rgb565, &test_rle565, &test_pal8, &test_pal4,
+};
+
+static const char *const names[] = { "rgb565", "rle565", "pal8", "pal4" };
+
+static const struct {
+	int	w, h;
+} screens[] = {
+	{ 24, 12 },
+	{ 9, 5 },
+};
+
+static uint16_t	screen[16][32], expect[16][32];
+static int	screen_w, screen_h, off_screen;
+
+static void put_pixel(int x, int y, uint16_t color)
+{
+	if ((x < 0) || (y < 0) || (x >= screen_w) || (y >= screen_h)) {
+		off_screen++;
+		return;
+	}
+	screen[y][x] = color;
+}
+
+static void put_bitmap(int x, int y, int w, int h, const uint16_t *p)
+{
+	int	i, j;
+
+	if ((x < 0) || (y < 0) || (x + w > screen_w) || (y + h > screen_h)) {
+		off_screen++;
+		return;
+	}
+	for (j = 0; j < h; j++) {
+		for (i = 0; i < w; i++) {
+			screen[y + j][x + i] = *p++;
+		}
+	}
+}
+
+/* 'img' drawn at x, y a pixel at a time from test_rgb565 */
+static void reference(const struct gfx_image *img, int x, int y)
+{
+	const uint16_t	*src = test_rgb565.data;
+	uint16_t	v;
+	int		i, j;
+
+	for (j = 0; j < test_rgb565.h; j++) {
+		for (i = 0; i < test_rgb565.w; i++) {
+			v = *src++;
+			if ((x + i < 0) || (y + j < 0) ||
+			    (x + i >= screen_w) || (y + j >= screen_h)) {
+				continue;
+			}
+			if (v == test_rgb565.key) {
+				if (img->flags & GFX_IMAGE_KEYED) {
+					continue;
+				}
+				v = img->palette ? img->palette[0] : img->key;
+			}
+			expect[y + j][x + i] = v;
+		}
+	}
+}
+
+/* the dirty region has to be the part of the image on the screen */
+static int dirty_wrong(const struct gfx_image *img, int x, int y)
+{
+	const struct gfx_rect	*r;
+	int			x0 = x < 0 ? 0 : x;
+	int			y0 = y < 0 ? 0 : y;
+	int			x1 = x + img->w - 1;
+	int			y1 = y + img->h - 1;
+	int			n = gfx_dirty_regions(&r);
+
+	x1 = x1 >= screen_w ? screen_w - 1 : x1;
+	y1 = y1 >= screen_h ? screen_h - 1 : y1;
+	if ((x0 > x1) || (y0 > y1)) {
+		return n != 0;
+	}
+	return (n != 1) || (r->x0 != x0) || (r->y0 != y0) ||
+	       (r->x1 != x1) || (r->y1 != y1);
+}
+
+/*
+ * Draws 'img' everywhere on the current screen, returns how many of
+ * the positions came out wrong.
+ */
+static int check(const struct gfx_image *img, int bitmap)
+{
+	int	x, y, i, j, wrong = 0;
+
+	for (y = -img->h - 1; y <= screen_h + 1; y++) {
+		for (x = -img->w - 1; x <= screen_w + 1; x++) {
+			for (j = 0; j < screen_h; j++) {
+				for (i = 0; i < screen_w; i++) {
+					screen[j][i] = BACKGROUND;
+					expect[j][i] = BACKGROUND;
+				}
+			}
+			gfx_init(put_pixel, NULL, bitmap ? put_bitmap : NULL,
+				 screen_w, screen_h);
+			off_screen = 0;
+			gfx_drawImage(x, y, img);
+			reference(img, x, y);
+			if (off_screen || dirty_wrong(img, x, y) ||
+			    memcmp(screen, expect, sizeof(screen))) {
+				wrong++;
+			}
+		}
+	}
+	return wrong;
+}
+
+int main(void)
+{
+	struct gfx_image	img;
+	unsigned		i, s;
+	int			keyed, bitmap, wrong, failed = 0;
+
+	for (i = 0; i < sizeof(images) / sizeof(images[0]); i++) {
+		for (keyed = 1; keyed >= 0; keyed--) {
+			img = *images[i];
+			if (!keyed) {
+				img.flags &= ~GFX_IMAGE_KEYED;
+			}
+			wrong = 0;
+			for (s = 0; s < sizeof(screens) / sizeof(screens[0]);
+			     s++) {
+				screen_w = screens[s].w;
+				screen_h = screens[s].h;
+				for (bitmap = 0; bitmap < 2; bitmap++) {
+					wrong += check(&img, bitmap);
+				}
+			}
+			printf("%-7s %-7s %s\n", names[i],
+			       keyed ? "keyed" : "opaque",
+			       wrong ? "wrong" : "ok");
+			if (wrong) {
+				printf("  %d positions wrong\n", wrong);
+				failed = 1;
+			}
+		}
+	}
+	return failed;
+}
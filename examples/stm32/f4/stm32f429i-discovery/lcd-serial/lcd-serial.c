@@ -44,7 +44,10 @@ int main(void)
 	console_puts("Should have a checker pattern, press any key to proceed\n");
 	msleep(2000);
 /*	(void) console_getc(1); */
-	gfx_init(lcd_draw_pixel, 240, 320);
+	gfx_init(lcd_draw_pixel, lcd_draw_span, lcd_draw_bitmap, 240, 320);
+	gfx_setBlend(lcd_blend_pixel);
+	gfx_setFill(lcd_fill_rect);
+	gfx_setRotate(lcd_set_rotation);
 	gfx_fillScreen(LCD_GREY);
 	gfx_fillRoundRect(10, 10, 220, 220, 5, LCD_WHITE);
 	gfx_drawRoundRect(10, 10, 220, 220, 5, LCD_RED);
@@ -59,7 +62,12 @@ int main(void)
 	gfx_puts("Simple example to put some");
 	gfx_setCursor(15, 60);
 	gfx_puts("stuff on the LCD screen.");
-	lcd_show_frame();
+	/* a gauge, smooth edges come from gfx_setBlend() above */
+	gfx_drawArc(120, 150, 60, 10, 240, 120, LCD_BLUE);
+	gfx_drawArc(120, 150, 60, 10, 60, 120, LCD_RED);
+	gfx_drawThickLine(120, 150, 160, 115, 4, LCD_BLACK);
+	gfx_fillCircle(120, 150, 6, LCD_BLACK);
+	lcd_show_dirty();
 	console_puts("Now it has a bit of structured graphics.\n");
 	console_puts("Press a key for some simple animation.\n");
 	msleep(2000);
@@ -87,6 +95,7 @@ int main(void)
 		p1 = (p1 + 3) % 360;
 		p2 = (p2 + 2) % 360;
 		p3 = (p3 + 1) % 360;
-		lcd_show_frame();
+		/* every pixel is redrawn, so send it all while drawing the next */
+		lcd_show_frame_async(NULL);
 	}
 }
@@ -21,25 +21,89 @@
  * Initialize the ST Micro TFT Display using the SPI port
  */
 #include <stdint.h>
+#include <string.h>
 #include <libopencm3/stm32/spi.h>
 #include <libopencm3/stm32/rcc.h>
 #include <libopencm3/stm32/gpio.h>
+#include <libopencm3/stm32/dma.h>
 #include <libopencm3/cm3/nvic.h>
 #include "console.h"
 #include "clock.h"
 #include "sdram.h"
 #include "lcd-spi.h"
+#include "gfx.h"
+#include "dma2d.h"
 
 
 /* forward prototypes for some helper functions */
 static int print_decimal(int v);
+#ifdef LCD_INIT_LOG
 static int print_hex(int v);
+#endif
 
 /* Simple double buffering, one frame is displayed, the
  * other being built.
  */
 uint16_t *cur_frame;
 uint16_t *display_frame;
+static struct sdram_pool lcd_frames;
+
+/*
+ * State for sending a frame with DMA. SPI5 TX is request channel 2
+ * on DMA2 stream 4. One DMA transfer can only move 65,535 items so
+ * the frame goes out as a chain of chunks, the interrupt handler
+ * starts the next chunk when the current one completes. A box out of
+ * the frame goes the same way, a row (or more) to a chunk, stepping
+ * over the rest of the frame's row in between.
+ */
+#define LCD_DMA		DMA2
+#define LCD_DMA_STREAM	DMA_STREAM4
+#define LCD_DMA_CHANNEL	DMA_SxCR_CHSEL_2
+#define LCD_DMA_CHUNK	65535
+
+static const uint8_t	*dma_next;	/* next byte to send */
+static uint32_t		dma_remaining;	/* bytes of this row not yet sent */
+static uint32_t		dma_width;	/* bytes in a row */
+static uint32_t		dma_skip;	/* from the end of a row to the next */
+static int		dma_rows;	/* rows after this one */
+static void		(*dma_done)(void);
+static volatile int	dma_busy;
+
+/*
+ * The frame is kept row after row the way the gfx code sees the
+ * screen in the current rotation, 'frame_w' pixels to a row, and the
+ * display is told which way round to scan it with the memory access
+ * control (0x36) register. That way a span is a run of neighbouring
+ * words in SDRAM in every rotation, rather than a column with a
+ * stride of a whole row in landscape, and turning the screen costs
+ * nothing per pixel. 'frame_madctl' is what the frame being drawn
+ * needs, 'lcd_madctl' is what the display was last sent.
+ */
+#define MADCTL_MY	0x80	/* rows bottom to top */
+#define MADCTL_MX	0x40	/* columns right to left */
+#define MADCTL_MV	0x20	/* rows and columns exchanged */
+#define MADCTL_BGR	0x08
+
+static const uint8_t	lcd_rotation[4] = {
+	MADCTL_BGR,
+	MADCTL_MX | MADCTL_MV | MADCTL_BGR,
+	MADCTL_MX | MADCTL_MY | MADCTL_BGR,
+	MADCTL_MY | MADCTL_MV | MADCTL_BGR,
+};
+
+/*
+ * Fills and copies smaller than this many pixels are done by the CPU,
+ * for those setting up the DMA2D takes longer than doing them.
+ */
+#define LCD_DMA2D_MIN	64
+
+/* Flash can't change under a queued copy, RAM (a row buffer) can. */
+#define IN_FLASH(p)	((((uint32_t) (p)) >> 24) == 0x08)
+
+static int	frame_w = LCD_WIDTH;
+static int	frame_h = LCD_HEIGHT;
+static uint8_t	frame_madctl = MADCTL_BGR;
+static uint8_t	lcd_madctl = MADCTL_BGR;
 
 
 /*
@@ -50,7 +114,101 @@ uint16_t *display_frame;
 void
 lcd_draw_pixel(int x, int y, uint16_t color)
 {
-	*(cur_frame + x + y * LCD_WIDTH) = color;
+	dma2d_wait();
+	*(cur_frame + x + y * frame_w) = color;
+}
+
+/*
+ * Drawing a span is the same thing for 'w' pixels in a row. Once
+ * the address is 32 bit aligned we store two pixels at a time which
+ * halves the number of writes going out to the SDRAM. The gfx code
+ * has already clipped the span to the screen.
+ */
+void
+lcd_draw_span(int x, int y, int w, uint16_t color)
+{
+	uint16_t	*p = cur_frame + x + y * frame_w;
+	uint32_t	*pp;
+	uint32_t	c2 = ((uint32_t) color << 16) | color;
+
+	dma2d_wait();
+	if ((((uint32_t) p) & 2) && (w > 0)) {
+		*p++ = color;
+		w--;
+	}
+	pp = (uint32_t *) p;
+	while (w >= 2) {
+		*pp++ = c2;
+		w -= 2;
+	}
+	if (w) {
+		*(uint16_t *) pp = color;
+	}
+}
+
+/*
+ * Fill a 'w' by 'h' rectangle of the frame, this is the fill function
+ * for gfx_setFill(). Anything big enough is handed to the DMA2D and
+ * we return while it is being done.
+ */
+void
+lcd_fill_rect(int x, int y, int w, int h, uint16_t color)
+{
+	if (w * h < LCD_DMA2D_MIN) {
+		while (h--) {
+			lcd_draw_span(x, y++, w, color);
+		}
+		return;
+	}
+	dma2d_fill(cur_frame + x + y * frame_w, frame_w, w, h,
+		   DMA2D_RGB565, color);
+}
+
+/*
+ * Copy a 'w' by 'h' block of pixels into the frame one row at a
+ * time, this is how text gets drawn. Again the gfx code only hands
+ * us blocks that are on the screen. A big block out of flash (an
+ * image) is copied by the DMA2D, one in RAM may be changed as soon
+ * as we return so the CPU does it.
+ */
+void
+lcd_draw_bitmap(int x, int y, int w, int h, const uint16_t *pixels)
+{
+	uint16_t	*p = cur_frame + x + y * frame_w;
+
+	if (IN_FLASH(pixels) && (w * h >= LCD_DMA2D_MIN)) {
+		dma2d_copy(p, frame_w, pixels, w, w, h, DMA2D_RGB565);
+		return;
+	}
+	dma2d_wait();
+	while (h--) {
+		memcpy(p, pixels, w * sizeof(uint16_t));
+		p += frame_w;
+		pixels += w;
+	}
+}
+
+/*
+ * Mix 'color' into the pixel already in the frame, 'alpha' is how
+ * much of it in 16ths. Pixels are stored byte swapped so they are
+ * put right way round first. Spreading the 565 pixel out over 32 bits
+ * as -GGGGGG-----RRRRR------BBBBB leaves room above each field for
+ * the multiply so all three get done at once.
+ */
+void
+lcd_blend_pixel(int x, int y, uint16_t color, uint8_t alpha)
+{
+	uint16_t	*p = cur_frame + x + y * frame_w;
+	uint32_t	fg, bg, c;
+
+	dma2d_wait();
+	fg = (uint16_t)((color >> 8) | (color << 8));
+	bg = (uint16_t)((*p >> 8) | (*p << 8));
+	fg = (fg | (fg << 16)) & 0x07e0f81f;
+	bg = (bg | (bg << 16)) & 0x07e0f81f;
+	c = ((fg * alpha + bg * (16 - alpha)) >> 4) & 0x07e0f81f;
+	c = (c | (c >> 16)) & 0xffff;
+	*p = (uint16_t)((c >> 8) | (c << 8));
 }
 
 /*
@@ -67,34 +225,66 @@ lcd_draw_pixel(int x, int y, uint16_t color)
  */
 
 /*
- * This structure defines the sequence of commands to send
- * to the Display in order to initialize it. The AdaFruit
- * folks do something similar, it helps when debugging the
- * initialization sequence for the display.
+ * Init scripts for the display are one const byte stream. Each entry
+ * is the command, how many argument bytes follow, how long (in ms) the
+ * display needs before it takes the next command, then the arguments.
+ * A command of 0 ends the script. Write the entries with LCD_CMD()
+ * (LCD_CMD0() when there are no arguments) and the compiler counts the
+ * arguments, so the count can't get out of step with them the way two
+ * separate tables could. A delay that doesn't fit in its byte is a
+ * negative array size, ie. it won't compile.
  */
-struct tft_command {
-	uint16_t delay;		/* If you need a delay after */
-	uint8_t cmd;		/* command to send */
-	uint8_t n_args;		/* How many arguments it has */
-};
+#define LCD_DELAY(ms)	((ms) + 0 * sizeof(char[((ms) <= 255) ? 1 : -1]))
+#define LCD_NARGS(...)	sizeof((const uint8_t[]) { __VA_ARGS__ })
+#define LCD_CMD(cmd, ms, ...) \
+	(cmd), LCD_NARGS(__VA_ARGS__), LCD_DELAY(ms), __VA_ARGS__
+#define LCD_CMD0(cmd, ms)	(cmd), 0, LCD_DELAY(ms)
+#define LCD_END		0
 
+/*
+ * The time (mtime()) after which the display will take another
+ * command. A command that needs a delay after it just moves this on
+ * rather than sleeping, so the CPU can get on with something else,
+ * and the next command waits out whatever is left.
+ */
+static uint32_t	lcd_ready_at;
 
-/* prototype for lcd_command */
+/* prototypes for lcd_command and friends */
 static void lcd_command(uint8_t cmd, int delay, int n_args,
 						const uint8_t *args);
+static void lcd_wait_ready(void);
+static void lcd_dma_start(uint8_t cmd, const uint8_t *data, uint32_t n,
+						void (*done)(void));
+static void lcd_dma_start_box(uint8_t cmd, const uint8_t *data,
+			      uint32_t width, uint32_t stride, int rows,
+			      void (*done)(void));
+static void lcd_update_rotation(void);
+
+/*
+ * Wait until the display can take a command, any DMA transfer is
+ * finished and the delay asked for by the last command has run out.
+ */
+static void
+lcd_wait_ready(void)
+{
+	while (dma_busy);
+	while ((int32_t)(mtime() - lcd_ready_at) < 0);
+}
 
 /*
  * void lcd_command(cmd, delay, args, arg_ptr)
  *
  * All singing all dancing 'do a command' feature. Basically it
  * sends a command, and if args are present it sets 'data' and
- * sends those along too.
+ * sends those along too. If 'delay' is not zero, the next command
+ * is held off for that many milliseconds.
  */
 static void
 lcd_command(uint8_t cmd, int delay, int n_args, const uint8_t *args)
 {
 	int i;
 
+	lcd_wait_ready();
 	gpio_clear(GPIOC, GPIO2);	/* Select the LCD */
 	(void) spi_xfer(LCD_SPI, cmd);
 	if (n_args) {
@@ -106,119 +296,109 @@ lcd_command(uint8_t cmd, int delay, int n_args, const uint8_t *args)
 	gpio_set(GPIOC, GPIO2);		/* Turn off chip select */
 	gpio_clear(GPIOD, GPIO13);	/* always reset D/CX */
 	if (delay) {
-		msleep(delay);		/* wait, if called for */
+		lcd_ready_at = mtime() + delay;
 	}
 }
 
 /*
- * This creates a 'script' of commands that can be played
- * to the LCD controller to initialize it.
- * One array holds the 'argument' bytes, the other
- * the commands.
- * Keeping them in sync is essential
- */
-static const uint8_t cmd_args[] = {
-	0x00, 0x1B,
-	0x0a, 0xa2,
-	0x10,
-	0x10,
-	0x45, 0x15,
-	0x90,
-/*    0xc8,*/                 /* original */
-/*                  11001000 = MY, MX, BGR */
-	0x08,
-	0xc2,
-	0x55,
-	0x0a, 0xa7, 0x27, 0x04,
-	0x00, 0x00, 0x00, 0xef,
-	0x00, 0x00, 0x01, 0x3f,
-/*    0x01, 0x00, 0x06,*/         /* original */
-	0x01, 0x00, 0x00,           /* modified to remove RGB mode */
-	0x01,
-	0x0F, 0x29, 0x24, 0x0C, 0x0E,
-	0x09, 0x4E, 0x78, 0x3C, 0x09,
-	0x13, 0x05, 0x17, 0x11, 0x00,
-	0x00, 0x16, 0x1B, 0x04, 0x11,
-	0x07, 0x31, 0x33, 0x42, 0x05,
-	0x0C, 0x0A, 0x28, 0x2F, 0x0F,
-};
-
-/*
- * These are the commands we're going to send to the
- * display to initialize it. We send them all, in sequence
- * with occasional delays. Commands that require data bytes
- * as arguments, indicate how many bytes to pull out the
- * above array to include.
+ * This is the 'script' of commands that is played to the LCD
+ * controller to initialize it.
  *
  * The sequence was pieced together from the ST Micro demo
- * code, the data sheet, and other sources on the web.
- */
-const struct tft_command  initialization[] = {
-	{   0, 0xb1, 2 },	/* 0x00, 0x1B, */
-	{   0, 0xb6, 2 },	/* 0x0a, 0xa2, */
-	{   0, 0xc0, 1 },	/* 0x10, */
-	{   0, 0xc1, 1 },	/* 0x10, */
-	{   0, 0xc5, 2 },	/* 0x45, 0x15, */
-	{   0, 0xc7, 1 },	/* 0x90, */
-	{   0, 0x36, 1 },	/* 0xc8, */
-	{   0, 0xb0, 1 },	/* 0xc2, */
-	{   0, 0x3a, 1 },	/* 0x55 **added, pixel format 16 bpp */
-	{   0, 0xb6, 4 },	/* 0x0a, 0xa7, 0x27, 0x04, */
-	{   0, 0x2A, 4 },	/* 0x00, 0x00, 0x00, 0xef, */
-	{   0, 0x2B, 4 },	/* 0x00, 0x00, 0x01, 0x3f, */
-	{   0, 0xf6, 3 },	/* 0x01, 0x00, 0x06, */
-	{ 200, 0x2c, 0 },
-	{   0, 0x26, 1},	/* 0x01, */
-	{   0, 0xe0, 15 },	/* 0x0F, 0x29, 0x24, 0x0C, 0x0E, */
-				/* 0x09, 0x4E, 0x78, 0x3C, 0x09, */
-				/* 0x13, 0x05, 0x17, 0x11, 0x00, */
-	{   0, 0xe1, 15 },	/* 0x00, 0x16, 0x1B, 0x04, 0x11, */
-				/* 0x07, 0x31, 0x33, 0x42, 0x05, */
-				/* 0x0C, 0x0A, 0x28, 0x2F, 0x0F, */
-	{ 200, 0x11, 0 },
-	{   0, 0x29, 0 },
-	{   0,    0, 0 }	/* cmd == 0 indicates last command */
+ * code, the data sheet, and other sources on the web. The
+ * data sheet asks for 5ms after sleep out (0x11) before the next
+ * command and 120ms before the display may be put back to sleep,
+ * 120ms covers both. The 200ms that used to follow the memory
+ * write (0x2c) bought nothing, the panel is still asleep then.
+ */
+static const uint8_t initialization[] = {
+	LCD_CMD(0xb1, 0, 0x00, 0x1B),
+	LCD_CMD(0xb6, 0, 0x0a, 0xa2),
+	LCD_CMD(0xc0, 0, 0x10),
+	LCD_CMD(0xc1, 0, 0x10),
+	LCD_CMD(0xc5, 0, 0x45, 0x15),
+	LCD_CMD(0xc7, 0, 0x90),
+	/* original 0xc8, 11001000 = MY, MX, BGR */
+	LCD_CMD(0x36, 0, 0x08),
+	LCD_CMD(0xb0, 0, 0xc2),
+	LCD_CMD(0x3a, 0, 0x55),		/* **added, pixel format 16 bpp */
+	LCD_CMD(0xb6, 0, 0x0a, 0xa7, 0x27, 0x04),
+	LCD_CMD(0x2A, 0, 0x00, 0x00, 0x00, 0xef),
+	LCD_CMD(0x2B, 0, 0x00, 0x00, 0x01, 0x3f),
+	/* original 0x01, 0x00, 0x06, modified to remove RGB mode */
+	LCD_CMD(0xf6, 0, 0x01, 0x00, 0x00),
+	LCD_CMD0(0x2c, 0),
+	LCD_CMD(0x26, 0, 0x01),
+	LCD_CMD(0xe0, 0, 0x0F, 0x29, 0x24, 0x0C, 0x0E,
+			 0x09, 0x4E, 0x78, 0x3C, 0x09,
+			 0x13, 0x05, 0x17, 0x11, 0x00),
+	LCD_CMD(0xe1, 0, 0x00, 0x16, 0x1B, 0x04, 0x11,
+			 0x07, 0x31, 0x33, 0x42, 0x05,
+			 0x0C, 0x0A, 0x28, 0x2F, 0x0F),
+	LCD_CMD0(0x11, 120),
+	LCD_CMD0(0x29, 0),
+	LCD_END
 };
 
-/* prototype for initialize_display */
-static void initialize_display(const struct tft_command cmds[]);
+#ifdef LCD_INIT_LOG
+/*
+ * Put a script entry on the console. Build with -DLCD_INIT_LOG when
+ * debugging the initialization sequence, the console is a lot
+ * slower than the display so it is left out otherwise.
+ */
+static void
+lcd_log_command(uint8_t cmd, uint8_t n_args, uint8_t delay,
+		const uint8_t *args)
+{
+	int	j;
+
+	console_puts("CMD: ");
+	print_hex(cmd);
+	console_puts(", ");
+	if (n_args) {
+		console_puts("ARGS: ");
+		for (j = 0; j < n_args; j++) {
+			print_hex(args[j]);
+			console_puts(", ");
+		}
+	}
+	console_puts("DELAY: ");
+	print_decimal(delay);
+	console_puts("ms\n");
+}
+#endif
+
+/* prototype for lcd_run_script */
+static void lcd_run_script(const uint8_t *script);
 
 /*
- * void initialize_display(struct cmds[])
+ * void lcd_run_script(const uint8_t *script)
  *
- * This is the function that sends the entire list. It also puts
- * the commands it is sending to the console.
+ * Play an init script to the display. The arguments of each command
+ * go out by DMA straight from flash, so the CPU is on to the next
+ * entry while they are sent. A command with a delay after it is sent
+ * by lcd_command() instead, so the delay is counted from when it is
+ * done. Delays don't stop anything here, only the next command waits
+ * for them, so whatever the caller does after the script overlaps the
+ * last one.
  */
 static void
-initialize_display(const struct tft_command cmds[])
+lcd_run_script(const uint8_t *script)
 {
-	int i = 0;
-	int arg_offset = 0;
-	int j;
-
-	/* Initially arg offset is zero, so each time we 'consume'
-	 * a few bytes in the args array the offset is moved and
-	 * that changes the pointer we send to the command function.
-	 */
-	while (cmds[i].cmd) {
-		console_puts("CMD: ");
-		print_hex(cmds[i].cmd);
-		console_puts(", ");
-		if (cmds[i].n_args) {
-			console_puts("ARGS: ");
-			for (j = 0; j < cmds[i].n_args; j++) {
-				print_hex(cmd_args[arg_offset+j]);
-				console_puts(", ");
-			}
+	uint8_t	cmd, n_args, delay;
+
+	while ((cmd = *script++) != 0) {
+		n_args = *script++;
+		delay = *script++;
+#ifdef LCD_INIT_LOG
+		lcd_log_command(cmd, n_args, delay, script);
+#endif
+		if (n_args && !delay) {
+			lcd_dma_start(cmd, script, n_args, NULL);
+		} else {
+			lcd_command(cmd, delay, n_args, script);
 		}
-		console_puts("DELAY: ");
-		print_decimal(cmds[i].delay);
-		console_puts("ms\n");
-
-		lcd_command(cmds[i].cmd, cmds[i].delay, cmds[i].n_args,
-			&cmd_args[arg_offset]);
-		arg_offset += cmds[i].n_args;
-		i++;
+		script += n_args;
 	}
 	console_puts("Done.\n");
 }
@@ -257,6 +437,37 @@ test_image(void)
 	}
 }
 
+/*
+ * void lcd_set_rotation(uint8_t r)
+ *
+ * Lay the frame out for rotation 'r' (0 - 3, a quarter turn clockwise
+ * each), this is the rotate function for gfx_setRotation(). What is
+ * already in the frame is not moved, so draw the whole screen again.
+ * The display is switched over when the frame is next shown, the one
+ * it has now may still be going out.
+ */
+void
+lcd_set_rotation(uint8_t r)
+{
+	r &= 3;
+	frame_w = (r & 1) ? LCD_HEIGHT : LCD_WIDTH;
+	frame_h = (r & 1) ? LCD_WIDTH : LCD_HEIGHT;
+	frame_madctl = lcd_rotation[r];
+}
+
+/*
+ * If the frame about to be sent is laid out for another rotation
+ * than the last one, tell the display which way to scan it.
+ */
+static void
+lcd_update_rotation(void)
+{
+	if (frame_madctl != lcd_madctl) {
+		lcd_command(0x36, 0, 1, &frame_madctl);
+		lcd_madctl = frame_madctl;
+	}
+}
+
 /*
  * void lcd_show_frame(void)
  *
@@ -270,23 +481,302 @@ void lcd_show_frame(void)
 	uint16_t	*t;
 	uint8_t size[4];
 
+	while (dma_busy);
+	dma2d_wait();
 	t = display_frame;
 	display_frame = cur_frame;
 	cur_frame = t;
+	gfx_dirty_clear();
+	lcd_update_rotation();
 	/*  */
 	size[0] = 0;
 	size[1] = 0;
-	size[2] = (LCD_WIDTH >> 8) & 0xff;
-	size[3] = (LCD_WIDTH) & 0xff;
+	size[2] = ((frame_w - 1) >> 8) & 0xff;
+	size[3] = (frame_w - 1) & 0xff;
 	lcd_command(0x2A, 0, 4, (const uint8_t *)&size[0]);
 	size[0] = 0;
 	size[1] = 0;
-	size[2] = (LCD_HEIGHT >> 8) & 0xff;
-	size[3] = LCD_HEIGHT & 0xff;
+	size[2] = ((frame_h - 1) >> 8) & 0xff;
+	size[3] = (frame_h - 1) & 0xff;
 	lcd_command(0x2B, 0, 4, (const uint8_t *)&size[0]);
 	lcd_command(0x2C, 0, FRAME_SIZE_BYTES, (const uint8_t *)display_frame);
 }
 
+/*
+ * The regions lcd_show_dirty() is sending, they are copied out of the
+ * gfx state as it is cleared for the next frame while they go out.
+ */
+static struct gfx_rect	send_regions[GFX_MAX_DIRTY];
+static int		send_next, send_count;
+static int		send_w;		/* frame_w when they were drawn */
+
+/*
+ * void lcd_send_region(void)
+ *
+ * Set the column (0x2A) and row (0x2B) window on the display to the
+ * next of the send_regions and start the DMA on just the pixels in
+ * that box from the display frame. The rows are not next to each
+ * other in memory (unless the box is full width) so the DMA is handed
+ * them one after the other, chip select and D/CX held all the while.
+ * When they are out this is called again from the interrupt handler
+ * for the next region, so the window commands for all but the first
+ * are sent from there.
+ */
+static void
+lcd_send_region(void)
+{
+	uint8_t		size[4];
+	int		x0, y0, x1, y1;
+
+	if (send_next == send_count) {
+		return;
+	}
+	x0 = send_regions[send_next].x0;
+	y0 = send_regions[send_next].y0;
+	x1 = send_regions[send_next].x1;
+	y1 = send_regions[send_next].y1;
+	send_next++;
+
+	size[0] = (x0 >> 8) & 0xff;
+	size[1] = x0 & 0xff;
+	size[2] = (x1 >> 8) & 0xff;
+	size[3] = x1 & 0xff;
+	lcd_command(0x2A, 0, 4, (const uint8_t *)&size[0]);
+	size[0] = (y0 >> 8) & 0xff;
+	size[1] = y0 & 0xff;
+	size[2] = (y1 >> 8) & 0xff;
+	size[3] = y1 & 0xff;
+	lcd_command(0x2B, 0, 4, (const uint8_t *)&size[0]);
+	lcd_dma_start_box(0x2C,
+			  (const uint8_t *)(display_frame + x0 + y0 * send_w),
+			  (x1 - x0 + 1) * 2, send_w * 2, y1 - y0 + 1,
+			  lcd_send_region);
+}
+
+/*
+ * void lcd_show_dirty(void)
+ *
+ * Like lcd_show_frame() but only sends the parts of the frame that
+ * the gfx code says were drawn on since the last time. After the
+ * swap the frame we draw into next is two frames old, so the regions
+ * just sent are copied into it as well and it picks up where the
+ * display left off. That way a line of text costs a line of text on
+ * the SPI port rather than the whole 153,600 byte frame. The copies
+ * are queued on the DMA2D first so they are done while the regions
+ * go out on the SPI port, by DMA: like lcd_show_frame_async() this
+ * returns once the first region is started, lcd_frame_busy() says
+ * when the last is out.
+ */
+void lcd_show_dirty(void)
+{
+	const struct gfx_rect	*r;
+	uint16_t		*t;
+	int			i, n, w;
+
+	while (dma_busy);
+	dma2d_wait();
+	if (frame_madctl != lcd_madctl) {
+		/*
+		 * The screen was turned, what the display has is laid out
+		 * the other way so all of it has to go, and the frame we
+		 * draw into next starts out as a copy of it.
+		 */
+		lcd_show_frame();
+		memcpy(cur_frame, display_frame, FRAME_SIZE_BYTES);
+		return;
+	}
+	t = display_frame;
+	display_frame = cur_frame;
+	cur_frame = t;
+
+	n = gfx_dirty_regions(&r);
+	for (i = 0; i < n; i++) {
+		w = r[i].x1 - r[i].x0 + 1;
+		dma2d_copy(cur_frame + r[i].x0 + r[i].y0 * frame_w, frame_w,
+			   display_frame + r[i].x0 + r[i].y0 * frame_w, frame_w,
+			   w, r[i].y1 - r[i].y0 + 1, DMA2D_RGB565);
+	}
+	for (i = 0; i < n; i++) {
+		send_regions[i] = r[i];
+	}
+	send_next = 0;
+	send_count = n;
+	send_w = frame_w;
+	gfx_dirty_clear();
+	lcd_send_region();
+}
+
+/*
+ * Hand the next chunk of the frame to the DMA stream.
+ */
+static void
+lcd_dma_next_chunk(void)
+{
+	uint32_t n;
+
+	if (!dma_remaining) {
+		/* on to the next row of a box */
+		dma_next += dma_skip;
+		dma_remaining = dma_width;
+		dma_rows--;
+	}
+	n = (dma_remaining > LCD_DMA_CHUNK) ? LCD_DMA_CHUNK : dma_remaining;
+
+	dma_set_memory_address(LCD_DMA, LCD_DMA_STREAM, (uint32_t) dma_next);
+	dma_set_number_of_data(LCD_DMA, LCD_DMA_STREAM, n);
+	dma_next += n;
+	dma_remaining -= n;
+	dma_enable_stream(LCD_DMA, LCD_DMA_STREAM);
+}
+
+/*
+ * DMA2 stream 4 interrupt, a chunk has been written to the SPI
+ * data register. Either start the next one or finish the frame.
+ */
+void
+dma2_stream4_isr(void)
+{
+	if (!dma_get_interrupt_flag(LCD_DMA, LCD_DMA_STREAM, DMA_TCIF)) {
+		return;
+	}
+	dma_clear_interrupt_flags(LCD_DMA, LCD_DMA_STREAM, DMA_TCIF);
+	if (dma_remaining || dma_rows) {
+		lcd_dma_next_chunk();
+		return;
+	}
+
+	/*
+	 * The last byte is still being shifted out, wait for it before
+	 * letting go of chip select. Nobody read the receive side while
+	 * DMA was running, so read DR and SR to clear the overrun, or
+	 * spi_xfer() would return early on the next command.
+	 */
+	while (!(SPI_SR(LCD_SPI) & SPI_SR_TXE));
+	while (SPI_SR(LCD_SPI) & SPI_SR_BSY);
+	(void) SPI_DR(LCD_SPI);
+	(void) SPI_SR(LCD_SPI);
+	spi_disable_tx_dma(LCD_SPI);
+	gpio_set(GPIOC, GPIO2);		/* Turn off chip select */
+	gpio_clear(GPIOD, GPIO13);	/* always reset D/CX */
+	dma_busy = 0;
+	if (dma_done) {
+		dma_done();
+	}
+}
+
+/*
+ * Send command 'cmd' and then 'rows' rows of 'width' bytes, 'stride'
+ * bytes apart, from 'data' with DMA, calling 'done' from the
+ * interrupt handler when they are out. Returns as soon as the
+ * transfer is started, 'data' has to stay put until then.
+ */
+static void
+lcd_dma_start_box(uint8_t cmd, const uint8_t *data, uint32_t width,
+		  uint32_t stride, int rows, void (*done)(void))
+{
+	if (width == stride) {
+		/* full width, the rows are one block */
+		width *= rows;
+		rows = 1;
+	}
+	lcd_wait_ready();
+	dma_done = done;
+	dma_next = data;
+	dma_remaining = width;
+	dma_width = width;
+	dma_skip = stride - width;
+	dma_rows = rows - 1;
+	dma_busy = 1;
+
+	gpio_clear(GPIOC, GPIO2);	/* Select the LCD */
+	(void) spi_xfer(LCD_SPI, cmd);
+	gpio_set(GPIOD, GPIO13);	/* Set the D/CX pin */
+	spi_enable_tx_dma(LCD_SPI);
+	lcd_dma_next_chunk();
+}
+
+/*
+ * Same for 'n' bytes in one block.
+ */
+static void
+lcd_dma_start(uint8_t cmd, const uint8_t *data, uint32_t n,
+	      void (*done)(void))
+{
+	lcd_dma_start_box(cmd, data, n, n, 1, done);
+}
+
+/*
+ * int lcd_frame_busy(void)
+ *
+ * Returns non-zero while a frame started by lcd_show_frame_async()
+ * is still going out to the display.
+ */
+int
+lcd_frame_busy(void)
+{
+	return dma_busy;
+}
+
+/*
+ * void lcd_show_frame_async(void (*done)(void))
+ *
+ * Same as lcd_show_frame() except the pixels are moved by DMA, so it
+ * returns as soon as the transfer is started and the next frame can
+ * be drawn into cur_frame while this one is sent. When the last byte
+ * is out 'done' is called (from the interrupt handler) if it is not
+ * NULL. If the previous frame is still being sent it waits for that
+ * one first, there are only two buffers.
+ */
+void
+lcd_show_frame_async(void (*done)(void))
+{
+	uint16_t	*t;
+	uint8_t size[4];
+
+	while (dma_busy);
+	dma2d_wait();
+	t = display_frame;
+	display_frame = cur_frame;
+	cur_frame = t;
+	gfx_dirty_clear();
+	lcd_update_rotation();
+
+	size[0] = 0;
+	size[1] = 0;
+	size[2] = ((frame_w - 1) >> 8) & 0xff;
+	size[3] = (frame_w - 1) & 0xff;
+	lcd_command(0x2A, 0, 4, (const uint8_t *)&size[0]);
+	size[0] = 0;
+	size[1] = 0;
+	size[2] = ((frame_h - 1) >> 8) & 0xff;
+	size[3] = (frame_h - 1) & 0xff;
+	lcd_command(0x2B, 0, 4, (const uint8_t *)&size[0]);
+	lcd_dma_start(0x2C, (const uint8_t *) display_frame,
+		      FRAME_SIZE_BYTES, done);
+}
+
+/*
+ * Set up the DMA stream that feeds SPI5, byte wide on both sides,
+ * memory address incrementing and the SPI data register fixed.
+ */
+static void
+lcd_dma_init(void)
+{
+	rcc_periph_clock_enable(RCC_DMA2);
+	dma_stream_reset(LCD_DMA, LCD_DMA_STREAM);
+	dma_channel_select(LCD_DMA, LCD_DMA_STREAM, LCD_DMA_CHANNEL);
+	dma_set_priority(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_PL_HIGH);
+	dma_set_memory_size(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_MSIZE_8BIT);
+	dma_set_peripheral_size(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_PSIZE_8BIT);
+	dma_enable_memory_increment_mode(LCD_DMA, LCD_DMA_STREAM);
+	dma_set_transfer_mode(LCD_DMA, LCD_DMA_STREAM,
+			      DMA_SxCR_DIR_MEM_TO_PERIPHERAL);
+	dma_set_peripheral_address(LCD_DMA, LCD_DMA_STREAM,
+				   (uint32_t) &SPI_DR(LCD_SPI));
+	dma_enable_transfer_complete_interrupt(LCD_DMA, LCD_DMA_STREAM);
+	nvic_enable_irq(NVIC_DMA2_STREAM4_IRQ);
+}
+
 /*
  * void lcd_spi_init(void)
  *
@@ -322,8 +812,10 @@ lcd_spi_init(void)
 	gpio_mode_setup(GPIOF, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO7 | GPIO9);
 	gpio_set_af(GPIOF, GPIO_AF5, GPIO7 | GPIO9);
 
-	cur_frame = (uint16_t *)(SDRAM_BASE_ADDRESS);
-	display_frame = cur_frame + (LCD_WIDTH * LCD_HEIGHT);
+	/* The frame being sent and the one being drawn in different banks. */
+	sdram_pool_init(&lcd_frames, FRAME_SIZE_BYTES, 2, 0);
+	cur_frame = sdram_pool_get(&lcd_frames, NULL);
+	display_frame = sdram_pool_get(&lcd_frames, cur_frame);
 
 	rcc_periph_clock_enable(RCC_SPI5);
 	spi_init_master(LCD_SPI, SPI_CR1_BAUDRATE_FPCLK_DIV_4,
@@ -333,10 +825,12 @@ lcd_spi_init(void)
 					SPI_CR1_MSBFIRST);
 	spi_enable_ss_output(LCD_SPI);
 	spi_enable(LCD_SPI);
+	lcd_dma_init();
+	dma2d_init();
 
 	/* Set up the display */
 	console_puts("Initialize the display.\n");
-	initialize_display(initialization);
+	lcd_run_script(initialization);
 
 	/* create a test image */
 	console_puts("Generating Test Image\n");
@@ -345,6 +839,11 @@ lcd_spi_init(void)
 	/* display it on the LCD */
 	console_puts("And ... voila\n");
 	lcd_show_frame();
+
+	/* SysTick started counting at clock_setup(), ie. from reset */
+	console_puts("First frame ");
+	print_decimal((int) mtime());
+	console_puts("ms after boot\n");
 }
 
 /*
@@ -382,6 +881,7 @@ print_decimal(int num)
 	return len; /* number of characters printed */
 }
 
+#ifdef LCD_INIT_LOG
 /*
  * int print_hex(int value)
  *
@@ -408,3 +908,4 @@ static int print_hex(int v)
 	}
 	return len; /* number of characters printed */
 }
+#endif
@@ -23,13 +23,24 @@
 /*
  * prototypes for the LCD example
  *
- * This is a very basic API, initialize, a function which will show the
- * frame, and a function which will draw a pixel in the framebuffer.
+ * This is a very basic API, initialize, functions which will show the
+ * whole frame or just the parts the gfx code changed, and functions
+ * which will draw a pixel, a horizontal span, a block of pixels or a
+ * filled rectangle in the framebuffer, or blend a pixel into what is
+ * already there, and one to turn the screen.
  */
 
 void lcd_spi_init(void);
 void lcd_show_frame(void);
+void lcd_show_dirty(void);
+void lcd_show_frame_async(void (*done)(void));
+int lcd_frame_busy(void);
 void lcd_draw_pixel(int x, int y, uint16_t color);
+void lcd_draw_span(int x, int y, int w, uint16_t color);
+void lcd_draw_bitmap(int x, int y, int w, int h, const uint16_t *pixels);
+void lcd_fill_rect(int x, int y, int w, int h, uint16_t color);
+void lcd_blend_pixel(int x, int y, uint16_t color, uint8_t alpha);
+void lcd_set_rotation(uint8_t r);
 
 /* Color definitions */
 #define	LCD_BLACK   0x0000
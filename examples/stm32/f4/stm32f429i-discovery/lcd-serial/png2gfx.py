@@ -0,0 +1,244 @@
+#! /usr/bin/env python3
+#
+# This file is part of the libopencm3 project.
+#
+# This library is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this library.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+#
+# Turn a PNG file into a struct gfx_image (see gfx.h) for gfx_drawImage().
+#
+#   ./png2gfx.py [-f format] [-n name] [--no-swap] image.png > image.c
+#
+# The format is one of rgb565, rle565, pal8 or pal4. Left out, the
+# smallest one that can hold the image is picked. Pixels that are less
+# than half opaque become transparent. Pixels are byte swapped the way
+# lcd-spi.c keeps them in the frame unless --no-swap is given.
+#
+# Only the standard library is used, so the PNG is read by hand: any
+# colour type, 8 bits per channel (or 1 - 8 bit palettes), not
+# interlaced.
+#
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+FORMATS = ("rgb565", "rle565", "pal8", "pal4")
+RLE_RUN = 0x8000
+RLE_MAX = 0x7fff
+
+
+def read_png(path):
+	"""Returns width, height and rows of (r, g, b, a) tuples."""
+	with open(path, "rb") as f:
+		data = f.read()
+	if data[:8] != b"\x89PNG\r\n\x1a\n":
+		raise ValueError("%s is not a PNG file" % path)
+
+	pos = 8
+	idat = b""
+	plte = []
+	trns = b""
+	while pos < len(data):
+		length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+		body = data[pos + 8:pos + 8 + length]
+		pos += length + 12
+		if kind == b"IHDR":
+			w, h, depth, ctype, _, _, interlace = \
+				struct.unpack(">IIBBBBB", body)
+		elif kind == b"PLTE":
+			plte = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+		elif kind == b"tRNS":
+			trns = body
+		elif kind == b"IDAT":
+			idat += body
+		elif kind == b"IEND":
+			break
+
+	if interlace:
+		raise ValueError("interlaced PNG files are not supported")
+	if ctype != 3 and depth != 8:
+		raise ValueError("only 8 bits per channel is supported")
+
+	channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[ctype]
+	bpp = max(1, channels * depth // 8)
+	stride = (w * channels * depth + 7) // 8
+	raw = zlib.decompress(idat)
+
+	rows = []
+	prev = bytearray(stride)
+	for y in range(h):
+		filt = raw[y * (stride + 1)]
+		line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+		for i in range(stride):
+			a = line[i - bpp] if i >= bpp else 0
+			b = prev[i]
+			c = prev[i - bpp] if i >= bpp else 0
+			if filt == 1:
+				line[i] = (line[i] + a) & 0xff
+			elif filt == 2:
+				line[i] = (line[i] + b) & 0xff
+			elif filt == 3:
+				line[i] = (line[i] + (a + b) // 2) & 0xff
+			elif filt == 4:
+				p = a + b - c
+				pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+				pred = a if pa <= pb and pa <= pc else \
+					(b if pb <= pc else c)
+				line[i] = (line[i] + pred) & 0xff
+		prev = line
+
+		row = []
+		for x in range(w):
+			if ctype == 3:
+				bit = x * depth
+				v = (line[bit // 8] >> (8 - depth - bit % 8)) & \
+					((1 << depth) - 1)
+				alpha = trns[v] if v < len(trns) else 255
+				row.append(plte[v] + (alpha,))
+			elif ctype == 0:
+				v = line[x]
+				row.append((v, v, v, 255))
+			elif ctype == 4:
+				v = line[x * 2]
+				row.append((v, v, v, line[x * 2 + 1]))
+			elif ctype == 2:
+				row.append(tuple(line[x * 3:x * 3 + 3]) + (255,))
+			else:
+				row.append(tuple(line[x * 4:x * 4 + 4]))
+		rows.append(row)
+	return w, h, rows
+
+
+def rgb565(r, g, b, swap):
+	v = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+	if swap:
+		v = ((v >> 8) | (v << 8)) & 0xffff
+	return v
+
+
+def rle_row(row):
+	"""Packets for one row, runs of three or more become run packets."""
+	out = []
+	lit = []
+	i = 0
+	while i < len(row):
+		n = 1
+		while i + n < len(row) and row[i + n] == row[i] and n < RLE_MAX:
+			n += 1
+		if n >= 3:
+			if lit:
+				out += [len(lit)] + lit
+				lit = []
+			out += [RLE_RUN | n, row[i]]
+		else:
+			lit += row[i:i + n]
+			if len(lit) >= RLE_MAX:
+				out += [len(lit)] + lit
+				lit = []
+		i += n
+	if lit:
+		out += [len(lit)] + lit
+	return out
+
+
+def c_array(ctype, name, values, per_line, width):
+	out = "static const %s %s[] = {\n" % (ctype, name)
+	for i in range(0, len(values), per_line):
+		out += "\t" + ", ".join("0x%0*x" % (width, v)
+					for v in values[i:i + per_line]) + ",\n"
+	return out + "};\n"
+
+
+def main():
+	ap = argparse.ArgumentParser(description="PNG to struct gfx_image")
+	ap.add_argument("png")
+	ap.add_argument("-f", "--format", choices=FORMATS)
+	ap.add_argument("-n", "--name", help="C name (default from file)")
+	ap.add_argument("--no-swap", action="store_true",
+			help="don't byte swap the pixels")
+	args = ap.parse_args()
+
+	name = args.name or re.sub(r"\W", "_",
+				   os.path.splitext(os.path.basename(args.png))[0])
+	w, h, rows = read_png(args.png)
+	swap = not args.no_swap
+
+	# None is a transparent pixel
+	pixels = [[rgb565(*p[:3], swap=swap) if p[3] >= 128 else None
+		   for p in row] for row in rows]
+	keyed = any(p is None for row in pixels for p in row)
+	colors = sorted(set(p for row in pixels for p in row if p is not None))
+
+	# for the palette formats index 0 is the transparent one
+	palette = ([0] if keyed else []) + colors
+	index = dict((c, i) for i, c in enumerate(palette) if i or not keyed)
+
+	# for the 16 bit formats pick a pixel value the image doesn't use
+	key = 0
+	if keyed:
+		used = set(colors)
+		key = next(v for v in [0x1ff8] + list(range(0x10000))
+			   if v not in used)
+	flat = [[key if p is None else p for p in row] for row in pixels]
+
+	data = {}
+	data["rgb565"] = [p for row in flat for p in row]
+	data["rle565"] = [v for row in flat for v in rle_row(row)]
+	if len(palette) <= 256:
+		data["pal8"] = [0 if p is None else index[p]
+				for row in pixels for p in row]
+	if len(palette) <= 16:
+		packed = []
+		for row in pixels:
+			idx = [0 if p is None else index[p] for p in row]
+			if len(idx) & 1:
+				idx.append(0)
+			packed += [(idx[i] << 4) | idx[i + 1]
+				   for i in range(0, len(idx), 2)]
+		data["pal4"] = packed
+
+	def size(fmt):
+		if fmt in ("rgb565", "rle565"):
+			return len(data[fmt]) * 2
+		return len(data[fmt]) + len(palette) * 2
+
+	fmt = args.format or min(data, key=size)
+	if fmt not in data:
+		sys.exit("%s has %d colours, too many for %s" %
+			 (args.png, len(colors), fmt))
+
+	out = "/* made from %s by png2gfx.py, %d x %d %s, %d bytes */\n" % \
+		(os.path.basename(args.png), w, h, fmt, size(fmt))
+	out += "#include <stddef.h>\n#include <stdint.h>\n#include \"gfx.h\"\n\n"
+	if fmt in ("pal8", "pal4"):
+		out += c_array("uint16_t", name + "_palette", palette, 8, 4) + "\n"
+		out += c_array("uint8_t", name + "_data", data[fmt], 12, 2) + "\n"
+		key = 0
+	else:
+		out += c_array("uint16_t", name + "_data", data[fmt], 8, 4) + "\n"
+	out += "const struct gfx_image %s = {\n" % name
+	out += "\t%d, %d, GFX_IMAGE_%s, %s, 0x%04x,\n" % \
+		(w, h, fmt.upper(), "GFX_IMAGE_KEYED" if keyed else "0", key)
+	out += "\t%s, %s_data\n};\n" % \
+		(name + "_palette" if fmt in ("pal8", "pal4") else "NULL", name)
+	sys.stdout.write(out)
+
+
+if __name__ == "__main__":
+	main()
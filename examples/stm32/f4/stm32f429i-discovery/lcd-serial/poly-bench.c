@@ -0,0 +1,124 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host benchmark of the primitives in gfx-poly.c, the figures in the
+ * cost note in gfx.h come from here. Each shape is drawn CALLS times
+ * into the lcd-spi.c frame, without a blend function and then with
+ * lcd_blend_pixel(), and the best of REPEAT runs is printed as
+ * microseconds per call.
+ *
+ *     make HOST=1 && ./poly-bench.host
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include "host.h"
+#include "sdram.h"
+#include "lcd-spi.h"
+#include "gfx.h"
+
+#define CALLS	1000
+#define REPEAT	5
+
+/* a ten point star, r = 100 outside and 40 inside */
+static void star(void)
+{
+	struct gfx_point pts[10];
+	int	i;
+	double	a, r;
+
+	for (i = 0; i < 10; i++) {
+		a = i * 6.2831853 / 10;
+		r = (i & 1) ? 40 : 100;
+		pts[i].x = 120 + sin(a) * r;
+		pts[i].y = 160 - cos(a) * r;
+	}
+	gfx_fillPolygon(pts, 10, LCD_RED);
+}
+
+/* 5 pixels wide, corner to corner, about 370 long */
+static void thick_line(void)
+{
+	gfx_drawThickLine(10, 10, 229, 309, 5, LCD_BLUE);
+}
+
+/* 240 degrees of a ring, r = 100 and 12 wide */
+static void arc(void)
+{
+	gfx_drawArc(120, 160, 100, 12, 240, 120, LCD_GREEN);
+}
+
+/* the gauge on the first screen of lcd-serial.c */
+static void gauge(void)
+{
+	gfx_drawArc(120, 150, 60, 10, 240, 120, LCD_BLUE);
+	gfx_drawArc(120, 150, 60, 10, 60, 120, LCD_RED);
+	gfx_drawThickLine(120, 150, 160, 115, 4, LCD_BLACK);
+}
+
+static const struct {
+	const char	*name;
+	void		(*draw)(void);
+} shapes[] = {
+	{ "fillPolygon",	star },
+	{ "drawThickLine",	thick_line },
+	{ "drawArc",		arc },
+	{ "gauge",		gauge },
+};
+
+/* Best of REPEAT runs of CALLS calls to 'draw', in us per call. */
+static double run(void (*draw)(void))
+{
+	clock_t	start, t, best = 0;
+	int	r, i;
+
+	for (r = 0; r < REPEAT; r++) {
+		gfx_fillScreen(LCD_WHITE);
+		gfx_dirty_clear();
+		start = clock();
+		for (i = 0; i < CALLS; i++) {
+			draw();
+		}
+		t = clock() - start;
+		best = (r == 0 || t < best) ? t : best;
+	}
+	return 1e6 * best / CLOCKS_PER_SEC / CALLS;
+}
+
+int main(void)
+{
+	unsigned	i;
+	double		solid, smooth;
+
+	host_no_limits();
+	sdram_init();
+	lcd_spi_init();
+	gfx_init(lcd_draw_pixel, lcd_draw_span, lcd_draw_bitmap, 240, 320);
+
+	printf("%-14s %10s %10s\n", "us per call", "aliased", "blended");
+	for (i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+		gfx_setBlend(NULL);
+		solid = run(shapes[i].draw);
+		gfx_setBlend(lcd_blend_pixel);
+		smooth = run(shapes[i].draw);
+		printf("%-14s %10.1f %10.1f\n", shapes[i].name, solid, smooth);
+	}
+	return 0;
+}
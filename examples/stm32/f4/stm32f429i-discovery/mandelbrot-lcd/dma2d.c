@@ -0,0 +1,176 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A queue of DMA2D operations (see dma2d.h).
+ *
+ * Each operation is kept as the values for the engine's registers, so
+ * starting one is just storing them. The queue is a ring, 'q_head' is
+ * the operation the engine is working on and 'q_tail' the next free
+ * slot. When an operation completes the interrupt handler starts the
+ * next one, so the CPU only gets involved once per rectangle.
+ */
+#include <stdint.h>
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/cm3/nvic.h>
+#include "dma2d.h"
+
+/* The registers (RM0090, section 11.5) */
+#ifndef DMA2D_BASE
+#define DMA2D_BASE	0x4002B000U
+#endif
+#define DMA2D_REG(off)	(*(volatile uint32_t *)(DMA2D_BASE + (off)))
+#define DMA2D_CR	DMA2D_REG(0x00)
+#define DMA2D_IFCR	DMA2D_REG(0x08)
+#define DMA2D_FGMAR	DMA2D_REG(0x0c)
+#define DMA2D_FGOR	DMA2D_REG(0x10)
+#define DMA2D_FGPFCCR	DMA2D_REG(0x1c)
+#define DMA2D_FGCMAR	DMA2D_REG(0x2c)
+#define DMA2D_OPFCCR	DMA2D_REG(0x34)
+#define DMA2D_OCOLR	DMA2D_REG(0x38)
+#define DMA2D_OMAR	DMA2D_REG(0x3c)
+#define DMA2D_OOR	DMA2D_REG(0x40)
+#define DMA2D_NLR	DMA2D_REG(0x44)
+
+#define DMA2D_CR_START		(1 << 0)
+#define DMA2D_CR_TEIE		(1 << 8)
+#define DMA2D_CR_TCIE		(1 << 9)
+#define DMA2D_CR_CEIE		(1 << 13)
+#define DMA2D_CR_CTCIE		(1 << 20)
+#define DMA2D_CR_M2M_PFC	(1 << 16)
+#define DMA2D_IFCR_ALL		0x3f
+
+/* starts loading the CLUT, there is no START in CR for that */
+#define DMA2D_PFCCR_START	(1 << 5)
+#define DMA2D_PFCCR_CS_SHIFT	8
+
+struct dma2d_op {
+	uint32_t	cr;
+	uint32_t	fgmar, fgor, fgpfccr, fgcmar;
+	uint32_t	opfccr, ocolr, omar, oor, nlr;
+};
+
+static struct dma2d_op		queue[DMA2D_QUEUE];
+static volatile uint8_t		q_head, q_tail;
+volatile int			dma2d_running;
+
+static void
+dma2d_start(const struct dma2d_op *op)
+{
+	if (op->fgpfccr & DMA2D_PFCCR_START) {
+		/* loading the CLUT, it ends with its own interrupt */
+		DMA2D_FGCMAR = op->fgcmar;
+		DMA2D_CR = DMA2D_CR_CTCIE | DMA2D_CR_TEIE | DMA2D_CR_CEIE;
+		DMA2D_FGPFCCR = op->fgpfccr;
+		return;
+	}
+	DMA2D_FGMAR = op->fgmar;
+	DMA2D_FGOR = op->fgor;
+	DMA2D_FGPFCCR = op->fgpfccr;
+	DMA2D_OPFCCR = op->opfccr;
+	DMA2D_OCOLR = op->ocolr;
+	DMA2D_OMAR = op->omar;
+	DMA2D_OOR = op->oor;
+	DMA2D_NLR = op->nlr;
+	DMA2D_CR = op->cr | DMA2D_CR_TCIE | DMA2D_CR_TEIE | DMA2D_CR_CEIE |
+		   DMA2D_CR_START;
+}
+
+/*
+ * Put an operation on the queue, and start it if the engine has
+ * nothing to do. When the queue is full this waits for the engine to
+ * finish one.
+ */
+static void
+dma2d_submit(const struct dma2d_op *op)
+{
+	uint8_t	next = (q_tail + 1) % DMA2D_QUEUE;
+
+	while (next == q_head);
+	queue[q_tail] = *op;
+
+	nvic_disable_irq(NVIC_DMA2D_IRQ);
+	q_tail = next;
+	if (!dma2d_running) {
+		dma2d_running = 1;
+		dma2d_start(&queue[q_head]);
+	}
+	nvic_enable_irq(NVIC_DMA2D_IRQ);
+}
+
+/*
+ * An operation or a CLUT load is done (or it was refused, a transfer
+ * or configuration error ends it just the same), start the next one.
+ */
+void
+dma2d_isr(void)
+{
+	DMA2D_IFCR = DMA2D_IFCR_ALL;
+	q_head = (q_head + 1) % DMA2D_QUEUE;
+	if (q_head != q_tail) {
+		dma2d_start(&queue[q_head]);
+	} else {
+		dma2d_running = 0;
+	}
+}
+
+void
+dma2d_init(void)
+{
+	rcc_periph_clock_enable(RCC_DMA2D);
+	q_head = q_tail = 0;
+	dma2d_running = 0;
+	nvic_enable_irq(NVIC_DMA2D_IRQ);
+}
+
+/*
+ * Load the CLUT an L8 rectangle is converted through, 'n' entries of
+ * 0x00RRGGBB (taken as ARGB8888, the alpha doesn't matter going to a
+ * format without one).  The table is read when the load comes round
+ * in the queue, so it has to stay put until then.
+ */
+void
+dma2d_clut(const uint32_t *clut, int n)
+{
+	struct dma2d_op	op = {
+		.fgcmar = (uint32_t) clut,
+		.fgpfccr = (uint32_t) (n - 1) << DMA2D_PFCCR_CS_SHIFT |
+			   DMA2D_PFCCR_START | DMA2D_L8,
+	};
+
+	dma2d_submit(&op);
+}
+
+/* Copy a rectangle of pixels changing them to another format */
+void
+dma2d_convert(void *dst, int dst_stride, uint8_t dst_format,
+	      const void *src, int src_stride, uint8_t src_format,
+	      int w, int h)
+{
+	struct dma2d_op	op = {
+		.cr = DMA2D_CR_M2M_PFC,
+		.fgmar = (uint32_t) src,
+		.fgor = src_stride - w,
+		.fgpfccr = src_format,
+		.opfccr = dst_format,
+		.omar = (uint32_t) dst,
+		.oor = dst_stride - w,
+		.nlr = ((uint32_t) w << 16) | h,
+	};
+
+	dma2d_submit(&op);
+}
@@ -0,0 +1,58 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DMA2D_H
+#define __DMA2D_H
+#include <stdint.h>
+
+/*
+ * The DMA2D (Chrom-ART) engine of the STM32F429 turning rectangles of
+ * iteration counts into pixels through its CLUT.  Only what the
+ * Mandelbrot needs, lcd-dma's dma2d.c does fills, copies and blends
+ * as well.
+ *
+ * Operations are queued and the engine works through them on its own,
+ * the calls below return as soon as the operation is in the queue (or
+ * wait for a free slot if it is full). Anything the CPU does to memory
+ * an operation writes, or to memory it still has to read, has to wait
+ * with dma2d_wait() first. Strides are in pixels.
+ */
+
+/* Pixel formats, the numbers are what the engine uses */
+#define DMA2D_ARGB8888	0
+#define DMA2D_RGB888	1
+#define DMA2D_RGB565	2
+#define DMA2D_ARGB1555	3
+#define DMA2D_ARGB4444	4
+#define DMA2D_L8	5	/* input only, through the CLUT */
+
+#define DMA2D_QUEUE	8
+
+void dma2d_init(void);
+void dma2d_clut(const uint32_t *clut, int n);
+void dma2d_convert(void *dst, int dst_stride, uint8_t dst_format,
+		   const void *src, int src_stride, uint8_t src_format,
+		   int w, int h);
+/* Set while the engine has operations to do. */
+extern volatile int dma2d_running;
+
+static inline void dma2d_wait(void)
+{
+	while (dma2d_running);
+}
+
+#endif
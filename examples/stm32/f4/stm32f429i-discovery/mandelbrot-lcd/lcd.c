@@ -25,6 +25,7 @@
 #include <libopencm3/stm32/spi.h>
 #include <libopencm3/stm32/rcc.h>
 #include <libopencm3/stm32/gpio.h>
+#include <libopencm3/stm32/dma.h>
 #include <libopencm3/cm3/nvic.h>
 #include "clock.h"
 #include "sdram.h"
@@ -50,6 +51,23 @@
  */
 uint16_t *cur_frame;
 uint16_t *display_frame;
+static struct sdram_pool lcd_frames;
+
+/*
+ * State for sending a frame with DMA. SPI5 TX is request channel 2
+ * on DMA2 stream 4. One DMA transfer can only move 65,535 items so
+ * the frame goes out as a chain of chunks, the interrupt handler
+ * starts the next chunk when the current one completes.
+ */
+#define LCD_DMA		DMA2
+#define LCD_DMA_STREAM	DMA_STREAM4
+#define LCD_DMA_CHANNEL	DMA_SxCR_CHSEL_2
+#define LCD_DMA_CHUNK	65535
+
+static const uint8_t	*dma_next;	/* next byte to send */
+static uint32_t		dma_remaining;	/* bytes not yet handed to DMA */
+static void		(*dma_done)(void);
+static volatile int	dma_busy;
 
 
 /*
@@ -67,6 +85,16 @@ lcd_draw_pixel(int x, int y, uint16_t color)
 	*(cur_frame + x + y * LCD_WIDTH) = color;
 }
 
+/*
+ * The frame being built, for filling it other than a pixel at a
+ * time, LCD_WIDTH pixels a row.
+ */
+uint16_t *
+lcd_frame(void)
+{
+	return cur_frame;
+}
+
 /*
  * Fun fact, same SPI port as the MEMS example but different
  * I/O pins. Clearly you can't use both the SPI port and the
@@ -268,6 +296,7 @@ void lcd_show_frame(void)
 	uint16_t	*t;
 	uint8_t size[4];
 
+	while (dma_busy);
 	t = display_frame;
 	display_frame = cur_frame;
 	cur_frame = t;
@@ -285,6 +314,135 @@ void lcd_show_frame(void)
 	lcd_command(0x2C, 0, FRAME_SIZE_BYTES, (const uint8_t *)display_frame);
 }
 
+/*
+ * Hand the next chunk of the frame to the DMA stream.
+ */
+static void
+lcd_dma_next_chunk(void)
+{
+	uint32_t n = (dma_remaining > LCD_DMA_CHUNK) ?
+					LCD_DMA_CHUNK : dma_remaining;
+
+	dma_set_memory_address(LCD_DMA, LCD_DMA_STREAM, (uint32_t) dma_next);
+	dma_set_number_of_data(LCD_DMA, LCD_DMA_STREAM, n);
+	dma_next += n;
+	dma_remaining -= n;
+	dma_enable_stream(LCD_DMA, LCD_DMA_STREAM);
+}
+
+/*
+ * DMA2 stream 4 interrupt, a chunk has been written to the SPI
+ * data register. Either start the next one or finish the frame.
+ */
+void
+dma2_stream4_isr(void)
+{
+	if (!dma_get_interrupt_flag(LCD_DMA, LCD_DMA_STREAM, DMA_TCIF)) {
+		return;
+	}
+	dma_clear_interrupt_flags(LCD_DMA, LCD_DMA_STREAM, DMA_TCIF);
+	if (dma_remaining) {
+		lcd_dma_next_chunk();
+		return;
+	}
+
+	/*
+	 * The last byte is still being shifted out, wait for it before
+	 * letting go of chip select. Nobody read the receive side while
+	 * DMA was running, so read DR and SR to clear the overrun, or
+	 * spi_xfer() would return early on the next command.
+	 */
+	while (!(SPI_SR(LCD_SPI) & SPI_SR_TXE));
+	while (SPI_SR(LCD_SPI) & SPI_SR_BSY);
+	(void) SPI_DR(LCD_SPI);
+	(void) SPI_SR(LCD_SPI);
+	spi_disable_tx_dma(LCD_SPI);
+	gpio_set(GPIOC, GPIO2);		/* Turn off chip select */
+	gpio_clear(GPIOD, GPIO13);	/* always reset D/CX */
+	dma_busy = 0;
+	if (dma_done) {
+		dma_done();
+	}
+}
+
+/*
+ * int lcd_frame_busy(void)
+ *
+ * Returns non-zero while a frame started by lcd_show_frame_async()
+ * is still going out to the display.
+ */
+int
+lcd_frame_busy(void)
+{
+	return dma_busy;
+}
+
+/*
+ * void lcd_show_frame_async(void (*done)(void))
+ *
+ * Same as lcd_show_frame() except the pixels are moved by DMA, so it
+ * returns as soon as the transfer is started and the next frame can
+ * be drawn into cur_frame while this one is sent. When the last byte
+ * is out 'done' is called (from the interrupt handler) if it is not
+ * NULL. If the previous frame is still being sent it waits for that
+ * one first, there are only two buffers.
+ */
+void
+lcd_show_frame_async(void (*done)(void))
+{
+	uint16_t	*t;
+	uint8_t size[4];
+
+	while (dma_busy);
+	t = display_frame;
+	display_frame = cur_frame;
+	cur_frame = t;
+
+	size[0] = 0;
+	size[1] = 0;
+	size[2] = ((LCD_WIDTH - 1) >> 8) & 0xff;
+	size[3] = (LCD_WIDTH - 1) & 0xff;
+	lcd_command(0x2A, 0, 4, (const uint8_t *)&size[0]);
+	size[0] = 0;
+	size[1] = 0;
+	size[2] = ((LCD_HEIGHT - 1) >> 8) & 0xff;
+	size[3] = (LCD_HEIGHT - 1) & 0xff;
+	lcd_command(0x2B, 0, 4, (const uint8_t *)&size[0]);
+
+	dma_done = done;
+	dma_next = (const uint8_t *) display_frame;
+	dma_remaining = FRAME_SIZE_BYTES;
+	dma_busy = 1;
+
+	gpio_clear(GPIOC, GPIO2);	/* Select the LCD */
+	(void) spi_xfer(LCD_SPI, 0x2C);
+	gpio_set(GPIOD, GPIO13);	/* Set the D/CX pin */
+	spi_enable_tx_dma(LCD_SPI);
+	lcd_dma_next_chunk();
+}
+
+/*
+ * Set up the DMA stream that feeds SPI5, byte wide on both sides,
+ * memory address incrementing and the SPI data register fixed.
+ */
+static void
+lcd_dma_init(void)
+{
+	rcc_periph_clock_enable(RCC_DMA2);
+	dma_stream_reset(LCD_DMA, LCD_DMA_STREAM);
+	dma_channel_select(LCD_DMA, LCD_DMA_STREAM, LCD_DMA_CHANNEL);
+	dma_set_priority(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_PL_HIGH);
+	dma_set_memory_size(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_MSIZE_8BIT);
+	dma_set_peripheral_size(LCD_DMA, LCD_DMA_STREAM, DMA_SxCR_PSIZE_8BIT);
+	dma_enable_memory_increment_mode(LCD_DMA, LCD_DMA_STREAM);
+	dma_set_transfer_mode(LCD_DMA, LCD_DMA_STREAM,
+			      DMA_SxCR_DIR_MEM_TO_PERIPHERAL);
+	dma_set_peripheral_address(LCD_DMA, LCD_DMA_STREAM,
+				   (uint32_t) &SPI_DR(LCD_SPI));
+	dma_enable_transfer_complete_interrupt(LCD_DMA, LCD_DMA_STREAM);
+	nvic_enable_irq(NVIC_DMA2_STREAM4_IRQ);
+}
+
 /*
  * void lcd_spi_init(void)
  *
@@ -320,8 +478,10 @@ lcd_init(void)
 	gpio_mode_setup(GPIOF, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO7 | GPIO9);
 	gpio_set_af(GPIOF, GPIO_AF5, GPIO7 | GPIO9);
 
-	cur_frame = (uint16_t *)(SDRAM_BASE_ADDRESS);
-	display_frame = cur_frame + (LCD_WIDTH * LCD_HEIGHT);
+	/* The frame being sent and the one being drawn in different banks. */
+	sdram_pool_init(&lcd_frames, FRAME_SIZE_BYTES, 2, 0);
+	cur_frame = sdram_pool_get(&lcd_frames, NULL);
+	display_frame = sdram_pool_get(&lcd_frames, cur_frame);
 
 	rcc_periph_clock_enable(RCC_SPI5);
 	spi_init_master(LCD_SPI, SPI_CR1_BAUDRATE_FPCLK_DIV_4,
@@ -331,6 +491,7 @@ lcd_init(void)
 					SPI_CR1_MSBFIRST);
 	spi_enable_ss_output(LCD_SPI);
 	spi_enable(LCD_SPI);
+	lcd_dma_init();
 
 	/* Set up the display */
 	initialize_display(initialization);
@@ -29,7 +29,10 @@
 
 void lcd_init(void);
 void lcd_show_frame(void);
+void lcd_show_frame_async(void (*done)(void));
+int lcd_frame_busy(void);
 void lcd_draw_pixel(int x, int y, uint16_t color);
+uint16_t *lcd_frame(void);
 
 /* Color definitions */
 #define	LCD_BLACK   0x0000
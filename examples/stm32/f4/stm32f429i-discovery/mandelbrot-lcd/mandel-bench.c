@@ -0,0 +1,192 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host benchmark of the kernels in mandel-kernel.c.  Runs the same
+ * 100 frame zoom as the demo with each kernel, prints pixels per
+ * second, and counts the pixels that differ from MANDEL_REF.  Then the
+ * same for mandel_render() with MANDEL_FLOAT2, with how many of the
+ * pixels it actually ran through the kernel, and for mandel_zoom().
+ * With -v, the zoom is reported frame by frame.
+ *
+ * Exits non-zero if more pixels differ than each one is allowed:
+ * MANDEL_FLOAT2 and mandel_render() none, they do the same arithmetic
+ * as MANDEL_REF.  MANDEL_FIXED rounds differently (see mandel-kernel.h)
+ * and mandel_zoom() takes over counts from the last frame, so they get
+ * FIXED_TOLERANCE and ZOOM_TOLERANCE of the zoom's 7.68 million pixels.
+ *
+ *     make HOST=1 check
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "mandel-render.h"
+
+#define WIDTH	240
+#define HEIGHT	320
+#define FRAMES	100
+#define REPEAT	5	/* each frame is timed best of this many */
+
+/* 1 pixel in 1000 and 1 in 10000 (2987 and 8 differ now) */
+#define FIXED_TOLERANCE	(FRAMES * WIDTH * HEIGHT / 1000)
+#define ZOOM_TOLERANCE	(FRAMES * WIDTH * HEIGHT / 10000)
+
+static uint8_t ref[FRAMES][WIDTH][HEIGHT];
+static uint8_t out[WIDTH][HEIGHT];
+
+static const char *const names[] = { "ref", "float2", "fixed" };
+
+/* One frame, as mandel() in mandel.c draws it. */
+static void frame(enum mandel_mode mode, float cx, float cy, float scale,
+		  uint8_t dst[WIDTH][HEIGHT])
+{
+	int x;
+
+	for (x = -WIDTH / 2; x < WIDTH / 2; x++) {
+		mandel_span(mode, cx, cy, scale, x, -HEIGHT / 2, 0, 1,
+			    HEIGHT, dst[x + WIDTH / 2], 1);
+	}
+}
+
+/*
+ * The zoom with mandel_zoom(), with how much of each frame it worked
+ * out and how many pixels are off; per frame if verbose.
+ */
+static uint8_t prev[HEIGHT][WIDTH];
+
+static int zoom(int verbose)
+{
+	struct mandel_zoom z = { .prev = prev };
+	float scale = 0.25f, center_x = -0.5f, center_y = 0.0f;
+	long diff = 0, computed = 0, fdiff;
+	clock_t start, ticks = 0;
+	int gen, x, y;
+
+	for (gen = 0; gen < FRAMES; gen++) {
+		start = clock();
+		mandel_zoom(&z, MANDEL_FLOAT2, center_x, center_y, scale,
+			    NULL);
+		ticks += clock() - start;
+		computed += mandel_stats.computed;
+		fdiff = 0;
+		for (x = 0; x < WIDTH; x++) {
+			for (y = 0; y < HEIGHT; y++) {
+				fdiff += mandel_iters[y][x] != ref[gen][x][y];
+			}
+		}
+		diff += fdiff;
+		if (verbose) {
+			printf("  frame %3d %5.1f%% computed, %5.1f%% seeded, "
+			       "%ld pixels differ\n", gen,
+			       100.0 * mandel_stats.computed / (WIDTH * HEIGHT),
+			       100.0 * mandel_stats.seeded / (WIDTH * HEIGHT),
+			       fdiff);
+		}
+		center_x += 0.1815f * scale;
+		center_y += 0.505f * scale;
+		scale *= 0.875f;
+	}
+
+	printf("%-7s %8.0f pixels/s, %ld pixels differ, %.1f%% computed\n",
+	       "zoom", (double)FRAMES * WIDTH * HEIGHT * CLOCKS_PER_SEC /
+	       (ticks ? ticks : 1), diff,
+	       100.0 * computed / ((double)FRAMES * WIDTH * HEIGHT));
+	return diff > ZOOM_TOLERANCE;
+}
+
+static int render(void)
+{
+	float scale = 0.25f, center_x = -0.5f, center_y = 0.0f;
+	long diff = 0, computed = 0;
+	clock_t start, t, best = 0, ticks = 0;
+	int gen, r, x, y;
+
+	for (gen = 0; gen < FRAMES; gen++) {
+		for (r = 0; r < REPEAT; r++) {
+			start = clock();
+			mandel_render(MANDEL_FLOAT2, center_x, center_y, scale,
+				      NULL);
+			t = clock() - start;
+			best = (r == 0 || t < best) ? t : best;
+		}
+		ticks += best;
+		computed += mandel_stats.computed;
+		for (x = 0; x < WIDTH; x++) {
+			for (y = 0; y < HEIGHT; y++) {
+				diff += mandel_iters[y][x] != ref[gen][x][y];
+			}
+		}
+		center_x += 0.1815f * scale;
+		center_y += 0.505f * scale;
+		scale *= 0.875f;
+	}
+
+	printf("%-7s %8.0f pixels/s, %ld pixels differ, %.1f%% computed\n",
+	       "render", (double)FRAMES * WIDTH * HEIGHT * CLOCKS_PER_SEC /
+	       (ticks ? ticks : 1), diff,
+	       100.0 * computed / ((double)FRAMES * WIDTH * HEIGHT));
+	return diff != 0;
+}
+
+int main(int argc, char **argv)
+{
+	enum mandel_mode mode;
+	int failed = 0;
+	int verbose = argc > 1 && !strcmp(argv[1], "-v");
+
+	for (mode = MANDEL_REF; mode <= MANDEL_FIXED; mode++) {
+		float scale = 0.25f, center_x = -0.5f, center_y = 0.0f;
+		long diff = 0;
+		clock_t start, t, best = 0, ticks = 0;
+		int gen, r, x, y;
+
+		for (gen = 0; gen < FRAMES; gen++) {
+			for (r = 0; r < REPEAT; r++) {
+				start = clock();
+				frame(mode, center_x, center_y, scale,
+				      mode == MANDEL_REF ? ref[gen] : out);
+				t = clock() - start;
+				best = (r == 0 || t < best) ? t : best;
+			}
+			ticks += best;
+			if (mode != MANDEL_REF) {
+				for (x = 0; x < WIDTH; x++) {
+					for (y = 0; y < HEIGHT; y++) {
+						diff += out[x][y] !=
+							ref[gen][x][y];
+					}
+				}
+			}
+			/* Change scale and center, as the demo does */
+			center_x += 0.1815f * scale;
+			center_y += 0.505f * scale;
+			scale *= 0.875f;
+		}
+
+		printf("%-7s %8.0f pixels/s, %ld pixels differ\n",
+		       names[mode],
+		       (double)FRAMES * WIDTH * HEIGHT * CLOCKS_PER_SEC /
+		       (ticks ? ticks : 1), diff);
+		if (diff > (mode == MANDEL_FIXED ? FIXED_TOLERANCE : 0)) {
+			failed = 1;
+		}
+	}
+	failed |= render();
+	failed |= zoom(verbose);
+	return failed;
+}
@@ -0,0 +1,222 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The escape-time kernels, see mandel-kernel.h.  Nothing in here
+ * touches the hardware, so it builds for the host as well;
+ * mandel-bench.c in mandelbrot-lcd times and checks it there.
+ */
+
+#include "mandel-kernel.h"
+
+/* Main mandelbrot calculation, as it has always been */
+int mandel_ref(float px, float py)
+{
+	int it = 0;
+	float x = 0, y = 0;
+	while (it < MANDEL_MAX_ITER) {
+		float nx = x*x;
+		float ny = y*y;
+		if ((nx + ny) > 4) {
+			return it;
+		}
+		/* Zn+1 = Zn^2 + P */
+		y = 2*x*y + py;
+		x = nx - ny + px;
+		it++;
+	}
+	return 0;
+}
+
+/*
+ * Points whose answer is known without iterating: inside the main
+ * cardioid or the period 2 bulb never escape, and outside radius 2
+ * escape right after the first step.  The last test is exactly the
+ * one mandel_ref() makes at that step, so it gives the same answer.
+ */
+static int mandel_known(float px, float py, uint8_t *it)
+{
+	float xq = px - 0.25f;
+	float y2 = py * py;
+	float q = xq * xq + y2;
+
+	if (px * px + y2 > 4) {
+		*it = 1;
+		return 1;
+	}
+	if (q * (q + xq) <= 0.25f * y2 ||
+	    (px + 1) * (px + 1) + y2 <= 0.0625f) {
+		*it = 0;
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Periodicity: an orbit is saved at steps 2^k - 1 and compared with
+ * after every step.  Once it is exactly where it was, the same
+ * arithmetic takes it round the same loop for ever.
+ */
+#define MANDEL_SAVE_AT(n) ((((n) + 1) & (n)) == 0)
+
+void mandel_float2(float px0, float py0, float px1, float py1, int it[2])
+{
+	float x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+	float sx0 = 0, sy0 = 0, sx1 = 0, sy1 = 0;
+	int done0 = 0, done1 = 0;
+	int n;
+
+	it[0] = it[1] = 0;
+	for (n = 0; n < MANDEL_MAX_ITER; n++) {
+		float nx0 = x0*x0;
+		float nx1 = x1*x1;
+		float ny0 = y0*y0;
+		float ny1 = y1*y1;
+
+		if (!done0 && (nx0 + ny0) > 4) {
+			it[0] = n;
+			done0 = 1;
+		}
+		if (!done1 && (nx1 + ny1) > 4) {
+			it[1] = n;
+			done1 = 1;
+		}
+		if (done0 && done1) {
+			break;
+		}
+
+		/*
+		 * A finished orbit keeps going along with the other one;
+		 * that is cheaper than a branch, and its answer is in.
+		 */
+		y0 = 2*x0*y0 + py0;
+		y1 = 2*x1*y1 + py1;
+		x0 = nx0 - ny0 + px0;
+		x1 = nx1 - ny1 + px1;
+
+		if (x0 == sx0 && y0 == sy0) {
+			done0 = 1;
+		}
+		if (x1 == sx1 && y1 == sy1) {
+			done1 = 1;
+		}
+		if (MANDEL_SAVE_AT(n)) {
+			sx0 = x0;
+			sy0 = y0;
+			sx1 = x1;
+			sy1 = y1;
+		}
+	}
+}
+
+/*
+ * Q4.28 with the squares kept in 64 bits (Q8.56) until the escape
+ * test has passed, as they can be up to 36 by then.  After it, x*x -
+ * y*y and 2*x*y are within 4, and with c back within 2 of 0 (which
+ * mandel_span() sees to) nothing overflows.  x*x + y*y is SMULL and
+ * SMLAL, 2*x*y one more SMULL.
+ */
+int mandel_fixed(mandel_fixed_t px, mandel_fixed_t py)
+{
+	const int64_t four = (int64_t)4 << (2 * MANDEL_FIXED_SHIFT);
+	int32_t x = 0, y = 0, sx = 0, sy = 0;
+	int it;
+
+	for (it = 0; it < MANDEL_MAX_ITER; it++) {
+		int64_t x2 = (int64_t)x * x;
+		int64_t y2 = (int64_t)y * y;
+		if (x2 + y2 > four) {
+			return it;
+		}
+		y = (int32_t)(((int64_t)x * y) >> (MANDEL_FIXED_SHIFT - 1)) +
+		    py;
+		x = (int32_t)((x2 - y2) >> MANDEL_FIXED_SHIFT) + px;
+
+		if (x == sx && y == sy) {
+			return 0;
+		}
+		if (MANDEL_SAVE_AT(it)) {
+			sx = x;
+			sy = y;
+		}
+	}
+	return 0;
+}
+
+static int span(enum mandel_mode mode, float cx, float cy, float scale,
+		int x, int y, int dx, int dy, int n, uint8_t *it, int stride,
+		int unknown_only)
+{
+	float pend_py = 0, pend_px = 0;
+	int pend = -1;
+	int pair[2];
+	int i, computed = 0;
+
+	for (i = 0; i < n; i++, x += dx, y += dy) {
+		float px = cx + x*scale;
+		float py = cy + y*scale;
+		uint8_t *out = &it[i * stride];
+
+		if (unknown_only && *out != MANDEL_UNKNOWN) {
+			continue;
+		}
+		computed++;
+		if (mode == MANDEL_REF) {
+			*out = mandel_ref(px, py);
+			continue;
+		}
+		if (mandel_known(px, py, out)) {
+			continue;
+		}
+		if (mode == MANDEL_FIXED) {
+			*out = mandel_fixed(MANDEL_TO_FIXED(px),
+					    MANDEL_TO_FIXED(py));
+			continue;
+		}
+
+		/* Float points go in pairs, of the ones left over. */
+		if (pend < 0) {
+			pend = i;
+			pend_px = px;
+			pend_py = py;
+			continue;
+		}
+		mandel_float2(pend_px, pend_py, px, py, pair);
+		it[pend * stride] = pair[0];
+		*out = pair[1];
+		pend = -1;
+	}
+
+	/* An odd one out goes on its own, it gives the same answer. */
+	if (pend >= 0) {
+		it[pend * stride] = mandel_ref(pend_px, pend_py);
+	}
+	return computed;
+}
+
+void mandel_span(enum mandel_mode mode, float cx, float cy, float scale,
+		 int x, int y, int dx, int dy, int n, uint8_t *it, int stride)
+{
+	span(mode, cx, cy, scale, x, y, dx, dy, n, it, stride, 0);
+}
+
+int mandel_span_unknown(enum mandel_mode mode, float cx, float cy,
+			float scale, int x, int y, int dx, int dy, int n,
+			uint8_t *it, int stride)
+{
+	return span(mode, cx, cy, scale, x, y, dx, dy, n, it, stride, 1);
+}
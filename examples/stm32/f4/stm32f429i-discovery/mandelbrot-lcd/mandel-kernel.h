@@ -0,0 +1,76 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MANDEL_KERNEL_H
+#define __MANDEL_KERNEL_H
+
+#include <stdint.h>
+
+/* Maximum number of iterations for the escape-time calculation */
+#define MANDEL_MAX_ITER 32
+
+/*
+ * All kernels return the iteration a point escaped at, or 0 if it
+ * didn't within MANDEL_MAX_ITER, like the original iterate() did.
+ *
+ *   MANDEL_REF    the original scalar float loop.
+ *   MANDEL_FLOAT2 float, two points at a time, so one point's
+ *                 multiplies fill the other's FPU latency.  Same
+ *                 arithmetic as MANDEL_REF, so the same answers.
+ *   MANDEL_FIXED  Q4.28 fixed point, with 64 bit products (SMULL and
+ *                 SMLAL on the M4).  Rounds differently from float,
+ *                 so a few pixels on the edge of the set differ
+ *                 (mandel-bench.c allows 1 in 1000).
+ *
+ * FLOAT2 and FIXED skip the main cardioid and the period 2 bulb
+ * outright, and stop as soon as an orbit comes back exactly to a
+ * point it has been at, as it then never escapes.
+ */
+enum mandel_mode {
+	MANDEL_REF,
+	MANDEL_FLOAT2,
+	MANDEL_FIXED,
+};
+
+/* Q4.28 */
+typedef int32_t mandel_fixed_t;
+#define MANDEL_FIXED_SHIFT 28
+#define MANDEL_TO_FIXED(f) ((mandel_fixed_t)((f) * (1 << MANDEL_FIXED_SHIFT)))
+
+int mandel_ref(float px, float py);
+void mandel_float2(float px0, float py0, float px1, float py1, int it[2]);
+int mandel_fixed(mandel_fixed_t px, mandel_fixed_t py);
+
+/*
+ * n points from pixel (x, y) on, in steps of (dx, dy), into it[0],
+ * it[stride], ...  Pixel (x, y) is the point (cx + x*scale, cy +
+ * y*scale), which is how the examples have always worked it out.
+ */
+void mandel_span(enum mandel_mode mode, float cx, float cy, float scale,
+		 int x, int y, int dx, int dy, int n, uint8_t *it, int stride);
+
+/*
+ * The same, but only for the entries that are MANDEL_UNKNOWN; the
+ * rest are left as they are.  Returns how many it worked out.
+ */
+#define MANDEL_UNKNOWN	0xFF
+
+int mandel_span_unknown(enum mandel_mode mode, float cx, float cy,
+			float scale, int x, int y, int dx, int dy, int n,
+			uint8_t *it, int stride);
+
+#endif
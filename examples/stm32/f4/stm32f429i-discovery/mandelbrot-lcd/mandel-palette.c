@@ -0,0 +1,80 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Iteration count to color, see mandel-palette.h.  Straight lines
+ * between a few stops, in integers, so no libm.
+ */
+
+#include "mandel-palette.h"
+
+static const uint8_t stops[][3] = {
+	{ 0x00, 0x07, 0x64 },	/* deep blue */
+	{ 0x20, 0x6b, 0xcb },	/* blue */
+	{ 0xed, 0xff, 0xff },	/* white */
+	{ 0xff, 0xaa, 0x00 },	/* orange */
+	{ 0x30, 0x02, 0x20 },	/* dark purple */
+};
+
+#define N_STOPS (sizeof(stops) / sizeof(stops[0]))
+
+void mandel_palette(uint32_t rgb[256], unsigned phase)
+{
+	unsigned i, c;
+
+	rgb[0] = 0;
+	for (i = 1; i < 256; i++) {
+		/* Where on the gradient, in 256ths of a stop */
+		unsigned t = (i + phase) % MANDEL_PALETTE_PERIOD *
+			     N_STOPS * 256 / MANDEL_PALETTE_PERIOD;
+		const uint8_t *a = stops[t >> 8];
+		const uint8_t *b = stops[((t >> 8) + 1) % N_STOPS];
+		int f = t & 0xFF;
+
+		rgb[i] = 0;
+		for (c = 0; c < 3; c++) {
+			int v = a[c] + (b[c] - a[c]) * f / 256;
+			rgb[i] = rgb[i] << 8 | v;
+		}
+	}
+}
+
+void mandel_palette_lcd(uint16_t lut[256], unsigned phase)
+{
+	uint32_t rgb[256];
+	unsigned i;
+
+	mandel_palette(rgb, phase);
+	for (i = 0; i < 256; i++) {
+		uint16_t c = (rgb[i] >> 8 & 0xF800) | (rgb[i] >> 5 & 0x07E0) |
+			     (rgb[i] >> 3 & 0x001F);
+		lut[i] = c >> 8 | c << 8;
+	}
+}
+
+void mandel_palette_dma2d(uint32_t clut[256], unsigned phase)
+{
+	uint16_t lut[256];
+	unsigned i;
+
+	/* RGB565 keeps the top bits of each channel, the rest are 0 */
+	mandel_palette_lcd(lut, phase);
+	for (i = 0; i < 256; i++) {
+		clut[i] = (uint32_t)(lut[i] & 0xF800) << 8 |
+			  (lut[i] & 0x07E0) << 5 | (lut[i] & 0x001F) << 3;
+	}
+}
@@ -0,0 +1,43 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MANDEL_PALETTE_H
+#define __MANDEL_PALETTE_H
+
+#include <stdint.h>
+
+/* Counts for one trip round the gradient. */
+#define MANDEL_PALETTE_PERIOD	32
+
+/*
+ * Colors for the 256 iteration counts mandel_iters can hold.  Count 0
+ * (never escaped) is black; the rest go round a smooth gradient,
+ * moved along by phase, so cycling the colors is just building the
+ * table again with the next phase.
+ *
+ * mandel_palette() gives 0x00RRGGBB, which is also what an LTDC L8
+ * layer takes in its CLUT (with the index in the top byte).
+ * mandel_palette_lcd() gives RGB565 with the bytes swapped, the way
+ * lcd.c sends frames to the panel.  The DMA2D can't swap bytes, so
+ * mandel_palette_dma2d() gives a CLUT for it of the colors that come
+ * out as those swapped pixels when it converts them to RGB565.
+ */
+void mandel_palette(uint32_t rgb[256], unsigned phase);
+void mandel_palette_lcd(uint16_t lut[256], unsigned phase);
+void mandel_palette_dma2d(uint32_t clut[256], unsigned phase);
+
+#endif
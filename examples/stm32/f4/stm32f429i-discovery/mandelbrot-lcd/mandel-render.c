@@ -0,0 +1,249 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Progressive, adaptive rendering, see mandel-render.h.
+ *
+ * Every pixel worked out is kept in mandel_iters, so no pass works
+ * out a pixel an earlier one already did.  The last pass is Mariani-
+ * Silver: work out the border of a rectangle; if it is all the same
+ * count, so is the inside, as the bands of equal count don't have
+ * holes (short of ones too small to show).  Otherwise split it in two
+ * and do both halves.  The samples the previews left inside a
+ * rectangle are checked as well, which catches most small islands
+ * the border misses.
+ *
+ * Like mandel-kernel.c this doesn't touch the hardware.
+ */
+
+#include <string.h>
+#include "mandel-render.h"
+
+/* Rectangles this thin are just worked out. */
+#define MANDEL_MS_MIN	4
+
+uint8_t mandel_iters[MANDEL_HEIGHT][MANDEL_WIDTH];
+struct mandel_stats mandel_stats;
+
+static struct {
+	enum mandel_mode mode;
+	float cx, cy, scale;
+} view;
+
+/* Work out the pixels not known yet of the n from (x, y) on. */
+static void compute(int x, int y, int dx, int dy, int n)
+{
+	mandel_stats.computed +=
+		mandel_span_unknown(view.mode, view.cx, view.cy, view.scale,
+				    x - MANDEL_WIDTH / 2, y - MANDEL_HEIGHT / 2,
+				    dx, dy, n, &mandel_iters[y][x],
+				    dy * MANDEL_WIDTH + dx);
+}
+
+/* Whether the border of the rectangle is all v. */
+static int border_is(int x0, int y0, int x1, int y1, uint8_t v)
+{
+	int x, y;
+
+	for (x = x0; x <= x1; x++) {
+		if (mandel_iters[y0][x] != v || mandel_iters[y1][x] != v) {
+			return 0;
+		}
+	}
+	for (y = y0 + 1; y < y1; y++) {
+		if (mandel_iters[y][x0] != v || mandel_iters[y][x1] != v) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*
+ * Whether the inside of the rectangle is all v, as far as the
+ * previews saw.  They left every 2nd pixel of every 2nd row.
+ */
+static int uniform(int x0, int y0, int x1, int y1, uint8_t v)
+{
+	int x, y;
+
+	if (MANDEL_PREVIEW == 1) {
+		return 1;
+	}
+	for (y = (y0 + 2) & ~1; y < y1; y += 2) {
+		for (x = (x0 + 2) & ~1; x < x1; x += 2) {
+			if (mandel_iters[y][x] != v) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/* Mariani-Silver on the rectangle from (x0, y0) to (x1, y1) inclusive. */
+static void subdivide(int x0, int y0, int x1, int y1)
+{
+	int w = x1 - x0 + 1;
+	int h = y1 - y0 + 1;
+	uint8_t v;
+	int y, m;
+
+	if (w <= MANDEL_MS_MIN || h <= MANDEL_MS_MIN) {
+		for (y = y0; y <= y1; y++) {
+			compute(x0, y, 1, 0, w);
+		}
+		return;
+	}
+
+	compute(x0, y0, 1, 0, w);
+	compute(x0, y1, 1, 0, w);
+	compute(x0, y0 + 1, 0, 1, h - 2);
+	compute(x1, y0 + 1, 0, 1, h - 2);
+
+	v = mandel_iters[y0][x0];
+	if (border_is(x0, y0, x1, y1, v) && uniform(x0, y0, x1, y1, v)) {
+		for (y = y0 + 1; y < y1; y++) {
+			memset(&mandel_iters[y][x0 + 1], v, w - 2);
+		}
+		mandel_stats.filled += (w - 2) * (h - 2);
+		return;
+	}
+
+	/* Split the longer side; the halves share the middle line. */
+	if (w >= h) {
+		m = (x0 + x1) / 2;
+		subdivide(x0, y0, m, y1);
+		subdivide(m, y0, x1, y1);
+	} else {
+		m = (y0 + y1) / 2;
+		subdivide(x0, y0, x1, m);
+		subdivide(x0, m, x1, y1);
+	}
+}
+
+static void begin(enum mandel_mode mode, float cx, float cy, float scale)
+{
+	view.mode = mode;
+	view.cx = cx;
+	view.cy = cy;
+	view.scale = scale;
+	mandel_stats.computed = 0;
+	mandel_stats.filled = 0;
+	mandel_stats.seeded = 0;
+}
+
+void mandel_render(enum mandel_mode mode, float cx, float cy, float scale,
+		   void (*show)(int step))
+{
+	int step, y;
+
+	begin(mode, cx, cy, scale);
+	memset(mandel_iters, MANDEL_UNKNOWN, sizeof(mandel_iters));
+
+	for (step = MANDEL_PREVIEW; step > 1; step /= 2) {
+		for (y = 0; y < MANDEL_HEIGHT; y += step) {
+			compute(0, y, step, 0, MANDEL_WIDTH / step);
+		}
+		if (show) {
+			show(step);
+		}
+	}
+
+	subdivide(0, 0, MANDEL_WIDTH - 1, MANDEL_HEIGHT - 1);
+	if (show) {
+		show(1);
+	}
+}
+
+/* Whether the 3x3 pixels of prev around (i, j) are all v. */
+static int around_is(uint8_t (*prev)[MANDEL_WIDTH], int i, int j, uint8_t v)
+{
+	int y;
+
+	for (y = j - 1; y <= j + 1; y++) {
+		if (prev[y][i - 1] != v || prev[y][i] != v ||
+		    prev[y][i + 1] != v) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*
+ * Fill mandel_iters from the last frame where it can be, the rest
+ * MANDEL_UNKNOWN.  Pixel (x, y) of the new frame is (u, v) of the
+ * last one, in 16.16 fixed point, with u = u0 + x*r and v = v0 + y*r.
+ */
+static void seed(struct mandel_zoom *zoom, float cx, float cy, float scale)
+{
+	uint8_t (*prev)[MANDEL_WIDTH] = zoom->prev;
+	int32_t r = (int32_t)(scale / zoom->scale * 65536);
+	int32_t u0 = (int32_t)(((cx - zoom->cx) / zoom->scale +
+				MANDEL_WIDTH / 2) * 65536) -
+		     MANDEL_WIDTH / 2 * r;
+	int32_t v0 = (int32_t)(((cy - zoom->cy) / zoom->scale +
+				MANDEL_HEIGHT / 2) * 65536) -
+		     MANDEL_HEIGHT / 2 * r;
+	int x, y, i, j;
+
+	for (y = 0; y < MANDEL_HEIGHT; y++) {
+		uint8_t *row = mandel_iters[y];
+
+		j = (v0 + y * r + 0x8000) >> 16;
+		if (j < 1 || j > MANDEL_HEIGHT - 2) {
+			memset(row, MANDEL_UNKNOWN, MANDEL_WIDTH);
+			continue;
+		}
+		for (x = 0; x < MANDEL_WIDTH; x++) {
+			i = (u0 + x * r + 0x8000) >> 16;
+			row[x] = MANDEL_UNKNOWN;
+			if (i < 1 || i > MANDEL_WIDTH - 2) {
+				continue;
+			}
+			if (around_is(prev, i, j, prev[j][i])) {
+				row[x] = prev[j][i];
+				mandel_stats.seeded++;
+			}
+		}
+	}
+}
+
+void mandel_zoom(struct mandel_zoom *zoom, enum mandel_mode mode,
+		 float cx, float cy, float scale, void (*show)(int step))
+{
+	int y;
+
+	if (zoom->frames == 0 || zoom->frames >= MANDEL_ZOOM_REFRESH ||
+	    scale > zoom->scale) {
+		mandel_render(mode, cx, cy, scale, show);
+		zoom->frames = 1;
+	} else {
+		begin(mode, cx, cy, scale);
+		seed(zoom, cx, cy, scale);
+		for (y = 0; y < MANDEL_HEIGHT; y++) {
+			compute(0, y, 1, 0, MANDEL_WIDTH);
+		}
+		if (show) {
+			show(1);
+		}
+		zoom->frames++;
+	}
+
+	memcpy(zoom->prev, mandel_iters, sizeof(mandel_iters));
+	zoom->cx = cx;
+	zoom->cy = cy;
+	zoom->scale = scale;
+}
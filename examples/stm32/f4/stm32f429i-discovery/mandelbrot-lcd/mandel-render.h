@@ -0,0 +1,81 @@
+/*
+ * This file is part of the libopencm3 project.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MANDEL_RENDER_H
+#define __MANDEL_RENDER_H
+
+#include <stdint.h>
+#include "mandel-kernel.h"
+
+#define MANDEL_WIDTH	240
+#define MANDEL_HEIGHT	320
+
+/* Coarsest preview, in pixels; a power of 2, or 1 for none. */
+#ifndef MANDEL_PREVIEW
+#define MANDEL_PREVIEW	8
+#endif
+
+/*
+ * Iteration counts of the frame, row by row.  Pixel (x, y) is the
+ * point (cx + (x - MANDEL_WIDTH / 2)*scale, cy + (y - MANDEL_HEIGHT /
+ * 2)*scale), the same as mandel() has always drawn.
+ */
+extern uint8_t mandel_iters[MANDEL_HEIGHT][MANDEL_WIDTH];
+
+struct mandel_stats {
+	uint32_t computed;	/* pixels run through the kernel */
+	uint32_t filled;	/* pixels filled from a uniform border */
+	uint32_t seeded;	/* pixels taken over from the last frame */
+};
+
+extern struct mandel_stats mandel_stats;
+
+/*
+ * Render a frame into mandel_iters.  First every MANDEL_PREVIEW'th
+ * pixel of every MANDEL_PREVIEW'th row, then half that, down to every
+ * 2nd; show(step) is called after each of those passes, with the
+ * frame good to blocks of step x step pixels from the top left one.
+ * Then Mariani-Silver subdivision fills in the rest, and show(1) is
+ * called on the finished frame.  show may be NULL.
+ */
+void mandel_render(enum mandel_mode mode, float cx, float cy, float scale,
+		   void (*show)(int step));
+
+/*
+ * Zooming.  mandel_zoom() renders the next frame of a zoom, starting
+ * from the last one, which it keeps in prev (MANDEL_HEIGHT rows,
+ * somewhere out of the way like SDRAM).  Each new pixel is looked up
+ * where it was in the last frame; if the 3x3 pixels around there were
+ * all the same count, it takes that, otherwise it is worked out.
+ * Taken over counts can be a little off where a band is thinner than
+ * a pixel, so every MANDEL_ZOOM_REFRESH'th frame, and any frame that
+ * zooms out, is rendered afresh with mandel_render().
+ */
+#ifndef MANDEL_ZOOM_REFRESH
+#define MANDEL_ZOOM_REFRESH 8
+#endif
+
+struct mandel_zoom {
+	uint8_t (*prev)[MANDEL_WIDTH];
+	float cx, cy, scale;	/* of the frame in prev */
+	int frames;		/* since the last full render, 0 for none */
+};
+
+void mandel_zoom(struct mandel_zoom *zoom, enum mandel_mode mode,
+		 float cx, float cy, float scale, void (*show)(int step));
+
+#endif
@@ -30,6 +30,9 @@
 #include "clock.h"
 #include "sdram.h"
 #include "lcd.h"
+#include "dma2d.h"
+#include "mandel-render.h"
+#include "mandel-palette.h"
 
 /* utility functions */
 void uart_putc(char c);
@@ -58,90 +61,71 @@ static void gpio_setup(void)
 	usart_enable(USART1);
 }
 
-/* Maximum number of iterations for the escape-time calculation */
-#define max_iter 32
-uint16_t lcd_colors[] = {
-	0x0,
-	0x1f00,
-	0x00f8,
-	0xe007,
-	0xff07,
-	0x1ff8,
-	0xe0ff,
-	0xffff,
-	0xc339,
-	0x1f00 >> 1,
-	0x00f8 >> 1,
-	0xe007 >> 1,
-	0xff07 >> 1,
-	0x1ff8 >> 1,
-	0xe0ff >> 1,
-	0xffff >> 1,
-	0xc339 >> 1,
-	0x1f00 << 1,
-	0x00f8 << 1,
-	0x6007 << 1,
-	0x6f07 << 1,
-	0x1ff8 << 1,
-	0x60ff << 1,
-	0x6fff << 1,
-	0x4339 << 1,
-	0x1f00 ^ 0x6ac9,
-	0x00f8 ^ 0x6ac9,
-	0xe007 ^ 0x6ac9,
-	0xff07 ^ 0x6ac9,
-	0x1ff8 ^ 0x6ac9,
-	0xe0ff ^ 0x6ac9,
-	0xffff ^ 0x6ac9,
-	0xc339 ^ 0x6ac9,
-	0,
-	0,
-	0,
-	0,
-	0
-};
-
-
-static int iterate(float, float);
-/* Main mandelbrot calculation */
-static int iterate(float px, float py)
+/* Which kernel to draw with, see mandel-kernel.h */
+#ifndef MANDEL_MODE
+#define MANDEL_MODE MANDEL_FLOAT2
+#endif
+
+/*
+ * Counts per frame the colors move round, 0 to keep them still.  It
+ * is only a new lut, the counts stay as they are.
+ */
+#ifndef MANDEL_CYCLE
+#define MANDEL_CYCLE 1
+#endif
+
+/* Iteration count to pixel, see mandel-palette.h */
+static uint16_t lut[256];
+static uint32_t clut[256];
+static unsigned phase;
+
+/*
+ * Draw the frame from mandel_iters through lut, a row at a time, each
+ * pixel the color of the top left one of its step x step block.  The previews
+ * are only sent if the display is free, they are not worth waiting
+ * for; the finished frame always is.  That one is a pixel for every
+ * count, which is what DMA2D does, through clut, while the CPU waits.
+ */
+static void show(int step)
 {
-	int it = 0;
-	float x = 0, y = 0;
-	while (it < max_iter) {
-		float nx = x*x;
-		float ny = y*y;
-		if ((nx + ny) > 4) {
-			return it;
+	int x, y;
+
+	if (step > 1 && lcd_frame_busy()) {
+		return;
+	}
+	if (step == 1) {
+		dma2d_clut(clut, 256);
+		dma2d_convert(lcd_frame(), LCD_WIDTH, DMA2D_RGB565,
+			      mandel_iters, LCD_WIDTH, DMA2D_L8,
+			      LCD_WIDTH, LCD_HEIGHT);
+		dma2d_wait();
+		lcd_show_frame_async(NULL);
+		return;
+	}
+	for (y = 0; y < LCD_HEIGHT; y++) {
+		const uint8_t *row = mandel_iters[y & ~(step - 1)];
+		for (x = 0; x < LCD_WIDTH; x++) {
+			lcd_draw_pixel(x, y, lut[row[x & ~(step - 1)]]);
 		}
-		/* Zn+1 = Zn^2 + P */
-		y = 2*x*y + py;
-		x = nx - ny + px;
-		it++;
 	}
-	return 0;
+	lcd_show_frame_async(NULL);
 }
 
+/* The last frame, in SDRAM, for the next one to start from. */
+static struct mandel_zoom zoom;
+
 void mandel(float cx, float cy, float scale)
 {
-	int x, y;
-	int change = 0;
-	for (x = -120; x < 120; x++) {
-		for (y = -160; y < 160; y++) {
-			int i = iterate(cx + x*scale, cy + y*scale);
-			if (i >= max_iter) {
-				i = max_iter;
-			} else {
-				change++;
-			}
-			lcd_draw_pixel(x+120, y+160, lcd_colors[i]);
-		}
-	}
+	mandel_palette_lcd(lut, phase);
+	mandel_palette_dma2d(clut, phase);
+	phase += MANDEL_CYCLE;
+	mandel_zoom(&zoom, MANDEL_MODE, cx, cy, scale, show);
 }
 
 int main(void)
 {
 	int gen = 0;
+	uint32_t start, computed = 0;
 	float scale = 0.25f, center_x = -0.5f, center_y = 0.0f;
 
 
@@ -153,20 +137,33 @@ int main(void)
 	sdram_init();
 	/* Enable the LCD attached to the board */
 	lcd_init();
+	dma2d_init();
+	/* Out of the way of the two frames, see lcd_init() */
+	zoom.prev = sdram_alloc(sizeof(mandel_iters), 2);
 
 	printf("System initialized.\n");
 
+	start = mtime();
 	while (1) {
 		/* Blink the LED (PG13) on the board with each fractal drawn. */
 		gpio_toggle(GPIOG, GPIO13);		/* LED on/off */
-		mandel(center_x, center_y, scale);	/* draw mandelbrot */
-		lcd_show_frame();			/* show it */
+		mandel(center_x, center_y, scale);	/* draw and show it */
+		computed += mandel_stats.computed;
 		/* Change scale and center */
 		center_x += 0.1815f * scale;
 		center_y += 0.505f * scale;
 		scale	*= 0.875f;
 		gen++;
 		if (gen > 99) {
+			uint32_t ms = mtime() - start;
+			printf("%d frames in %d ms, %d.%d fps, "
+			       "%d%% of pixels computed\n",
+			       gen, (int)ms, (int)(gen * 1000 / ms),
+			       (int)(gen * 10000 / ms % 10),
+			       (int)(computed / (gen * LCD_WIDTH * LCD_HEIGHT /
+						 100)));
+			start = mtime();
+			computed = 0;
 			scale = 0.25f;
 			center_x = -0.5f;
 			center_y = 0.0f;
@@ -142,3 +142,162 @@ sdram_init(void) {
 	FMC_SDRTR = 683;
 	/* and Poof! a 8 megabytes of ram shows up in the address space */
 }
+
+/*
+ * Carving up the SDRAM.
+ *
+ * With 4 banks, 12 row bits and 8 column bits on a 16 bit bus, the
+ * FMC puts the bank select above the row, so each bank is a plain
+ * 2 MB block of the address space.  Each bank has an open row of its
+ * own: two buffers that are read at the same time, say one being
+ * scanned out and one being drawn into, keep their rows open if they
+ * sit in different banks, and keep closing each other's if they
+ * don't.  So every allocation asks for a bank.
+ *
+ * Nothing is ever given back to the banks.  Frames are recycled
+ * through a pool, scratch memory through an arena.
+ */
+
+static uint32_t sdram_used[SDRAM_BANKS];
+
+/*
+ * Take size bytes from a bank, or from the bank with the most room
+ * left for SDRAM_ANY_BANK.  Returns NULL if it doesn't fit.
+ */
+void *
+sdram_alloc(uint32_t size, int bank)
+{
+	uint32_t start;
+	int i;
+
+	if (bank == SDRAM_ANY_BANK) {
+		bank = 0;
+		for (i = 1; i < SDRAM_BANKS; i++) {
+			if (sdram_used[i] < sdram_used[bank]) {
+				bank = i;
+			}
+		}
+	}
+	if (bank < 0 || bank >= SDRAM_BANKS) {
+		return NULL;
+	}
+
+	start = (sdram_used[bank] + SDRAM_ALIGN - 1) & ~(SDRAM_ALIGN - 1);
+	if (size > SDRAM_BANK_SIZE - start) {
+		return NULL;
+	}
+	sdram_used[bank] = start + size;
+	return SDRAM_BASE_ADDRESS + bank * SDRAM_BANK_SIZE + start;
+}
+
+/* Bytes still free in a bank. */
+uint32_t
+sdram_free(int bank)
+{
+	return SDRAM_BANK_SIZE - sdram_used[bank];
+}
+
+/*
+ * A pool of n frames of the same size, one per bank in turn from
+ * first_bank on.  Returns the number of frames it got.
+ */
+int
+sdram_pool_init(struct sdram_pool *pool, uint32_t size, int n,
+		int first_bank)
+{
+	int i;
+
+	if (n > SDRAM_POOL_MAX) {
+		n = SDRAM_POOL_MAX;
+	}
+	pool->size = size;
+	pool->n = 0;
+	pool->free = 0;
+	for (i = 0; i < n; i++) {
+		void *frame = sdram_alloc(size,
+					  (first_bank + i) % SDRAM_BANKS);
+		if (frame == NULL) {
+			frame = sdram_alloc(size, SDRAM_ANY_BANK);
+		}
+		if (frame == NULL) {
+			break;
+		}
+		pool->frame[pool->n] = frame;
+		pool->free |= 1 << pool->n;
+		pool->n++;
+	}
+	return pool->n;
+}
+
+/*
+ * A free frame, in a different bank from busy if there is one (busy
+ * may be NULL).  Returns NULL if all frames are out.
+ */
+void *
+sdram_pool_get(struct sdram_pool *pool, const void *busy)
+{
+	int i, pick = -1;
+
+	for (i = 0; i < pool->n; i++) {
+		if (!(pool->free & (1 << i))) {
+			continue;
+		}
+		if (pick < 0) {
+			pick = i;
+		}
+		if (busy == NULL ||
+		    SDRAM_BANK(pool->frame[i]) != SDRAM_BANK(busy)) {
+			pick = i;
+			break;
+		}
+	}
+	if (pick < 0) {
+		return NULL;
+	}
+	pool->free &= ~(1 << pick);
+	return pool->frame[pick];
+}
+
+void
+sdram_pool_put(struct sdram_pool *pool, void *frame)
+{
+	int i;
+
+	for (i = 0; i < pool->n; i++) {
+		if (pool->frame[i] == frame) {
+			pool->free |= 1 << i;
+		}
+	}
+}
+
+/*
+ * A bump arena for scratch memory: allocate as you go, and drop it
+ * all at once with sdram_arena_reset(), eg. once a frame.
+ */
+int
+sdram_arena_init(struct sdram_arena *arena, uint32_t size, int bank)
+{
+	arena->base = sdram_alloc(size, bank);
+	arena->size = arena->base ? size : 0;
+	arena->used = 0;
+	return arena->base != NULL;
+}
+
+void *
+sdram_arena_alloc(struct sdram_arena *arena, uint32_t size)
+{
+	uint32_t start;
+
+	start = (arena->used + SDRAM_ALIGN - 1) & ~(SDRAM_ALIGN - 1);
+	if (start > arena->size || size > arena->size - start) {
+		return NULL;
+	}
+	arena->used = start + size;
+	return arena->base + start;
+}
+
+void
+sdram_arena_reset(struct sdram_arena *arena)
+{
+	arena->used = 0;
+}
@@ -20,8 +20,53 @@
 #ifndef __SDRAM_H
 #define __SDRAM_H
 
+#include <stdint.h>
+
 #define SDRAM_BASE_ADDRESS ((uint8_t *)(0xd0000000))
 
 /* Initialize the SDRAM chip on the board */
 void sdram_init(void);
+
+/*
+ * The 8 MB on the board are 4 banks of 2 MB, one after the other.
+ * See sdram.c for why the bank matters.
+ */
+#define SDRAM_SIZE		(8 * 1024 * 1024)
+#define SDRAM_BANKS		4
+#define SDRAM_BANK_SIZE		(SDRAM_SIZE / SDRAM_BANKS)
+#define SDRAM_ANY_BANK		(-1)
+#define SDRAM_ALIGN		32	/* bytes, good for DMA2D and LTDC */
+
+/* The bank an SDRAM address is in. */
+#define SDRAM_BANK(p) \
+	((int)(((uint8_t *)(p) - SDRAM_BASE_ADDRESS) / SDRAM_BANK_SIZE))
+
+void *sdram_alloc(uint32_t size, int bank);
+uint32_t sdram_free(int bank);
+
+/* Fixed size frames, spread over the banks. */
+#define SDRAM_POOL_MAX		8
+
+struct sdram_pool {
+	void		*frame[SDRAM_POOL_MAX];
+	uint32_t	size;
+	int		n;
+	uint32_t	free;		/* bit i set if frame[i] is free */
+};
+
+int sdram_pool_init(struct sdram_pool *pool, uint32_t size, int n,
+		    int first_bank);
+void *sdram_pool_get(struct sdram_pool *pool, const void *busy);
+void sdram_pool_put(struct sdram_pool *pool, void *frame);
+
+/* Scratch memory, dropped all at once. */
+struct sdram_arena {
+	uint8_t		*base;
+	uint32_t	size;
+	uint32_t	used;
+};
+
+int sdram_arena_init(struct sdram_arena *arena, uint32_t size, int bank);
+void *sdram_arena_alloc(struct sdram_arena *arena, uint32_t size);
+void sdram_arena_reset(struct sdram_arena *arena);
 #endif
@@ -23,6 +23,7 @@
 #include <libopencm3/stm32/rcc.h>
 #include <libopencm3/stm32/gpio.h>
 #include <libopencm3/stm32/usart.h>
+#include "mandel-kernel.h"
 
 static void clock_setup(void)
 {
@@ -63,37 +64,24 @@ static void gpio_setup(void)
 	gpio_set_af(GPIOA, GPIO_AF7, GPIO9);
 }
 
-/* Maximum number of iterations for the escape-time calculation */
-#define maxIter 32
+/* Which kernel to draw with, see mandel-kernel.h */
+#ifndef MANDEL_MODE
+#define MANDEL_MODE MANDEL_FLOAT2
+#endif
+
+#define maxIter MANDEL_MAX_ITER
 /* This array converts the iteration count to a character representation. */
 static char color[maxIter+1] = " .:++xxXXX%%%%%%################";
 
-/* Main mandelbrot calculation */
-static int iterate(float px, float py)
-{
-	int it = 0;
-	float x = 0, y = 0;
-	while (it < maxIter) {
-		float nx = x*x;
-		float ny = y*y;
-		if ((nx + ny) > 4) {
-			return it;
-		}
-		/* Zn+1 = Zn^2 + P */
-		y = 2*x*y + py;
-		x = nx - ny + px;
-		it++;
-	}
-	return 0;
-}
-
 static void mandel(float cX, float cY, float scale)
 {
 	int x, y;
+	uint8_t it[100];
 	for (x = -60; x < 60; x++) {
+		mandel_span(MANDEL_MODE, cX, cY, scale, x, -50, 0, 1, 100,
+			    it, 1);
 		for (y = -50; y < 50; y++) {
-			int i = iterate(cX + x*scale, cY + y*scale);
-			usart_send_blocking(USART1, color[i]);
+			usart_send_blocking(USART1, color[it[y+50]]);
 		}
 		usart_send_blocking(USART1, '\r');
 		usart_send_blocking(USART1, '\n');
@@ -71,13 +71,19 @@ static void lcd_init(void)
 	do {} while (!lcd_is_step_up_ready());
 }
 
-static void clear_lcd_ram(void)
-{
-	LCD_RAM_COM0 = 0;
-	LCD_RAM_COM1 = 0;
-	LCD_RAM_COM2 = 0;
-	LCD_RAM_COM3 = 0;
-}
+/*
+ * The glass has 6 characters and uses 4 commons, the whole segment
+ * image is 4 words of LCD RAM. A frame is built here in SRAM and
+ * lcd_commit() copies it over in one go.
+ */
+#define LCD_DIGITS	6
+
+struct lcd_frame {
+	uint32_t com[4];	/* LCD_RAM_COM0 - LCD_RAM_COM3 */
+};
+
+/* What LCD RAM holds now, so a commit can skip words that are the same. */
+static struct lcd_frame lcd_shown;
 
 /*	LCD MAPPING:
 	    A
@@ -95,10 +101,13 @@ DP  |_| -----------
 `mask' corresponds to bits in lexicographic order: mask & 1 == A, mask & 2 == B,
 and so on.
  */
-static void write_mask_to_lcd_ram (int position, uint16_t mask, int clear_before)
+#define LCD_DP		0x4000
+#define LCD_COLON	0x8000
+
+static void compose_mask (struct lcd_frame *f, int position, uint16_t mask)
 {
 	/* Every pixel of character at position can be accessed
-	   as LCD_RAM_COMx & (1 << Px) */
+	   as COMx & (1 << Px) */
 	int P1,P2,P3,P4;
 	if (position < 2) P1 = 2*position;
 	else P1 = 2*position+4;
@@ -116,88 +125,165 @@ static void write_mask_to_lcd_ram (int position, uint16_t mask, int clear_before
 		P4 = P3 - 1;
 	}
 
-	uint32_t COM0,COM1,COM2,COM3;
-	COM0 = LCD_RAM_COM0;
-	COM1 = LCD_RAM_COM1;
-	COM2 = LCD_RAM_COM2;
-	COM3 = LCD_RAM_COM3;
-	
-	if (clear_before) {
-		COM0&= ~(1<<P1 | 1<<P2 | 1<<P3 | 1<<P4);
-		COM1&= ~(1<<P1 | 1<<P2 | 1<<P3 | 1<<P4);
-		COM2&= ~(1<<P1 | 1<<P2 | 1<<P3 | 1<<P4);
-		COM3&= ~(1<<P1 | 1<<P2 | 1<<P3 | 1<<P4);
-	}
-	
-	COM0 |= ((mask >> 0x1) & 1) << P4 | ((mask >> 0x4) & 1) << P1
-	      | ((mask >> 0x6) & 1) << P3 | ((mask >> 0xA) & 1) << P2;
-	COM1 |= ((mask >> 0x0) & 1) << P4 | ((mask >> 0x2) & 1) << P2
-	      | ((mask >> 0x3) & 1) << P1 | ((mask >> 0x5) & 1) << P3;
-	COM3 |= ((mask >> 0x7) & 1) << P3 | ((mask >> 0x8) & 1) << P4
-	      | ((mask >> 0xB) & 1) << P1 | ((mask >> 0xE) & 1) << P2;
-	COM2 |= ((mask >> 0x9) & 1) << P4 | ((mask >> 0xC) & 1) << P1
-	      | ((mask >> 0xD) & 1) << P3 | ((mask >> 0xF) & 1) << P2;
-
-	LCD_RAM_COM0 = COM0;
-	LCD_RAM_COM1 = COM1;
-	LCD_RAM_COM2 = COM2;
-	LCD_RAM_COM3 = COM3;
+	f->com[0] |= ((mask >> 0x1) & 1) << P4 | ((mask >> 0x4) & 1) << P1
+		   | ((mask >> 0x6) & 1) << P3 | ((mask >> 0xA) & 1) << P2;
+	f->com[1] |= ((mask >> 0x0) & 1) << P4 | ((mask >> 0x2) & 1) << P2
+		   | ((mask >> 0x3) & 1) << P1 | ((mask >> 0x5) & 1) << P3;
+	f->com[3] |= ((mask >> 0x7) & 1) << P3 | ((mask >> 0x8) & 1) << P4
+		   | ((mask >> 0xB) & 1) << P1 | ((mask >> 0xE) & 1) << P2;
+	f->com[2] |= ((mask >> 0x9) & 1) << P4 | ((mask >> 0xC) & 1) << P1
+		   | ((mask >> 0xD) & 1) << P3 | ((mask >> 0xF) & 1) << P2;
 }
 
-static void write_char_to_lcd_ram (int position, uint8_t symbol, bool clear_before)
+static const uint16_t from_ascii[0x60] = {
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  /*         !       "       #       $      %        &       ' */
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  /* (       )       *       +       ,       -       .       / */
+  0x0000, 0x0000, 0x3FC0, 0x1540, 0x0000, 0x0440, 0x4000, 0x2200,
+  /* 0       1       2       3       4       5       6       7 */
+  0x003F, 0x0006, 0x045B, 0x044F, 0x0466, 0x046D, 0x047D, 0x2201,
+  /* 8       9       :       ;       <       =       >       ? */
+  0x047F, 0x046F, 0x8000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  /* @       A       B       C       D       E       F       G */
+  0x0000, 0x0477, 0x047C, 0x0039, 0x045E, 0x0479, 0x0471, 0x043D,
+  /* H       I       J       K       L       M       N       O */
+  0x0476, 0x1109, 0x001E, 0x1B00, 0x0038, 0x02B6, 0x08B6, 0x003F,
+  /* P       Q       R       S       T       U       V       W */
+  0x0473, 0x0467, 0x0C73, 0x046D, 0x1101, 0x003E, 0x0886, 0x2836,
+  /* X       Y       Z       [       \       ]       ^       _ */
+  0x2A80, 0x1280, 0x2209, 0x0000, 0x0880, 0x0000, 0x0000, 0x0008
+};
+
+static uint16_t char_to_mask (uint8_t symbol)
 {
-	uint16_t from_ascii[0x60] = {
-	  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-	  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-	  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-	  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-	  /*         !       "       #       $      %        &       ' */
-	  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-	  /* (       )       *       +       ,       -       .       / */
-	  0x0000, 0x0000, 0x3FC0, 0x1540, 0x0000, 0x0440, 0x4000, 0x2200,
-	  /* 0       1       2       3       4       5       6       7 */
-	  0x003F, 0x0006, 0x045B, 0x044F, 0x0466, 0x046D, 0x047D, 0x2201,
-	  /* 8       9       :       ;       <       =       >       ? */
-	  0x047F, 0x046F, 0x8000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-	  /* @       A       B       C       D       E       F       G */
-	  0x0000, 0x0477, 0x047C, 0x0039, 0x045E, 0x0479, 0x0471, 0x043D,
-	  /* H       I       J       K       L       M       N       O */
-	  0x0476, 0x1109, 0x001E, 0x1B00, 0x0038, 0x02B6, 0x08B6, 0x003F,
-	  /* P       Q       R       S       T       U       V       W */
-	  0x0473, 0x0467, 0x0C73, 0x046D, 0x1101, 0x003E, 0x0886, 0x2836,
-	  /* X       Y       Z       [       \       ]       ^       _ */
-	  0x2A80, 0x1280, 0x2209, 0x0000, 0x0880, 0x0000, 0x0000, 0x0008
-	};
-	if (symbol > 0x60) return; // masks not defined. Nothing to display
-	
-	write_mask_to_lcd_ram (position, from_ascii[symbol], clear_before);
+	if (symbol >= 0x60) return 0; // masks not defined. Nothing to display
+	return from_ascii[symbol];
 }
 
+/*
+ * Build the frame for up to LCD_DIGITS characters of `text', the rest
+ * blank. `dp' and `colon' light the decimal point and colon after
+ * each position, bit 0 for the first character and so on.
+ */
+static void lcd_compose (struct lcd_frame *f, const char *text,
+			 uint8_t dp, uint8_t colon)
+{
+	uint16_t mask;
+	int i;
 
-static void lcd_display_hello (void)
+	f->com[0] = f->com[1] = f->com[2] = f->com[3] = 0;
+	for (i = 0; i < LCD_DIGITS; i++) {
+		mask = (*text) ? char_to_mask (*text++) : 0;
+		if (dp & (1 << i)) mask |= LCD_DP;
+		if (colon & (1 << i)) mask |= LCD_COLON;
+		compose_mask (f, i, mask);
+	}
+}
+
+/*
+ * Copy a frame to LCD RAM and ask for it to be shown. LCD RAM may only
+ * be written while no update request is pending, then only the words
+ * that changed are stored and UDR set once for all of them. If nothing
+ * changed there is no update at all, and the controller does not wake
+ * up the bus for it.
+ */
+static void lcd_commit (const struct lcd_frame *f)
 {
+	if (f->com[0] == lcd_shown.com[0] && f->com[1] == lcd_shown.com[1]
+	    && f->com[2] == lcd_shown.com[2] && f->com[3] == lcd_shown.com[3])
+		return;
+
 	do {} while (!lcd_is_for_update_ready ());
-	clear_lcd_ram (); 	/* all segments off */
-	write_char_to_lcd_ram (0, '*', true);
-	write_char_to_lcd_ram (1, 'H', true);
-	write_char_to_lcd_ram (2, 'E', true);
-	write_char_to_lcd_ram (3, 'L', true);
-	write_char_to_lcd_ram (4, 'L', true);
-	write_char_to_lcd_ram (5, 'O', true);
+	if (f->com[0] != lcd_shown.com[0]) LCD_RAM_COM0 = f->com[0];
+	if (f->com[1] != lcd_shown.com[1]) LCD_RAM_COM1 = f->com[1];
+	if (f->com[2] != lcd_shown.com[2]) LCD_RAM_COM2 = f->com[2];
+	if (f->com[3] != lcd_shown.com[3]) LCD_RAM_COM3 = f->com[3];
+	lcd_shown = *f;
 
 	lcd_update ();
 }
 
-int main(void)
+/*
+ * Scrolling text. The masks for the whole string are looked up once,
+ * padded with a screen of blanks either side so the text comes in on
+ * the right and leaves on the left, and each step only composes the
+ * LCD_DIGITS masks in view.
+ */
+#define LCD_SCROLL_MAX	32
+
+struct lcd_scroll {
+	uint16_t masks[LCD_SCROLL_MAX + 2 * LCD_DIGITS];
+	int len;	/* masks in use */
+	int pos;	/* first mask in view */
+};
+
+static void lcd_scroll_init (struct lcd_scroll *s, const char *text)
 {
 	int i;
-	lcd_init ();
 
-	lcd_display_hello ();
+	s->len = 0;
+	s->pos = 0;
+	for (i = 0; i < LCD_DIGITS; i++)
+		s->masks[s->len++] = 0;
+	while (*text && s->len < LCD_SCROLL_MAX + LCD_DIGITS)
+		s->masks[s->len++] = char_to_mask (*text++);
+	for (i = 0; i < LCD_DIGITS; i++)
+		s->masks[s->len++] = 0;
+}
+
+/* Show the next step of the text, it starts over after the last one. */
+static void lcd_scroll_step (struct lcd_scroll *s)
+{
+	struct lcd_frame f = { { 0, 0, 0, 0 } };
+	int i;
+
+	for (i = 0; i < LCD_DIGITS; i++)
+		compose_mask (&f, i, s->masks[s->pos + i]);
+	lcd_commit (&f);
+
+	if (++s->pos > s->len - LCD_DIGITS)
+		s->pos = 0;
+}
+
+
+static void lcd_display_hello (void)
+{
+	struct lcd_frame f;
+
+	lcd_compose (&f, "*HELLO", 0, 0);
+	lcd_commit (&f);
+}
+
+static void wait_a_bit (void)
+{
+	int i;
 
 	for (i = 0; i < 1000000; i++) {	/* Wait a bit. */
 		__asm__("nop");
 	}
+}
+
+int main(void)
+{
+	struct lcd_scroll scroll;
+
+	lcd_init ();
+
+	/* LCD RAM comes up with something in it, make it all go */
+	LCD_RAM_COM0 = LCD_RAM_COM1 = LCD_RAM_COM2 = LCD_RAM_COM3 = 0;
+
+	lcd_display_hello ();
+	wait_a_bit ();
+
+	lcd_scroll_init (&scroll, "HELLO FROM LIBOPENCM3");
+	while (1) {
+		lcd_scroll_step (&scroll);
+		wait_a_bit ();
+	}
 
 	return 0;
 }